@@ -1065,7 +1065,18 @@ enum CXTranslationUnit_Flags {
    * included into the set of code completions returned from this translation
    * unit.
    */
-  CXTranslationUnit_IncludeBriefCommentsInCodeCompletion = 0x80
+  CXTranslationUnit_IncludeBriefCommentsInCodeCompletion = 0x80,
+
+  /**
+   * \brief Used to indicate that the function bodies skipped because of
+   * \c CXTranslationUnit_SkipFunctionBodies should be kept, so that
+   * \c clang_Cursor_parseSkippedFunctionBody() can parse them on demand.
+   *
+   * This option keeps the cost of the first parse close to that of skipping
+   * bodies, while still allowing clients to look inside the functions they
+   * need.
+   */
+  CXTranslationUnit_RetainSkippedFunctionBodies = 0x100
 };
 
 /**
@@ -2659,6 +2670,23 @@ CINDEX_LINKAGE int clang_Cursor_getNumArguments(CXCursor C);
  */
 CINDEX_LINKAGE CXCursor clang_Cursor_getArgument(CXCursor C, unsigned i);
 
+/**
+ * \brief Parse the body of a function definition that was skipped when its
+ * translation unit was parsed.
+ *
+ * Bodies are only available for parsing when the translation unit was parsed
+ * with both \c CXTranslationUnit_SkipFunctionBodies and
+ * \c CXTranslationUnit_RetainSkippedFunctionBodies, without
+ * -fdelayed-template-parsing, and only for functions that are not
+ * templates or members of templates. Only the body itself is
+ * parsed; the rest of the translation unit is reused as is. Once parsed, the
+ * body can be visited like any other.
+ *
+ * \returns non-zero if a skipped body was parsed, zero if the cursor does not
+ * refer to a function whose body was skipped and retained.
+ */
+CINDEX_LINKAGE unsigned clang_Cursor_parseSkippedFunctionBody(CXCursor C);
+
 /**
  * \brief Determine whether two CXTypes represent the same type.
  *
@@ -25,6 +25,7 @@
 #include "clang/AST/LambdaMangleContext.h"
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/PrettyPrinter.h"
+#include "clang/AST/TemplateBase.h"
 #include "clang/AST/TemplateName.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/CanonicalType.h"
@@ -48,6 +49,8 @@ namespace clang {
   class ASTRecordLayout;
   class BlockExpr;
   class CharUnits;
+  class ConstexprCallCache;
+  class CXXBasePaths;
   class DiagnosticsEngine;
   class Expr;
   class ExternalASTSource;
@@ -138,6 +141,11 @@ class ASTContext : public RefCountedBase<ASTContext> {
   mutable llvm::ContextualFoldingSet<SubstTemplateTemplateParmPackStorage,
                                      ASTContext&> 
     SubstTemplateTemplateParmPacks;
+
+  /// \brief The uniqued template argument lists, see
+  /// getUniquedTemplateArgumentList().
+  mutable llvm::FoldingSet<UniquedTemplateArgumentList>
+    UniquedTemplateArgumentLists;
   
   /// \brief The set of nested name specifiers.
   ///
@@ -159,6 +167,41 @@ class ASTContext : public RefCountedBase<ASTContext> {
                          std::pair<uint64_t, unsigned> > TypeInfoMap;
   mutable TypeInfoMap MemoizedTypeInfo;
 
+  /// \brief What is known about how a complete class derives from another
+  /// one, see isDerivedFrom() and getDerivedToBasePaths().
+  struct DerivedToBaseInfo {
+    /// \brief Whether the class is derived from the base.
+    bool IsDerived;
+    /// \brief The paths from the class to the base, or null if the class is
+    /// not derived from the base or the paths have not been asked for.
+    CXXBasePaths *Paths;
+  };
+
+  /// \brief A cache of derived-to-base relationships between complete
+  /// classes, keyed by the canonical declarations of the derived class and
+  /// the base.
+  mutable llvm::DenseMap<std::pair<const CXXRecordDecl *,
+                                   const CXXRecordDecl *>, DerivedToBaseInfo>
+    DerivedToBaseCache;
+  mutable unsigned NumDerivedToBaseQueries, NumDerivedToBaseCacheHits;
+
+  DerivedToBaseInfo *getDerivedToBaseInfo(const CXXRecordDecl *Derived,
+                                          const CXXRecordDecl *Base) const;
+
+  /// \brief The number of name lookups into declaration contexts, and how
+  /// many of those found nothing in each context.  Only collected when
+  /// statistics are enabled.
+  unsigned NumDeclContextLookups, NumDeclContextLookupMisses;
+
+  /// \brief The number of lookup table probes avoided by the name filters
+  /// of large lookup tables.  Only collected when statistics are enabled.
+  unsigned NumDeclContextLookupsFiltered;
+  llvm::DenseMap<const DeclContext *, unsigned> DeclContextLookupMisses;
+
+  /// \brief The number of class and function template specializations
+  /// added to the specialization sets of their templates.
+  unsigned NumTemplateSpecializations;
+
   /// \brief A cache mapping from CXXRecordDecls to key functions.
   llvm::DenseMap<const CXXRecordDecl*, const CXXMethodDecl*> KeyFunctions;
   
@@ -370,6 +413,10 @@ class ASTContext : public RefCountedBase<ASTContext> {
   /// \brief Allocator for partial diagnostics.
   PartialDiagnostic::StorageAllocator DiagAllocator;
 
+  /// \brief Memoized constexpr calls and constexpr evaluation statistics,
+  /// created on first use.
+  mutable OwningPtr<ConstexprCallCache> ConstexprCalls;
+
   /// \brief The current C++ ABI.
   OwningPtr<CXXABI> ABI;
   CXXABI *createCXXABI(const TargetInfo &T);
@@ -420,6 +467,9 @@ public:
   }
   /// Return the total memory used for various side tables.
   size_t getSideTableAllocatedMemory() const;
+
+  /// \brief Return the table of memoized constexpr function calls.
+  ConstexprCallCache &getConstexprCallCache() const;
   
   PartialDiagnostic::StorageAllocator &getDiagAllocator() {
     return DiagAllocator;
@@ -1541,6 +1591,46 @@ public:
 
   bool isNearlyEmpty(const CXXRecordDecl *RD) const;
 
+  /// \brief Determine whether \p Derived is derived from \p Base.
+  ///
+  /// The result is cached once the definition of \p Derived is complete,
+  /// since its bases can no longer change after that.
+  bool isDerivedFrom(const CXXRecordDecl *Derived,
+                     const CXXRecordDecl *Base) const;
+
+  /// \brief Retrieve the paths from the complete class \p Derived to its
+  /// base \p Base, as found by a search that finds ambiguities and records
+  /// paths but does not detect virtual bases.
+  ///
+  /// The paths are only searched for once per pair of classes.
+  ///
+  /// \returns null if \p Derived is not derived from \p Base, or if its
+  /// definition is not complete yet.
+  const CXXBasePaths *getDerivedToBasePaths(const CXXRecordDecl *Derived,
+                                            const CXXRecordDecl *Base) const;
+
+  /// \brief Record a name lookup into the declaration context \p DC, for
+  /// the statistics.
+  void noteDeclContextLookup(const DeclContext *DC, bool Found) {
+    ++NumDeclContextLookups;
+    if (!Found) {
+      ++NumDeclContextLookupMisses;
+      ++DeclContextLookupMisses[DC];
+    }
+  }
+
+  /// \brief Record that a template specialization was added to the
+  /// specialization set of its template.
+  void noteTemplateSpecialization() { ++NumTemplateSpecializations; }
+
+  unsigned getNumTemplateSpecializations() const {
+    return NumTemplateSpecializations;
+  }
+
+  /// \brief Record that a lookup table did not need to be probed because its
+  /// name filter ruled out the name, for the statistics.
+  void noteFilteredDeclContextLookup() { ++NumDeclContextLookupsFiltered; }
+
   MangleContext *createMangleContext();
   
   void DeepCollectObjCIvars(const ObjCInterfaceDecl *OI, bool leafClass,
@@ -1678,6 +1768,25 @@ public:
   TemplateArgument getCanonicalTemplateArgument(const TemplateArgument &Arg)
     const;
 
+  /// \brief Retrieve the uniqued identity of the given template argument
+  /// list, creating it if needed.
+  ///
+  /// Two argument lists have the same identity if and only if they name the
+  /// same specialization of a template.
+  const UniquedTemplateArgumentList *
+  getUniquedTemplateArgumentList(const TemplateArgument *Args,
+                                 unsigned NumArgs) const;
+
+  /// \brief Retrieve the uniqued identity of the given template argument
+  /// list, or null if it has never been uniqued.
+  ///
+  /// Every specialization of a template has its argument list uniqued when
+  /// it is added to the template, so a null result means that no template
+  /// has a specialization for these arguments.
+  const UniquedTemplateArgumentList *
+  findUniquedTemplateArgumentList(const TemplateArgument *Args,
+                                  unsigned NumArgs) const;
+
   /// Type Query functions.  If the type is an instance of the specified class,
   /// return the Type pointer for the underlying maximally pretty type.  This
   /// is a member of ASTContext because this may need to do some amount of
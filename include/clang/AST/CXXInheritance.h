@@ -227,6 +227,10 @@ public:
   /// \brief Swap this data structure's contents with another CXXBasePaths 
   /// object.
   void swap(CXXBasePaths &Other);
+
+  /// \brief Replace the results of this search with a copy of the results
+  /// of \p Other, which must have been found with the same options.
+  void copyResults(const CXXBasePaths &Other);
 };
 
 /// \brief Uniquely identifies a virtual method within a class
@@ -0,0 +1,92 @@
+//===--- ConstexprCallCache.h - Memoized constexpr calls --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines ConstexprCallCache, which remembers the results of
+//  constexpr function calls across constant expression evaluations.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_CONSTEXPRCALLCACHE_H
+#define LLVM_CLANG_AST_CONSTEXPRCALLCACHE_H
+
+#include "clang/AST/APValue.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
+
+namespace clang {
+
+/// \brief The results of constexpr function calls evaluated in an ASTContext,
+/// together with statistics about constexpr evaluation.
+///
+/// Results are only memoized when LangOptions::ConstexprCallMemoization is
+/// set, and only for calls to non-member functions whose arguments and
+/// result are values that do not refer to any object (see ExprConstant.cpp).
+class ConstexprCallCache {
+public:
+  struct Entry {
+    APValue Result;
+
+    /// \brief Whether the call was evaluated as a constant expression.  If
+    /// not, it was only folded, and its result may only be reused when
+    /// folding.
+    bool IsConstantExpression;
+
+    /// \brief The number of nested calls, including this one, that the
+    /// evaluation of the call needed.  The result may only be reused where
+    /// that many calls would not exceed the depth limit.
+    unsigned Depth;
+  };
+
+private:
+  /// \brief Memoized results, keyed by the callee and the encoded values of
+  /// the arguments.
+  llvm::StringMap<Entry> Entries;
+
+  ConstexprCallCache(const ConstexprCallCache &) LLVM_DELETED_FUNCTION;
+  void operator=(const ConstexprCallCache &) LLVM_DELETED_FUNCTION;
+
+public:
+  /// \brief The number of constexpr function and constructor calls that
+  /// were evaluated.
+  unsigned NumCallsEvaluated;
+
+  /// \brief The number of memoizable calls that were found in the cache,
+  /// and that were not.
+  unsigned NumHits;
+  unsigned NumMisses;
+
+  /// \brief The number of calls whose arguments or result could not be
+  /// memoized.
+  unsigned NumUncacheable;
+
+  ConstexprCallCache()
+    : NumCallsEvaluated(0), NumHits(0), NumMisses(0), NumUncacheable(0) { }
+
+  const Entry *lookup(StringRef Key) const {
+    llvm::StringMap<Entry>::const_iterator I = Entries.find(Key);
+    return I == Entries.end() ? 0 : &I->getValue();
+  }
+
+  void insert(StringRef Key, const APValue &Result,
+              bool IsConstantExpression, unsigned Depth) {
+    Entry &E = Entries.GetOrCreateValue(Key).getValue();
+    E.Result = Result;
+    E.IsConstantExpression = IsConstantExpression;
+    E.Depth = Depth;
+  }
+
+  unsigned size() const { return Entries.size(); }
+
+  void PrintStats() const;
+};
+
+} // end namespace clang
+
+#endif
@@ -265,6 +265,10 @@ private:
   /// \brief Whether statistic collection is enabled.
   static bool StatisticsEnabled;
 
+  /// \brief Whether created declarations are counted, which statistic
+  /// collection implies.
+  static bool CountingEnabled;
+
 protected:
   /// Access - Used by C++ decls for the access specifier.
   // NOTE: VC++ treats enums as signed, avoid using the AccessSpecifier enum
@@ -309,7 +313,7 @@ protected:
       IdentifierNamespace(getIdentifierNamespaceForKind(DK)),
       HasCachedLinkage(0)
   {
-    if (StatisticsEnabled) add(DK);
+    if (CountingEnabled) add(DK);
   }
 
   Decl(Kind DK, EmptyShell Empty)
@@ -319,7 +323,7 @@ protected:
       IdentifierNamespace(getIdentifierNamespaceForKind(DK)),
       HasCachedLinkage(0)
   {
-    if (StatisticsEnabled) add(DK);
+    if (CountingEnabled) add(DK);
   }
 
   virtual ~Decl();
@@ -773,6 +777,14 @@ public:
   static void EnableStatistics();
   static void PrintStats();
 
+  /// \brief Count the declarations created from now on, without collecting
+  /// the rest of the statistics.
+  static void EnableCounting();
+
+  /// \brief The number of declarations created while statistics or
+  /// counting were enabled.
+  static unsigned getNumCreated();
+
   /// isTemplateParameter - Determines whether this declaration is a
   /// template parameter.
   bool isTemplateParameter() const;
@@ -1545,6 +1557,7 @@ private:
   StoredDeclsMap *CreateStoredDeclsMap(ASTContext &C) const;
 
   void buildLookupImpl(DeclContext *DCtx);
+  static unsigned countLookupDecls(DeclContext *DCtx);
   void makeDeclVisibleInContextWithFlags(NamedDecl *D, bool Internal,
                                          bool Rediscoverable);
   void makeDeclVisibleInContextImpl(NamedDecl *D, bool Internal);
@@ -20,14 +20,16 @@
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
 #include <algorithm>
+#include <vector>
 
 namespace clang {
 
 class DependentDiagnostic;
 
-/// StoredDeclsList - This is an array of decls optimized a common case of only
-/// containing one entry.
+/// StoredDeclsList - This is an array of decls optimized for the common cases
+/// of containing one or two entries, which are stored inline.
 struct StoredDeclsList {
 
   /// DeclsTy - When in vector form, this is what the Data pointer points to.
@@ -37,10 +39,16 @@ struct StoredDeclsList {
   /// or a pointer to a vector.
   llvm::PointerUnion<NamedDecl *, DeclsTy *> Data;
 
+  /// \brief When Data is a NamedDecl, the second declaration of the list, if
+  /// any.  It directly follows Data, so that the two inline declarations
+  /// can be returned as an array by getLookupResult().
+  NamedDecl *Second;
+
 public:
-  StoredDeclsList() {}
+  StoredDeclsList() : Second(0) {}
 
-  StoredDeclsList(const StoredDeclsList &RHS) : Data(RHS.Data) {
+  StoredDeclsList(const StoredDeclsList &RHS)
+    : Data(RHS.Data), Second(RHS.Second) {
     if (DeclsTy *RHSVec = RHS.getAsVector())
       Data = new DeclsTy(*RHSVec);
   }
@@ -55,6 +63,7 @@ public:
     if (DeclsTy *Vector = getAsVector())
       delete Vector;
     Data = RHS.Data;
+    Second = RHS.Second;
     if (DeclsTy *RHSVec = RHS.getAsVector())
       Data = new DeclsTy(*RHSVec);
     return *this;
@@ -70,9 +79,15 @@ public:
     return Data.dyn_cast<DeclsTy *>();
   }
 
+  /// \brief Whether \p D is one of the declarations stored inline.
+  bool isStoredInline(NamedDecl *D) const {
+    return D && (getAsDecl() == D || Second == D);
+  }
+
   void setOnlyValue(NamedDecl *ND) {
     assert(!getAsVector() && "Not inline");
     Data = ND;
+    Second = 0;
     // Make sure that Data is a plain NamedDecl* so we can use its address
     // at getLookupResult.
     assert(*(NamedDecl **)&Data == ND &&
@@ -81,10 +96,15 @@ public:
 
   void remove(NamedDecl *D) {
     assert(!isNull() && "removing from empty list");
-    if (NamedDecl *Singleton = getAsDecl()) {
-      assert(Singleton == D && "list is different singleton");
-      (void)Singleton;
-      Data = (NamedDecl *)0;
+    if (NamedDecl *First = getAsDecl()) {
+      if (Second == D) {
+        Second = 0;
+        return;
+      }
+      assert(First == D && "list is different singleton");
+      (void)First;
+      Data = Second;
+      Second = 0;
       return;
     }
 
@@ -104,13 +124,16 @@ public:
       return DeclContext::lookup_result(DeclContext::lookup_iterator(0),
                                         DeclContext::lookup_iterator(0));
 
-    // If we have a single NamedDecl, return it.
+    // If the decls are stored inline, return them.
     if (getAsDecl()) {
       assert(!isNull() && "Empty list isn't allowed");
+      assert((void *)&Second == (void *)((NamedDecl **)(void *)&Data + 1) &&
+             "inline decls are not contiguous");
 
-      // Data is a raw pointer to a NamedDecl*, return it.
+      // Data is a raw pointer to a NamedDecl*, followed by Second.
       void *Ptr = &Data;
-      return DeclContext::lookup_result((NamedDecl**)Ptr, (NamedDecl**)Ptr+1);
+      return DeclContext::lookup_result((NamedDecl**)Ptr,
+                                        (NamedDecl**)Ptr + (Second ? 2 : 1));
     }
 
     assert(getAsVector() && "Must have a vector at this point");
@@ -125,10 +148,15 @@ public:
   bool HandleRedeclaration(NamedDecl *D) {
     // Most decls only have one entry in their list, special case it.
     if (NamedDecl *OldD = getAsDecl()) {
-      if (!D->declarationReplaces(OldD))
-        return false;
-      setOnlyValue(D);
-      return true;
+      if (D->declarationReplaces(OldD)) {
+        Data = D;
+        return true;
+      }
+      if (Second && D->declarationReplaces(Second)) {
+        Second = D;
+        return true;
+      }
+      return false;
     }
 
     // Determine if this declaration is actually a redeclaration.
@@ -149,11 +177,33 @@ public:
   /// not a redeclaration to merge it into the appropriate place in our list.
   ///
   void AddSubsequentDecl(NamedDecl *D) {
-    // If this is the second decl added to the list, convert this to vector
-    // form.
+    // If this is the second decl added to the list, keep it inline, ordered
+    // as described below.
     if (NamedDecl *OldD = getAsDecl()) {
+      if (!Second) {
+        if (D->hasTagIdentifierNamespace())
+          Second = D;
+        else if (D->getIdentifierNamespace() & Decl::IDNS_Using) {
+          if (D->getIdentifierNamespace() != Decl::IDNS_Using &&
+              OldD->getIdentifierNamespace() == Decl::IDNS_Using)
+            Second = D;
+          else {
+            Second = OldD;
+            Data = D;
+          }
+        } else if (OldD->hasTagIdentifierNamespace()) {
+          Second = OldD;
+          Data = D;
+        } else
+          Second = D;
+        return;
+      }
+
+      // Otherwise, this is the third decl; convert the list to vector form.
       DeclsTy *VT = new DeclsTy();
       VT->push_back(OldD);
+      VT->push_back(Second);
+      Second = 0;
       Data = VT;
     }
 
@@ -199,12 +249,58 @@ class StoredDeclsMap
   : public llvm::SmallDenseMap<DeclarationName, StoredDeclsList, 4> {
 
 public:
+  StoredDeclsMap() : NumFilteredNames(0) {}
+
   static void DestroyAll(StoredDeclsMap *Map, bool Dependent);
 
+  /// \brief Retrieve the list of declarations for \p Name, creating an empty
+  /// one if there is none, and keep the name filter up to date.
+  StoredDeclsList &getOrCreate(DeclarationName Name) {
+    unsigned OldSize = size();
+    StoredDeclsList &List = (*this)[Name];
+    if (size() != OldSize)
+      addToFilter(Name);
+    return List;
+  }
+
+  /// \brief Whether \p Name may have an entry in this map.  A false result
+  /// means the map does not need to be probed.
+  bool mayContain(DeclarationName Name) {
+    if (Filter.empty())
+      return true;
+    if (NumFilteredNames != size())
+      rebuildFilter();
+    unsigned Bit1, Bit2;
+    getFilterBits(Name, Bit1, Bit2);
+    return (Filter[Bit1 / 64] & (uint64_t(1) << (Bit1 % 64))) &&
+           (Filter[Bit2 / 64] & (uint64_t(1) << (Bit2 % 64)));
+  }
+
 private:
   friend class ASTContext; // walks the chain deleting these
   friend class DeclContext;
   llvm::PointerIntPair<StoredDeclsMap*, 1> Previous;
+
+  /// \brief A Bloom filter over the names in the map, or empty if the map is
+  /// small enough to be probed directly.
+  std::vector<uint64_t> Filter;
+
+  /// \brief The number of names the filter was built from.  If this differs
+  /// from the size of the map, names were added without going through
+  /// getOrCreate() and the filter must be rebuilt.
+  unsigned NumFilteredNames;
+
+  void getFilterBits(DeclarationName Name, unsigned &Bit1,
+                     unsigned &Bit2) const {
+    uint64_t Hash = uint64_t(uintptr_t(Name.getAsOpaquePtr())) *
+                    0x9E3779B97F4A7C15ULL;
+    unsigned Mask = Filter.size() * 64 - 1;
+    Bit1 = unsigned(Hash >> 40) & Mask;
+    Bit2 = unsigned(Hash >> 16) & Mask;
+  }
+
+  void addToFilter(DeclarationName Name);
+  void rebuildFilter();
 };
 
 class DependentStoredDeclsMap : public StoredDeclsMap {
@@ -287,7 +287,7 @@ class FunctionTemplateSpecializationInfo : public llvm::FoldingSetNode {
     Template(Template, TSK - 1),
     TemplateArguments(TemplateArgs),
     TemplateArgumentsAsWritten(TemplateArgsAsWritten),
-    PointOfInstantiation(POI) { }
+    PointOfInstantiation(POI), UniquedTemplateArgs(0) { }
 
 public:
   static FunctionTemplateSpecializationInfo *
@@ -352,19 +352,17 @@ public:
     PointOfInstantiation = POI;
   }
 
-  void Profile(llvm::FoldingSetNodeID &ID) {
-    Profile(ID, TemplateArguments->data(),
-            TemplateArguments->size(),
-            Function->getASTContext());
-  }
+  /// \brief The uniqued identity of the template arguments, computed on
+  /// first use.
+  const UniquedTemplateArgumentList *UniquedTemplateArgs;
+
+  void Profile(llvm::FoldingSetNodeID &ID);
 
+  /// \brief Profile a specialization by the uniqued identity of its template
+  /// arguments.
   static void
   Profile(llvm::FoldingSetNodeID &ID, const TemplateArgument *TemplateArgs,
-          unsigned NumTemplateArgs, ASTContext &Context) {
-    ID.AddInteger(NumTemplateArgs);
-    for (unsigned Arg = 0; Arg != NumTemplateArgs; ++Arg)
-      TemplateArgs[Arg].Profile(ID, Context);
-  }
+          unsigned NumTemplateArgs, ASTContext &Context);
 };
 
 /// \brief Provides information a specialization of a member of a class
@@ -568,6 +566,11 @@ protected:
                          const TemplateArgument *Args, unsigned NumArgs,
                          void *&InsertPos);
 
+  template <class EntryType> typename SpecEntryTraits<EntryType>::DeclType*
+  findSpecializationImpl(llvm::FoldingSetVector<EntryType> &Specs,
+                         const UniquedTemplateArgumentList *Args,
+                         void *&InsertPos);
+
   struct CommonBase {
     CommonBase() : InstantiatedFromMember(0, false) { }
 
@@ -1384,6 +1387,10 @@ class ClassTemplateSpecializationDecl
   /// \brief The template arguments used to describe this specialization.
   TemplateArgumentList *TemplateArgs;
 
+  /// \brief The uniqued identity of the template arguments, computed on
+  /// first use.
+  mutable const UniquedTemplateArgumentList *UniquedTemplateArgs;
+
   /// \brief The point where this template was instantiated (if any)
   SourceLocation PointOfInstantiation;
 
@@ -1573,17 +1580,25 @@ public:
 
   SourceRange getSourceRange() const LLVM_READONLY;
 
-  void Profile(llvm::FoldingSetNodeID &ID) const {
-    Profile(ID, TemplateArgs->data(), TemplateArgs->size(), getASTContext());
+  /// \brief Retrieve the uniqued identity of the template arguments,
+  /// uniquing them if that has not happened yet.
+  const UniquedTemplateArgumentList *getUniquedTemplateArgs() const;
+
+  /// \brief Set the uniqued identity of the template arguments, if the
+  /// caller already uniqued them to look up this specialization.
+  void setUniquedTemplateArgs(const UniquedTemplateArgumentList *Args) {
+    assert(Args->size() == TemplateArgs->size() &&
+           "Uniqued arguments do not match the specialization");
+    UniquedTemplateArgs = Args;
   }
 
+  void Profile(llvm::FoldingSetNodeID &ID) const;
+
+  /// \brief Profile a specialization by the uniqued identity of its template
+  /// arguments.
   static void
   Profile(llvm::FoldingSetNodeID &ID, const TemplateArgument *TemplateArgs,
-          unsigned NumTemplateArgs, ASTContext &Context) {
-    ID.AddInteger(NumTemplateArgs);
-    for (unsigned Arg = 0; Arg != NumTemplateArgs; ++Arg)
-      TemplateArgs[Arg].Profile(ID, Context);
-  }
+          unsigned NumTemplateArgs, ASTContext &Context);
 
   static bool classof(const Decl *D) { return classofKind(D->getKind()); }
   static bool classofKind(Kind K) {
@@ -1855,10 +1870,18 @@ public:
 
   /// \brief Return the specialization with the provided arguments if it exists,
   /// otherwise return the insertion point.
+  ///
+  /// The insertion point is null if the arguments have never been uniqued.
   ClassTemplateSpecializationDecl *
   findSpecialization(const TemplateArgument *Args, unsigned NumArgs,
                      void *&InsertPos);
 
+  /// \brief Return the specialization with the provided uniqued arguments if
+  /// it exists, otherwise return the insertion point.
+  ClassTemplateSpecializationDecl *
+  findSpecialization(const UniquedTemplateArgumentList *Args,
+                     void *&InsertPos);
+
   /// \brief Insert the specified specialization knowing that it is not already
   /// in. InsertPos must be obtained from findSpecialization.
   void AddSpecialization(ClassTemplateSpecializationDecl *D, void *InsertPos);
@@ -1893,10 +1916,18 @@ public:
 
   /// \brief Return the partial specialization with the provided arguments if it
   /// exists, otherwise return the insertion point.
+  ///
+  /// The insertion point is null if the arguments have never been uniqued.
   ClassTemplatePartialSpecializationDecl *
   findPartialSpecialization(const TemplateArgument *Args, unsigned NumArgs,
                             void *&InsertPos);
 
+  /// \brief Return the partial specialization with the provided uniqued
+  /// arguments if it exists, otherwise return the insertion point.
+  ClassTemplatePartialSpecializationDecl *
+  findPartialSpecialization(const UniquedTemplateArgumentList *Args,
+                            void *&InsertPos);
+
   /// \brief Insert the specified partial specialization knowing that it is not
   /// already in. InsertPos must be obtained from findPartialSpecialization.
   void AddPartialSpecialization(ClassTemplatePartialSpecializationDecl *D,
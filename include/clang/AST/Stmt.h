@@ -330,17 +330,21 @@ private:
   /// \brief Whether statistic collection is enabled.
   static bool StatisticsEnabled;
 
+  /// \brief Whether created statements are counted, which statistic
+  /// collection implies.
+  static bool CountingEnabled;
+
 protected:
   /// \brief Construct an empty statement.
   explicit Stmt(StmtClass SC, EmptyShell) {
     StmtBits.sClass = SC;
-    if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    if (CountingEnabled) Stmt::addStmtClass(SC);
   }
 
 public:
   Stmt(StmtClass SC) {
     StmtBits.sClass = SC;
-    if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    if (CountingEnabled) Stmt::addStmtClass(SC);
   }
 
   StmtClass getStmtClass() const {
@@ -360,6 +364,14 @@ public:
   static void EnableStatistics();
   static void PrintStats();
 
+  /// \brief Count the statements and expressions created from now on,
+  /// without collecting the rest of the statistics.
+  static void EnableCounting();
+
+  /// \brief The number of statements and expressions created while
+  /// statistics or counting were enabled.
+  static unsigned getNumCreated();
+
   /// dump - This does a local dump of the specified AST fragment.  It dumps the
   /// specified node and a few nodes underneath it, but not the whole subtree.
   /// This is useful in a debugger.
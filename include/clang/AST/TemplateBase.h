@@ -18,14 +18,11 @@
 #include "clang/AST/Type.h"
 #include "clang/AST/TemplateName.h"
 #include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
 
-namespace llvm {
-  class FoldingSetNodeID;
-}
-
 namespace clang {
 
 class DiagnosticBuilder;
@@ -332,6 +329,35 @@ public:
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context) const;
 };
 
+/// \brief The uniqued identity of a template argument list.
+///
+/// ASTContext::getUniquedTemplateArgumentList() returns the same object for
+/// any two argument lists that profile identically, i.e., that name the same
+/// specialization of a given template. The profile is computed and hashed
+/// once, when an argument list is first uniqued, so that finding it again
+/// never re-profiles the argument lists that are already uniqued, and
+/// specializations can be keyed by the pointer alone.
+class UniquedTemplateArgumentList : public llvm::FoldingSetNode {
+  llvm::FoldingSetNodeIDRef ProfileData;
+  unsigned Hash;
+  unsigned NumArgs;
+
+  friend class ASTContext;
+  UniquedTemplateArgumentList(llvm::FoldingSetNodeIDRef ProfileData,
+                              unsigned NumArgs)
+    : ProfileData(ProfileData), Hash(ProfileData.ComputeHash()),
+      NumArgs(NumArgs) { }
+
+public:
+  /// \brief The profile of the argument list, as computed by
+  /// TemplateArgument::Profile() for each argument.
+  llvm::FoldingSetNodeIDRef getProfile() const { return ProfileData; }
+
+  unsigned getHash() const { return Hash; }
+
+  unsigned size() const { return NumArgs; }
+};
+
 /// Location information for a TemplateArgument.
 struct TemplateArgumentLocInfo {
 private:
@@ -643,4 +669,26 @@ inline const TemplateArgument &
   
 } // end namespace clang
 
+namespace llvm {
+  /// Uniqued template argument lists are compared by their stored profile
+  /// and hash, without re-profiling them.
+  template<> struct FoldingSetTrait<clang::UniquedTemplateArgumentList> {
+    static void Profile(const clang::UniquedTemplateArgumentList &X,
+                        FoldingSetNodeID &ID) {
+      FoldingSetNodeIDRef Profile = X.getProfile();
+      for (unsigned I = 0, N = Profile.getSize(); I != N; ++I)
+        ID.AddInteger(Profile.getData()[I]);
+    }
+    static bool Equals(const clang::UniquedTemplateArgumentList &X,
+                       const FoldingSetNodeID &ID, unsigned IDHash,
+                       FoldingSetNodeID &TempID) {
+      return X.getHash() == IDHash && ID == X.getProfile();
+    }
+    static unsigned ComputeHash(const clang::UniquedTemplateArgumentList &X,
+                                FoldingSetNodeID &TempID) {
+      return X.getHash();
+    }
+  };
+}
+
 #endif
@@ -221,6 +221,10 @@ public:
   const FileEntry *getVirtualFile(StringRef Filename, off_t Size,
                                   time_t ModificationTime);
 
+  /// \brief Whether any virtual files have been created, which may not
+  /// exist on disk.
+  bool hasVirtualFiles() const { return !VirtualFileEntries.empty(); }
+
   /// \brief Open the specified file as a MemoryBuffer, returning a new
   /// MemoryBuffer if successful, otherwise returning null.
   llvm::MemoryBuffer *getBufferForFile(const FileEntry *Entry,
@@ -19,6 +19,7 @@
 #include "clang/Basic/OperatorKinds.h"
 #include "clang/Basic/TokenKinds.h"
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/OwningPtr.h"
@@ -424,6 +425,10 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  /// \brief If non-null, the names of the identifiers added to the table are
+  /// appended to this vector.
+  SmallVectorImpl<StringRef> *NewIdentifiers;
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -439,6 +444,15 @@ public:
   IdentifierInfoLookup *getExternalIdentifierLookup() const {
     return ExternalLookup;
   }
+
+  /// \brief Append the names of the identifiers added to the table from now
+  /// on to \p Names, or stop doing so if it is null.
+  ///
+  /// This lets clients that index the table keep up with it without walking
+  /// it again.
+  void setNewIdentifierLog(SmallVectorImpl<StringRef> *Names) {
+    NewIdentifiers = Names;
+  }
   
   llvm::BumpPtrAllocator& getAllocator() {
     return HashTable.getAllocator();
@@ -459,6 +473,8 @@ public:
       if (II) {
         // Cache in the StringMap for subsequent lookups.
         Entry.setValue(II);
+        if (NewIdentifiers)
+          NewIdentifiers->push_back(Entry.getKey());
         return *II;
       }
     }
@@ -472,6 +488,8 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    if (NewIdentifiers)
+      NewIdentifiers->push_back(Entry.getKey());
     return *II;
   }
 
@@ -507,6 +525,9 @@ public:
       // If this is the 'import' contextual keyword, mark it as such.
       if (Name.equals("import"))
         II->setModulesImport(true);
+
+      if (NewIdentifiers)
+        NewIdentifiers->push_back(Entry.getKey());
     }
 
     return *II;
@@ -0,0 +1,160 @@
+//===--- TimeTrace.h - Scoped frontend phase profiler -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the TimeTraceProfiler, which records how long the phases of
+/// a compilation take and writes them in the Chrome trace event format.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACE_H
+#define LLVM_CLANG_BASIC_TIMETRACE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/DataTypes.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+
+/// \brief Records nested, named time intervals ("events") of a compilation,
+/// such as the preprocessing of a header or the instantiation of a template.
+///
+/// Events are recorded on one of several tracks.  Events on the same track
+/// must nest properly; events on different tracks may overlap arbitrarily.
+/// This matters for the preprocessor, whose files begin and end in the
+/// middle of whatever the parser is doing.
+///
+/// There is at most one active profiler.  When none is active, the cost of
+/// an instrumentation point is a single load and branch, so instrumentation
+/// can stay in release builds.  Events shorter than the granularity of the
+/// profiler are only accounted in the per-name totals, which keeps the trace
+/// small.
+class TimeTraceProfiler {
+  struct Event {
+    uint64_t Start;
+    uint64_t Duration;
+    std::string Name;
+    std::string Detail;
+  };
+
+  struct Total {
+    unsigned Count;
+    uint64_t Duration;
+  };
+
+public:
+  /// \brief The independent timelines that events are recorded on.
+  enum Track {
+    /// \brief Phases of the frontend and backend, such as parsing a
+    /// declaration or instantiating a template.
+    FrontendTrack,
+    /// \brief The files entered by the preprocessor.
+    IncludeTrack,
+    NumTracks
+  };
+
+private:
+  /// \brief The events of each track that have begun but not yet ended,
+  /// innermost last.
+  std::vector<Event> Stacks[NumTracks];
+
+  /// \brief The completed events of each track that are long enough to be
+  /// written out.
+  std::vector<Event> Events[NumTracks];
+
+  /// \brief The accumulated duration of all events of each name.  Nested
+  /// events of the same name are only counted once.
+  llvm::StringMap<Total> Totals;
+
+  uint64_t StartTime;
+  unsigned Granularity;
+
+  static TimeTraceProfiler *Instance;
+
+  explicit TimeTraceProfiler(unsigned Granularity);
+
+  TimeTraceProfiler(const TimeTraceProfiler &) LLVM_DELETED_FUNCTION;
+  void operator=(const TimeTraceProfiler &) LLVM_DELETED_FUNCTION;
+
+public:
+  /// \brief Return the active profiler, or null if time tracing is off.
+  static TimeTraceProfiler *get() { return Instance; }
+
+  /// \brief Return the current wall-clock time in microseconds.  This is the
+  /// clock that events are timed with; other frontend measurements use it
+  /// too, whether or not time tracing is on, so that they agree.
+  static uint64_t getCurrentTime();
+
+  /// \brief Start tracing.  Events shorter than \p Granularity microseconds
+  /// are not written individually.
+  static void start(unsigned Granularity);
+
+  /// \brief Stop tracing and discard everything that was recorded.
+  static void stop();
+
+  /// \brief Begin an event on track \p T, which lasts until the matching
+  /// call to end() for the same track.
+  void begin(StringRef Name, StringRef Detail = StringRef(),
+             Track T = FrontendTrack);
+
+  /// \brief End the innermost event of track \p T.
+  void end(Track T = FrontendTrack);
+
+  /// \brief Set the detail, e.g. the file or declaration name, of the
+  /// innermost event of track \p T.
+  void setDetail(StringRef Detail, Track T = FrontendTrack);
+
+  /// \brief Write the recorded events in the Chrome trace event format, as
+  /// understood by chrome://tracing.  Events that have not ended yet are
+  /// written as if they ended now.
+  void write(raw_ostream &OS);
+};
+
+/// \brief Records an event for the lifetime of the scope if time tracing is
+/// on.
+///
+/// Details that are expensive to compute should only be set if isActive():
+/// \code
+///   TimeTraceScope TimeScope("InstantiateClass");
+///   if (TimeScope.isActive())
+///     TimeScope.setDetail(Instantiation->getQualifiedNameAsString());
+/// \endcode
+class TimeTraceScope {
+  TimeTraceProfiler *Profiler;
+
+  TimeTraceScope(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+  void operator=(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+
+public:
+  explicit TimeTraceScope(StringRef Name, StringRef Detail = StringRef())
+    : Profiler(TimeTraceProfiler::get()) {
+    if (Profiler)
+      Profiler->begin(Name, Detail);
+  }
+
+  ~TimeTraceScope() {
+    if (Profiler)
+      Profiler->end();
+  }
+
+  bool isActive() const { return Profiler != 0; }
+
+  void setDetail(StringRef Detail) {
+    if (Profiler)
+      Profiler->setDetail(Detail);
+  }
+};
+
+} // end namespace clang
+
+#endif
@@ -51,6 +51,7 @@ class Decl;
 class DiagnosticsEngine;
 class FileEntry;
 class FileManager;
+class FunctionDecl;
 class HeaderSearch;
 class Preprocessor;
 class SourceManager;
@@ -749,6 +750,7 @@ public:
                             bool IncludeBriefCommentsInCodeCompletion = false,
                                       bool AllowPCHWithCompilerErrors = false,
                                       bool SkipFunctionBodies = false,
+                                      bool RetainSkippedFunctionBodies = false,
                                       bool UserFilesAreVolatile = false,
                                       OwningPtr<ASTUnit> *ErrAST = 0);
   
@@ -760,6 +762,17 @@ public:
   bool Reparse(RemappedFile *RemappedFiles = 0,
                unsigned NumRemappedFiles = 0);
 
+  /// \brief Parse the body of \p FD, if it was skipped while this unit was
+  /// parsed with both SkipFunctionBodies and RetainSkippedFunctionBodies.
+  ///
+  /// The body is parsed within the Sema state left by the parse of the unit,
+  /// so only the body itself is parsed.  Its diagnostics are stored with
+  /// those of the unit.  No body is retained under
+  /// -fdelayed-template-parsing.
+  ///
+  /// \returns True if a skipped body was parsed, false otherwise.
+  bool parseSkippedFunctionBody(FunctionDecl *FD);
+
   /// \brief Perform code completion at the given file, line, and
   /// column within this translation unit.
   ///
@@ -16,6 +16,7 @@
 
 namespace clang {
 
+class HeaderCostReport;
 class Module;
   
 //===----------------------------------------------------------------------===//
@@ -133,6 +134,21 @@ public:
   virtual bool hasCodeCompletionSupport() const { return true; }
 };
 
+/// \brief Parses the input and reports what each header it includes costs.
+class HeaderCostReportAction : public ASTFrontendAction {
+  HeaderCostReport *Aggregate;
+
+protected:
+  virtual ASTConsumer *CreateASTConsumer(CompilerInstance &CI,
+                                         StringRef InFile);
+
+public:
+  /// \param Aggregate If non-null, the report accumulated over all inputs
+  /// the action is run on.  Otherwise, a report is printed for each input.
+  explicit HeaderCostReportAction(HeaderCostReport *Aggregate = 0)
+    : Aggregate(Aggregate) { }
+};
+
 /**
  * \brief Frontend action adaptor that merges ASTs together.
  *
@@ -42,6 +42,7 @@ namespace frontend {
     ParseSyntaxOnly,        ///< Parse and perform semantic analysis.
     PluginAction,           ///< Run a plugin action, \see ActionName.
     PrintDeclContext,       ///< Print DeclContext and their Decls.
+    PrintHeaderCosts,       ///< Report what each included header costs.
     PrintPreamble,          ///< Print the "preamble" of the input file
     PrintPreprocessedInput, ///< -E mode.
     RewriteMacros,          ///< Expand macros but not \#includes.
@@ -94,6 +95,9 @@ public:
   unsigned RelocatablePCH : 1;             ///< When generating PCH files,
                                            /// instruct the AST writer to create
                                            /// relocatable PCH files.
+  unsigned CompressASTSourceBuffers : 1;   ///< When generating PCH or module
+                                           /// files, compress the contents of
+                                           /// embedded source buffers.
   unsigned ShowHelp : 1;                   ///< Show the -help text.
   unsigned ShowStats : 1;                  ///< Show frontend performance
                                            /// metrics and statistics.
@@ -111,6 +115,11 @@ public:
                                            /// speed up parsing in cases you do
                                            /// not need them (e.g. with code
                                            /// completion).
+  unsigned RetainSkippedFunctionBodies : 1; ///< Keep the tokens of skipped
+                                           /// function bodies so that they
+                                           /// can be parsed on demand.
+  unsigned ShowTemplateProfile : 1;        ///< Show the cost of each template
+                                           /// instantiation.
 
   CodeCompleteOptions CodeCompleteOpts;
 
@@ -145,6 +154,26 @@ public:
   /// If given, filter dumped AST Decl nodes by this substring.
   std::string ASTDumpFilter;
 
+  /// If given, the file to which a profile of AST file deserialization will
+  /// be written.
+  std::string ASTDeserializationProfileFile;
+
+  /// If given, the file to which a Chrome trace of the time spent in each
+  /// compilation phase will be written.
+  std::string TimeTraceFile;
+
+  /// The minimum duration, in microseconds, of the events that are written
+  /// to the time trace.
+  unsigned TimeTraceGranularity;
+
+  /// The order of the template instantiation profile: "time", "inclusive",
+  /// "count" or "nodes".
+  std::string TemplateProfileSort;
+
+  /// The number of entries per table of the template instantiation profile,
+  /// or 0 to show all of them.
+  unsigned TemplateProfileLimit;
+
   /// If given, enable code completion at the provided location.
   ParsedSourceLocation CodeCompletionAt;
 
@@ -183,13 +212,19 @@ public:
     ProgramAction = frontend::ParseSyntaxOnly;
     ActionName = "";
     RelocatablePCH = 0;
+    CompressASTSourceBuffers = 0;
     ShowHelp = 0;
     ShowStats = 0;
     ShowTimers = 0;
+    TimeTraceGranularity = 500;
     ShowVersion = 0;
     ARCMTAction = ARCMT_None;
     ARCMTMigrateEmitARCErrors = 0;
     SkipFunctionBodies = 0;
+    RetainSkippedFunctionBodies = 0;
+    ShowTemplateProfile = 0;
+    TemplateProfileSort = "time";
+    TemplateProfileLimit = 20;
     ObjCMTAction = ObjCMT_None;
   }
 
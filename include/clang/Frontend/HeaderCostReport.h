@@ -0,0 +1,117 @@
+//===--- HeaderCostReport.h - Per-header compile cost report ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines HeaderCostReport, which attributes the cost of compiling
+// translation units to the headers they include.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_HEADERCOSTREPORT_H
+#define LLVM_CLANG_FRONTEND_HEADERCOSTREPORT_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/DataTypes.h"
+
+namespace clang {
+
+class ASTConsumer;
+class CompilerInstance;
+
+/// \brief What it costs to compile a header, summed over all translation
+/// units it was included by.
+struct HeaderCost {
+  /// \brief The number of translation units that included the header.
+  unsigned NumTranslationUnits;
+
+  /// \brief The number of \#include directives that named the header,
+  /// including those skipped because of include guards or \#pragma once.
+  unsigned NumIncludes;
+
+  /// \brief The number of times the header was actually entered and lexed.
+  unsigned NumEntered;
+
+  /// \brief The bytes lexed from the header itself.
+  uint64_t BytesLexed;
+
+  /// \brief The number of tokens in the text of the header, times the
+  /// number of times it was entered.  The tokens are counted by raw-lexing
+  /// the file, so this includes the tokens of skipped conditional blocks and
+  /// of macro definitions, and is an upper bound of what the preprocessor
+  /// returned.
+  uint64_t RawTokens;
+
+  /// \brief The wall-clock time in seconds during which the header was on
+  /// the include stack (inclusive) or on top of it (exclusive).  Since
+  /// parsing is interleaved with preprocessing, this includes the time spent
+  /// parsing the contents of the header.
+  double InclusiveTime;
+  double ExclusiveTime;
+
+  /// \brief The number of declarations written in the header.
+  unsigned NumDecls;
+
+  /// \brief The time from the end of the previous top-level declaration to
+  /// the end of each top-level declaration of the header, summed.  This is
+  /// the time spent parsing and analyzing the declarations, including the
+  /// instantiations they trigger, but also the time spent preprocessing
+  /// their tokens and any headers included between them, since the parser
+  /// drives the preprocessor.
+  double ParseTime;
+
+  /// \brief The time spent instantiating templates defined in the header,
+  /// exclusive of nested instantiations.
+  double InstantiationTime;
+
+  HeaderCost()
+    : NumTranslationUnits(0), NumIncludes(0), NumEntered(0), BytesLexed(0),
+      RawTokens(0), InclusiveTime(0), ExclusiveTime(0), NumDecls(0),
+      ParseTime(0), InstantiationTime(0) { }
+
+  void add(const HeaderCost &Other);
+};
+
+/// \brief The costs of the headers included by one or more translation units.
+class HeaderCostReport {
+  llvm::StringMap<HeaderCost> Headers;
+  unsigned NumTranslationUnits;
+
+public:
+  HeaderCostReport() : NumTranslationUnits(0) { }
+
+  /// \brief Return the costs of the header with the given path.
+  HeaderCost &getCost(StringRef Header) { return Headers[Header]; }
+
+  unsigned getNumHeaders() const { return Headers.size(); }
+  unsigned getNumTranslationUnits() const { return NumTranslationUnits; }
+
+  /// \brief Add the costs of the given report, which covers other
+  /// translation units, to this one.
+  void merge(const HeaderCostReport &Other);
+
+  /// \brief Note that one more translation unit has been measured.
+  void addTranslationUnit() { ++NumTranslationUnits; }
+
+  /// \brief Print the headers with the highest inclusive time first.
+  ///
+  /// \param MaxHeaders If non-zero, the number of headers to print.
+  void print(raw_ostream &OS, unsigned MaxHeaders = 0) const;
+};
+
+/// \brief Create an AST consumer that measures what the headers included by
+/// the translation unit that \p CI is compiling cost.
+///
+/// \param Aggregate If non-null, the costs are added to this report at the
+/// end of the translation unit.  Otherwise, they are printed to stdout.
+ASTConsumer *CreateHeaderCostConsumer(CompilerInstance &CI,
+                                      HeaderCostReport *Aggregate);
+
+} // end namespace clang
+
+#endif
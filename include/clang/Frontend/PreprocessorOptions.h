@@ -54,6 +54,9 @@ public:
                                /// preprocessing record we should also keep
                                /// track of locations of conditional directives
                                /// in non-system files.
+  unsigned DetailedRecordOnlyMainFileExpansions : 1; /// Whether the
+                               /// preprocessing record should leave out the
+                               /// macro expansions outside the main file.
   
   /// The implicit PCH included at the start of the translation unit, or empty.
   std::string ImplicitPCHInclude;
@@ -93,6 +96,23 @@ public:
   /// If given, a PTH cache file to use for speeding up header parsing.
   std::string TokenCache;
 
+  /// \brief Additional PTH files that are used as token cache shards.
+  std::vector<std::string> TokenCacheShards;
+
+  /// \brief Whether to share the controlling macros of headers with the other
+  /// translation units compiled by this process, so that an \#include of an
+  /// include-guarded header whose guard is already defined is skipped without
+  /// entering the header.
+  bool UseSharedIncludeGuardCache;
+
+  /// \brief If given, a file from which the shared include guard cache is
+  /// loaded, and to which it is saved after the translation unit.
+  std::string IncludeGuardCacheFile;
+
+  /// \brief Whether the pre-expanded forms of macro arguments are memoized
+  /// and replayed when the same argument tokens are expanded again.
+  bool MemoizeMacroArgExpansions;
+
   /// \brief True if the SourceManager should report the original file name for
   /// contents of files that were remapped to other files. Defaults to true.
   bool RemappedFilesKeepOriginalName;
@@ -167,10 +187,13 @@ public:
 public:
   PreprocessorOptions() : UsePredefines(true), DetailedRecord(false),
                           DetailedRecordConditionalDirectives(false),
+                          DetailedRecordOnlyMainFileExpansions(false),
                           DisablePCHValidation(false), DisableStatCache(false),
                           AllowPCHWithCompilerErrors(false),
                           DumpDeserializedPCHDecls(false),
                           PrecompiledPreambleBytes(0, true),
+                          UseSharedIncludeGuardCache(false),
+                          MemoizeMacroArgExpansions(false),
                           RemappedFilesKeepOriginalName(true),
                           RetainRemappedFileBuffers(false),
                           ObjCXXARCStandardLibrary(ARCXX_nolib) { }
@@ -213,6 +236,9 @@ public:
     ImplicitPCHInclude.clear();
     ImplicitPTHInclude.clear();
     TokenCache.clear();
+    TokenCacheShards.clear();
+    UseSharedIncludeGuardCache = false;
+    IncludeGuardCacheFile.clear();
     RetainRemappedFileBuffers = true;
     PrecompiledPreambleBytes.first = 0;
     PrecompiledPreambleBytes.second = 0;
@@ -0,0 +1,86 @@
+//===--- CachedTokenBuffer.h - Token buffer for backtracking ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the CachedTokenBuffer interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_CACHEDTOKENBUFFER_H
+#define LLVM_CLANG_LEX_CACHEDTOKENBUFFER_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Lex/Token.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+
+namespace clang {
+
+/// \brief The tokens the Preprocessor caches for lookahead and backtracking.
+///
+/// Tokens are stored in fixed-size chunks allocated from the Preprocessor's
+/// BumpPtrAllocator.  Growing the buffer never copies the tokens already in
+/// it, so references returned by LookAhead() stay valid while more tokens
+/// are peeked, and chunks are kept and reused when the buffer is cleared, so
+/// a translation unit only allocates as many chunks as its longest tentative
+/// parse needs.
+class CachedTokenBuffer {
+  enum { ChunkSizeLog2 = 6, ChunkSize = 1 << ChunkSizeLog2 };
+
+  llvm::BumpPtrAllocator &Allocator;
+  SmallVector<Token *, 4> Chunks;
+  unsigned Size;
+
+  CachedTokenBuffer(const CachedTokenBuffer &) LLVM_DELETED_FUNCTION;
+  void operator=(const CachedTokenBuffer &) LLVM_DELETED_FUNCTION;
+
+  Token &get(unsigned I) const {
+    return Chunks[I >> ChunkSizeLog2][I & (ChunkSize - 1)];
+  }
+
+public:
+  explicit CachedTokenBuffer(llvm::BumpPtrAllocator &Allocator)
+    : Allocator(Allocator), Size(0) { }
+
+  unsigned size() const { return Size; }
+  bool empty() const { return Size == 0; }
+
+  /// \brief The number of tokens the buffer can hold without allocating.
+  unsigned capacity() const { return Chunks.size() * ChunkSize; }
+
+  Token &operator[](unsigned I) {
+    assert(I < Size && "Cached token index out of range");
+    return get(I);
+  }
+  const Token &operator[](unsigned I) const {
+    assert(I < Size && "Cached token index out of range");
+    return get(I);
+  }
+
+  Token &back() { return (*this)[Size - 1]; }
+
+  void push_back(const Token &Tok) {
+    if (Size == capacity())
+      Chunks.push_back(Allocator.Allocate<Token>(ChunkSize));
+    get(Size++) = Tok;
+  }
+
+  /// \brief Insert \p Tok before the token at index \p I.
+  void insert(unsigned I, const Token &Tok);
+
+  /// \brief Remove the tokens in [Begin, End).
+  void erase(unsigned Begin, unsigned End);
+
+  /// \brief Remove all tokens, keeping the chunks for reuse.
+  void clear() { Size = 0; }
+};
+
+} // end namespace clang
+
+#endif
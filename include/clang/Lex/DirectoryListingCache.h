@@ -0,0 +1,91 @@
+//===--- DirectoryListingCache.h - Search directory contents ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the DirectoryListingCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
+#define LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Mutex.h"
+#include <ctime>
+#include <vector>
+
+namespace clang {
+
+/// \brief Caches the contents of header search directories, so that header
+/// lookups can skip directories that cannot contain the requested file
+/// without a failed \c stat for each of them.
+///
+/// A single cache can be shared by every compilation in the process (see
+/// \c getShared()). Each listing is validated against the modification time
+/// of its directory, and is re-read when the directory changes.
+class DirectoryListingCache {
+  DirectoryListingCache(const DirectoryListingCache &) LLVM_DELETED_FUNCTION;
+  void operator=(const DirectoryListingCache &) LLVM_DELETED_FUNCTION;
+
+public:
+  /// \brief The names of the entries of a directory at some point in time.
+  ///
+  /// A listing is immutable once built, and lives as long as the cache, so
+  /// it can be used without holding the cache's lock.
+  class Listing {
+    /// \brief The entry names, in lowercase so that lookups behave the same
+    /// on case-insensitive file systems.
+    llvm::StringSet<> Names;
+
+    /// \brief The modification time of the directory when it was listed.
+    time_t ModTime;
+
+    /// \brief When the directory was listed.
+    time_t ReadTime;
+
+    friend class DirectoryListingCache;
+
+  public:
+    /// \brief Whether the directory may contain an entry with the given name.
+    bool mayContain(StringRef Name) const;
+  };
+
+private:
+  /// \brief The current listing of each directory, keyed by absolute path.
+  llvm::StringMap<Listing *> Listings;
+
+  /// \brief All listings ever created, including those for directories that
+  /// have since changed, which may still be in use.
+  std::vector<Listing *> AllListings;
+
+  unsigned NumListingsRead, NumListingsReused;
+
+  mutable llvm::sys::Mutex Lock;
+
+public:
+  DirectoryListingCache() : NumListingsRead(0), NumListingsReused(0) { }
+  ~DirectoryListingCache();
+
+  /// \brief Retrieve the cache shared by all compilations in this process.
+  static DirectoryListingCache &getShared();
+
+  /// \brief Retrieve the listing of the directory with the given absolute
+  /// path, whose current modification time is \p ModTime.
+  ///
+  /// \returns the listing, or NULL if the directory could not be read.
+  const Listing *getListing(StringRef DirName, time_t ModTime);
+
+  void PrintStats() const;
+};
+
+}  // end namespace clang.
+
+#endif
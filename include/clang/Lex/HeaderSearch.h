@@ -14,6 +14,7 @@
 #ifndef LLVM_CLANG_LEX_HEADERSEARCH_H
 #define LLVM_CLANG_LEX_HEADERSEARCH_H
 
+#include "clang/Lex/DirectoryListingCache.h"
 #include "clang/Lex/DirectoryLookup.h"
 #include "clang/Lex/ModuleMap.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -193,6 +194,16 @@ class HeaderSearch {
   /// headers were included as framework headers.
   llvm::StringSet<llvm::BumpPtrAllocator> FrameworkNames;
   
+  /// \brief The cache of search directory contents shared with other
+  /// translation units, if any.
+  DirectoryListingCache *ListingCache;
+
+  /// \brief The contents of each search directory, validated against the
+  /// directory once per HeaderSearch, or NULL if the directory could not be
+  /// listed.
+  llvm::DenseMap<const DirectoryEntry *,
+                 const DirectoryListingCache::Listing *> DirectoryListings;
+
   /// \brief Entity used to resolve the identifier IDs of controlling
   /// macros into IdentifierInfo pointers, as needed.
   ExternalIdentifierLookup *ExternalLookup;
@@ -204,6 +215,7 @@ class HeaderSearch {
   unsigned NumIncluded;
   unsigned NumMultiIncludeFileOptzn;
   unsigned NumFrameworkLookups, NumSubFrameworkLookups;
+  unsigned NumLookupsSkippedByListing;
 
   // HeaderSearch doesn't support default or copy construction.
   HeaderSearch(const HeaderSearch&) LLVM_DELETED_FUNCTION;
@@ -240,6 +252,13 @@ public:
     SystemDirIdx++;
   }
 
+  /// \brief Set the cache of search directory contents, which is used to
+  /// avoid looking for files in directories that do not contain them.
+  void setDirectoryListingCache(DirectoryListingCache *Cache) {
+    ListingCache = Cache;
+    DirectoryListings.clear();
+  }
+
   /// \brief Set the list of system header prefixes.
   void SetSystemHeaderPrefixes(ArrayRef<std::pair<std::string, bool> > P) {
     SystemHeaderPrefixes.assign(P.begin(), P.end());
@@ -441,6 +460,12 @@ public:
   
   void IncrementFrameworkLookupCount() { ++NumFrameworkLookups; }
 
+  /// \brief Determine whether the given search directory may contain the
+  /// file with the given name, using the directory listing cache.
+  ///
+  /// \returns false only if the file definitely does not exist.
+  bool mayContainFile(const DirectoryEntry *Dir, StringRef Filename);
+
   /// \brief Determine whether there is a module map that may map the header
   /// with the given file name to a (sub)module.
   ///
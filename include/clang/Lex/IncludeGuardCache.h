@@ -0,0 +1,97 @@
+//===--- IncludeGuardCache.h - Include guards shared across TUs -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the IncludeGuardCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
+#define LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Mutex.h"
+#include <string>
+#include <ctime>
+#include <sys/types.h>
+
+namespace clang {
+  class FileEntry;
+
+/// \brief Remembers the controlling macro of multiple-include-guarded headers
+/// across translation units.
+///
+/// HeaderSearch only learns that a header is wrapped in an include guard after
+/// lexing it once, and forgets this at the end of each translation unit. An
+/// IncludeGuardCache records the guard macro of each header, together with
+/// the size and modification time of the header when it was lexed, so that a
+/// later translation unit can skip an \#include of that header without ever
+/// entering it when the guard macro is already defined.
+///
+/// A single cache can be shared by every compilation in the process (see
+/// \c getShared()), and it can be saved to and loaded from disk to share it
+/// between processes. All operations are thread-safe.
+class IncludeGuardCache {
+  IncludeGuardCache(const IncludeGuardCache &) LLVM_DELETED_FUNCTION;
+  void operator=(const IncludeGuardCache &) LLVM_DELETED_FUNCTION;
+
+  struct Entry {
+    off_t Size;
+    time_t ModTime;
+    std::string Macro;
+  };
+
+  /// \brief Entries, keyed by the absolute path of the header.
+  llvm::StringMap<Entry> Entries;
+
+  /// \brief Whether there are entries that have not been saved.
+  bool Dirty;
+
+  mutable llvm::sys::Mutex Lock;
+
+  /// \brief Compute the key used for the given file.
+  static std::string getKey(const FileEntry *File);
+
+public:
+  IncludeGuardCache() : Dirty(false) { }
+
+  /// \brief Retrieve the cache shared by all compilations in this process.
+  static IncludeGuardCache &getShared();
+
+  /// \brief Look for the controlling macro of the given file.
+  ///
+  /// \returns true and sets \p Macro if the file was previously found to be
+  /// guarded by a controlling macro, and it has not changed since.
+  bool lookup(const FileEntry *File, std::string &Macro) const;
+
+  /// \brief Record that the given file is guarded by \p Macro.
+  void record(const FileEntry *File, StringRef Macro);
+
+  /// \brief Merge the entries stored in the given file into this cache.
+  ///
+  /// \returns true if the file exists but could not be read.
+  bool load(StringRef Path);
+
+  /// \brief Write the entries of this cache to the given file, if there are
+  /// any that the file may not have.
+  ///
+  /// The file is replaced atomically, so concurrent compilations can share a
+  /// cache file.
+  ///
+  /// \returns true if an error occurred.
+  bool save(StringRef Path);
+
+  /// \brief The number of headers with a known controlling macro.
+  unsigned size() const;
+};
+
+}  // end namespace clang.
+
+#endif
@@ -74,6 +74,10 @@ class PTHManager : public IdentifierInfoLookup {
   ///  if the file (if any) that was to used to generate the PTH cache.
   const char* OriginalSourceFile;
 
+  /// IsShard - Whether this PTH file is one of several token cache shards
+  ///  consulted by the preprocessor, rather than its primary token cache.
+  bool IsShard;
+
   /// This constructor is intended to only be called by the static 'Create'
   /// method.
   PTHManager(const llvm::MemoryBuffer* buf, void* fileLookup,
@@ -122,6 +126,16 @@ public:
 
   void setPreprocessor(Preprocessor *pp) { PP = pp; }
 
+  /// setIsShard - Mark this PTH file as a token cache shard.  Shards can be
+  ///  produced independently (e.g., one per header, by separate compiler
+  ///  invocations) and shared by every translation unit that includes the
+  ///  cached files.  A shard resolves identifiers through the preprocessor's
+  ///  identifier table, so that several shards can be used together, and only
+  ///  provides tokens for files whose stat information still matches the
+  ///  information recorded when the shard was generated.
+  void setIsShard(bool Shard) { IsShard = Shard; }
+  bool isShard() const { return IsShard; }
+
   /// CreateLexer - Return a PTHLexer that "lexes" the cached tokens for the
   ///  specified file.  This method returns NULL if no cached tokens exist.
   ///  It is the responsibility of the caller to 'delete' the returned object.
@@ -290,9 +290,52 @@ namespace clang {
     /// \brief Allocator used to store preprocessing objects.
     llvm::BumpPtrAllocator BumpAlloc;
 
-    /// \brief The set of preprocessed entities in this record, in order they
-    /// were seen.
-    std::vector<PreprocessedEntity *> PreprocessedEntities;
+    /// \brief How a local preprocessed entity is stored.
+    enum LocalEntityKind {
+      /// \brief A macro expansion; the data is the ID of its definition.
+      LEK_MacroExpansion,
+      /// \brief An expansion of a builtin macro; the data is the ID of the
+      /// name of the macro.
+      LEK_BuiltinMacroExpansion,
+      /// \brief A macro definition; the data is the ID of the name of the
+      /// macro.
+      LEK_MacroDefinition,
+      /// \brief An inclusion directive, or any other entity that was created
+      /// before being added; the data is unused and the entity is always
+      /// materialized.
+      LEK_Materialized
+    };
+
+    /// \brief The set of preprocessed entities in this record, in source
+    /// order, stored as parallel arrays.
+    ///
+    /// A macro-heavy translation unit has far more macro expansions than
+    /// anything else, and most clients only ever look at the entities in a
+    /// small range.  Rather than allocating an object per entity, the record
+    /// stores the kind, the source range and a 32-bit datum of each, and only
+    /// creates the PreprocessedEntity objects that are asked for.
+    ///
+    /// The begin and end locations are kept apart so that the binary searches
+    /// in findBeginLocalPreprocessedEntity() and
+    /// findEndLocalPreprocessedEntity() only touch the array they compare.
+    std::vector<SourceLocation> LocalBegins;
+    std::vector<SourceLocation> LocalEnds;
+    std::vector<unsigned char> LocalKinds;
+    std::vector<int> LocalData;
+
+    /// \brief The local entities that have been materialized, by index, or
+    /// null.  This only grows up to the highest materialized index.
+    std::vector<PreprocessedEntity *> MaterializedEntities;
+
+    /// \brief The names of the recorded macro definitions and builtin macro
+    /// expansions, indexed by name ID.
+    std::vector<IdentifierInfo *> Names;
+    llvm::DenseMap<const IdentifierInfo *, unsigned> NameIDs;
+
+    unsigned getNameID(const IdentifierInfo *II);
+
+    /// \brief Whether macro expansions outside the main file are dropped.
+    bool OnlyMainFileExpansions;
     
     /// \brief The set of preprocessed entities in this record that have been
     /// loaded from external sources.
@@ -371,6 +414,29 @@ namespace clang {
       return LoadedPreprocessedEntities.size();
     }
 
+    /// \brief Retrieve the local preprocessed entity at the given index,
+    /// creating it if needed.
+    PreprocessedEntity *getLocalPreprocessedEntity(unsigned Index);
+
+    void setMaterializedEntity(unsigned Index, PreprocessedEntity *Entity);
+
+    unsigned getNumLocalPreprocessedEntities() const {
+      return LocalBegins.size();
+    }
+
+    /// \brief Add a local entity, keeping the entities sorted by their begin
+    /// location.
+    PPEntityID addLocalEntity(LocalEntityKind Kind, SourceRange Range,
+                              int Data, PreprocessedEntity *Materialized);
+
+    /// \brief Renumber the local entities from \p Index on, to make room for
+    /// an entity inserted at \p Index.
+    void shiftLocalEntities(unsigned Index);
+
+    /// \brief Returns the ID of the definition of \p MI, if it is recorded and
+    /// valid.
+    llvm::Optional<PPEntityID> findMacroDefinitionID(const MacroInfo *MI);
+
     /// \brief Returns a pair of [Begin, End) indices of local preprocessed
     /// entities that \p Range encompasses.
     std::pair<unsigned, unsigned>
@@ -389,7 +455,12 @@ namespace clang {
     
   public:
     /// \brief Construct a new preprocessing record.
-    PreprocessingRecord(SourceManager &SM, bool RecordConditionalDirectives);
+    ///
+    /// \param OnlyMainFileExpansions Whether to record only the macro
+    /// expansions in the main file.  Definitions and inclusion directives are
+    /// recorded regardless.
+    PreprocessingRecord(SourceManager &SM, bool RecordConditionalDirectives,
+                        bool OnlyMainFileExpansions = false);
     
     /// \brief Allocate memory in the preprocessing record.
     void *Allocate(unsigned Size, unsigned Align = 8) {
@@ -526,7 +597,7 @@ namespace clang {
 
     /// \brief End iterator for all preprocessed entities.
     iterator end() {
-      return iterator(this, PreprocessedEntities.size());
+      return iterator(this, LocalBegins.size());
     }
 
     /// \brief Begin iterator for local, non-loaded, preprocessed entities.
@@ -536,7 +607,7 @@ namespace clang {
 
     /// \brief End iterator for local, non-loaded, preprocessed entities.
     iterator local_end() {
-      return iterator(this, PreprocessedEntities.size());
+      return iterator(this, LocalBegins.size());
     }
 
     /// \brief Returns a pair of [Begin, End) iterators of preprocessed entities
@@ -555,6 +626,13 @@ namespace clang {
     /// \see getPreprocessedEntitiesInRange.
     bool isEntityInFileID(iterator PPEI, FileID FID);
 
+    /// \brief Returns the kind of the preprocessed entity that \p PPEI points
+    /// to.
+    ///
+    /// Unlike dereferencing the iterator, this does not create the entity if
+    /// it is local.
+    PreprocessedEntity::EntityKind getEntityKind(iterator PPEI);
+
     /// \brief Add a new preprocessed entity to this record.
     PPEntityID addPreprocessedEntity(PreprocessedEntity *Entity);
 
@@ -14,6 +14,7 @@
 #ifndef LLVM_CLANG_LEX_PREPROCESSOR_H
 #define LLVM_CLANG_LEX_PREPROCESSOR_H
 
+#include "clang/Lex/CachedTokenBuffer.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/PTHLexer.h"
@@ -44,8 +45,10 @@ class ExternalPreprocessorSource;
 class FileManager;
 class FileEntry;
 class HeaderSearch;
+class IncludeGuardCache;
 class PragmaNamespace;
 class PragmaHandler;
+class PreExpansionCache;
 class CommentHandler;
 class ScratchBuffer;
 class TargetInfo;
@@ -99,6 +102,15 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   ///  a token cache rather than lexing the original source file.
   OwningPtr<PTHManager> PTH;
 
+  /// TokenCacheShards - Additional token caches, consulted in order when the
+  ///  primary PTH file has no tokens for a file being entered.  These are
+  ///  owned by the Preprocessor.
+  SmallVector<PTHManager*, 4> TokenCacheShards;
+
+  /// GuardCache - An optional cache of include guards shared with other
+  ///  translation units.  Not owned by the Preprocessor.
+  IncludeGuardCache *GuardCache;
+
   /// BP - A BumpPtrAllocator object used to quickly allocate and release
   ///  objects internal to the Preprocessor.
   llvm::BumpPtrAllocator BP;
@@ -313,11 +325,27 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   typedef llvm::SmallPtrSet<SourceLocation, 32> WarnUnusedMacroLocsTy;
   WarnUnusedMacroLocsTy WarnUnusedMacroLocs;
 
-  /// MacroArgCache - This is a "freelist" of MacroArg objects that can be
-  /// reused for quick allocation.
-  MacroArgs *MacroArgCache;
+  enum { NumMacroArgSizeClasses = 32 };
+
+  /// MacroArgCache - These are "freelists" of MacroArg objects that can be
+  /// reused for quick allocation, one for each size class.  The objects in
+  /// MacroArgCache[N] have room for 2^N unexpanded argument tokens.
+  MacroArgs *MacroArgCache[NumMacroArgSizeClasses];
   friend class MacroArgs;
 
+  /// PreExpCache - If non-null, pre-expanded macro arguments are memoized
+  /// here and replayed for identical arguments.
+  PreExpansionCache *PreExpCache;
+  friend class PreExpansionCache;
+
+  /// MacroDefinitionGeneration - Incremented whenever the set of visible macro
+  /// definitions changes, which invalidates memoized argument expansions.
+  unsigned MacroDefinitionGeneration;
+
+  /// NumSuppressedMacroExpansions - The number of times a macro name was not
+  /// expanded because the macro was disabled (C99 6.10.3.4p2).
+  unsigned NumSuppressedMacroExpansions;
+
   /// PragmaPushMacroInfo - For each IdentifierInfo used in a #pragma
   /// push_macro directive, we keep a MacroInfo stack used to restore
   /// previous macro value.
@@ -327,9 +355,12 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   unsigned NumDirectives, NumIncluded, NumDefined, NumUndefined, NumPragma;
   unsigned NumIf, NumElse, NumEndif;
   unsigned NumEnteredSourceFiles, MaxIncludeStackDepth;
+  unsigned NumTokenCacheShardHits, NumIncludeGuardCacheHits;
   unsigned NumMacroExpanded, NumFnMacroExpanded, NumBuiltinMacroExpanded;
   unsigned NumFastMacroExpanded, NumTokenPaste, NumFastTokenPaste;
   unsigned NumSkipped;
+  unsigned NumMacroArgsAllocated, NumMacroArgsReused;
+  size_t MacroArgsBytesAllocated;
 
   /// Predefines - This string is the predefined macros that preprocessor
   /// should use from the command line etc.
@@ -356,22 +387,27 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   PreprocessingRecord *Record;
 
 private:  // Cached tokens state.
-  typedef SmallVector<Token, 1> CachedTokensTy;
-
   /// CachedTokens - Cached tokens are stored here when we do backtracking or
   /// lookahead. They are "lexed" by the CachingLex() method.
-  CachedTokensTy CachedTokens;
+  CachedTokenBuffer CachedTokens;
 
   /// CachedLexPos - The position of the cached token that CachingLex() should
-  /// "lex" next. If it points beyond the CachedTokens vector, it means that
+  /// "lex" next. If it points beyond the CachedTokens buffer, it means that
   /// a normal Lex() should be invoked.
-  CachedTokensTy::size_type CachedLexPos;
+  unsigned CachedLexPos;
 
   /// BacktrackPositions - Stack of backtrack positions, allowing nested
   /// backtracks. The EnableBacktrackAtThisPos() method pushes a position to
   /// indicate where CachedLexPos should be set when the BackTrack() method is
   /// invoked (at which point the last position is popped).
-  std::vector<CachedTokensTy::size_type> BacktrackPositions;
+  SmallVector<unsigned, 8> BacktrackPositions;
+
+  /// Statistics about backtracking: the number of backtrack positions
+  /// entered, how many of them were backtracked to, the number of tokens
+  /// those backtracks made the parser see again, and the largest number of
+  /// tokens cached at once.
+  unsigned NumBacktrackPositions, NumBacktracks, NumBacktrackedTokens;
+  unsigned MaxCachedTokens;
 
   struct MacroInfoChain {
     MacroInfo MI;
@@ -423,6 +459,18 @@ public:
 
   PTHManager *getPTHManager() { return PTH.get(); }
 
+  /// \brief Add a token cache shard, which will be used to provide tokens for
+  /// any file it contains that is not covered by the primary PTH file.
+  /// The Preprocessor takes ownership of \p Shard.
+  void addTokenCacheShard(PTHManager *Shard);
+
+  /// \brief Set the cache used to share the controlling macros of headers
+  /// with other translation units, so that an \#include of a guarded header
+  /// whose guard is already defined can be skipped without entering it.
+  void setIncludeGuardCache(IncludeGuardCache *Cache) { GuardCache = Cache; }
+
+  IncludeGuardCache *getIncludeGuardCache() const { return GuardCache; }
+
   void setExternalSource(ExternalPreprocessorSource *Source) {
     ExternalSource = Source;
   }
@@ -444,6 +492,11 @@ public:
   bool getCommentRetentionState() const { return KeepComments; }
 
   void setPragmasEnabled(bool Enabled) { PragmasEnabled = Enabled; }
+
+  /// \brief Control whether the pre-expanded forms of macro arguments are
+  /// memoized and reused for identical arguments.
+  void setMemoizeMacroArgExpansions(bool Memoize);
+  bool getMemoizeMacroArgExpansions() const { return PreExpCache != 0; }
   bool getPragmasEnabled() const { return PragmasEnabled; }
 
   void SetSuppressIncludeNotFoundError(bool Suppress) {
@@ -503,6 +556,11 @@ public:
   /// \brief Undefine a macro for this identifier.
   void clearMacroInfo(IdentifierInfo *II);
 
+  /// \brief Note that the visible macro definitions changed without going
+  /// through setMacroInfo or clearMacroInfo, e.g. because a module was
+  /// made visible.
+  void markMacroDefinitionsChanged() { ++MacroDefinitionGeneration; }
+
   /// macro_iterator/macro_begin/macro_end - This allows you to walk the macro
   /// history table. Currently defined macros have
   /// IdentifierInfo::hasMacroDefinition() set and an empty
@@ -583,7 +641,11 @@ public:
 
   /// \brief Create a new preprocessing record, which will keep track of
   /// all macro expansions, macro definitions, etc.
-  void createPreprocessingRecord(bool RecordConditionalDirectives);
+  ///
+  /// \param OnlyMainFileExpansions Whether to leave out the macro expansions
+  /// outside the main file.
+  void createPreprocessingRecord(bool RecordConditionalDirectives,
+                                 bool OnlyMainFileExpansions = false);
 
   /// EnterMainSourceFile - Enter the specified FileID as the main source file,
   /// which implicitly adds the builtin defines etc.
@@ -735,7 +797,7 @@ public:
   /// point.
   void EnterToken(const Token &Tok) {
     EnterCachingLexMode();
-    CachedTokens.insert(CachedTokens.begin()+CachedLexPos, Tok);
+    CachedTokens.insert(CachedLexPos, Tok);
   }
 
   /// AnnotateCachedTokens - We notify the Preprocessor that if it is caching
@@ -21,6 +21,7 @@ namespace clang {
   class ASTConsumer;
   class ASTContext;
   class CodeCompleteConsumer;
+  class FunctionDecl;
   class Sema;
 
   /// \brief Parse the entire file specified, notifying the ASTConsumer as
@@ -33,16 +34,30 @@ namespace clang {
   ///
   /// \param CompletionConsumer If given, an object to consume code completion
   /// results.
+  ///
+  /// \param RetainSkippedFunctionBodies If function bodies are skipped, keep
+  /// their tokens so that ParseSkippedFunctionBody() can parse them later.
+  /// Ignored when templates are parsed late.
   void ParseAST(Preprocessor &pp, ASTConsumer *C,
                 ASTContext &Ctx, bool PrintStats = false,
                 TranslationUnitKind TUKind = TU_Complete,
                 CodeCompleteConsumer *CompletionConsumer = 0,
-                bool SkipFunctionBodies = false);
+                bool SkipFunctionBodies = false,
+                bool RetainSkippedFunctionBodies = false);
 
   /// \brief Parse the main file known to the preprocessor, producing an 
   /// abstract syntax tree.
   void ParseAST(Sema &S, bool PrintStats = false,
-                bool SkipFunctionBodies = false);
+                bool SkipFunctionBodies = false,
+                bool RetainSkippedFunctionBodies = false);
+
+  /// \brief Parse the body of \p FD, which was skipped and retained when
+  /// the translation unit of \p S was parsed, within the state that parse
+  /// left in \p S.
+  ///
+  /// \returns true if \p FD had such a body, which is now attached to its
+  /// definition.
+  bool ParseSkippedFunctionBody(Sema &S, FunctionDecl *FD);
   
 }  // end namespace clang
 
@@ -223,8 +223,13 @@ class Parser : public CodeCompletionHandler {
 
   bool SkipFunctionBodies;
 
+  /// \brief Whether the tokens of skipped function bodies are kept in Sema
+  /// so that the bodies can be parsed on demand.
+  bool RetainSkippedFunctionBodies;
+
 public:
-  Parser(Preprocessor &PP, Sema &Actions, bool SkipFunctionBodies);
+  Parser(Preprocessor &PP, Sema &Actions, bool SkipFunctionBodies,
+         bool RetainSkippedFunctionBodies = false);
   ~Parser();
 
   const LangOptions &getLangOpts() const { return PP.getLangOpts(); }
@@ -286,6 +291,11 @@ public:
   /// the EOF was encountered.
   bool ParseTopLevelDecl(DeclGroupPtrTy &Result);
 
+  /// ParseSkippedFunctionBody - Parse the body of \p FD, which a parser
+  /// that retained skipped function bodies skipped over, after the whole
+  /// translation unit has been parsed. Returns true if there was such a body.
+  bool ParseSkippedFunctionBody(FunctionDecl *FD);
+
   /// ConsumeToken - Consume the current 'peek token' and lex the next one.
   /// This does not work with all kinds of tokens: strings and specific other
   /// tokens must be consumed with custom methods below.  This returns the
@@ -1594,8 +1604,10 @@ private:
   /// \brief When in code-completion, skip parsing of the function/method body
   /// unless the body contains the code-completion point.
   ///
+  /// \param Toks If non-null, receives the tokens of the skipped body.
+  ///
   /// \returns true if the function body was skipped.
-  bool trySkippingFunctionBody();
+  bool trySkippingFunctionBody(CachedTokens *Toks = 0);
 
   bool ParseImplicitInt(DeclSpec &DS, CXXScopeSpec *SS,
                         const ParsedTemplateInfo &TemplateInfo,
@@ -22,6 +22,7 @@
 #include "clang/AST/Type.h"
 #include "clang/AST/UnresolvedSet.h"
 #include "clang/Sema/SemaFixItUtils.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Allocator.h"
@@ -748,6 +749,13 @@ namespace clang {
     unsigned NumInlineSequences;
     char InlineSpace[16 * sizeof(ImplicitConversionSequence)];
 
+    /// \brief The conversion sequences computed for the arguments of the
+    /// candidates in this set, keyed by the argument, the parameter type and
+    /// the conversion flags, so that candidates with parameters of the same
+    /// type share them.
+    typedef std::pair<std::pair<Expr *, void *>, unsigned> ConversionKey;
+    llvm::DenseMap<ConversionKey, ImplicitConversionSequence> ConversionCache;
+
     OverloadCandidateSet(const OverloadCandidateSet &) LLVM_DELETED_FUNCTION;
     void operator=(const OverloadCandidateSet &) LLVM_DELETED_FUNCTION;
 
@@ -800,6 +808,24 @@ namespace clang {
       return C;
     }
 
+    /// \brief Retrieve the conversion sequence already computed for
+    /// initializing a parameter of type \p ParamType from \p Arg with the
+    /// given flags, if any.
+    const ImplicitConversionSequence *
+    getCachedConversion(Expr *Arg, QualType ParamType, unsigned Flags) const {
+      llvm::DenseMap<ConversionKey, ImplicitConversionSequence>::const_iterator
+        I = ConversionCache.find(ConversionKey(std::make_pair(
+                                 Arg, ParamType.getAsOpaquePtr()), Flags));
+      return I == ConversionCache.end() ? 0 : &I->second;
+    }
+
+    void cacheConversion(Expr *Arg, QualType ParamType, unsigned Flags,
+                         const ImplicitConversionSequence &ICS) {
+      ConversionCache[ConversionKey(std::make_pair(Arg,
+                                               ParamType.getAsOpaquePtr()),
+                                Flags)] = ICS;
+    }
+
     /// Find the best viable function on this overload set, if it exists.
     OverloadingResult BestViableFunction(Sema &S, SourceLocation Loc,
                                          OverloadCandidateSet::iterator& Best,
@@ -37,6 +37,7 @@
 #include "clang/Basic/TypeTraits.h"
 #include "clang/Basic/ExpressionTraits.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SetVector.h"
@@ -146,6 +147,7 @@ namespace clang {
   class TemplateArgumentList;
   class TemplateArgumentLoc;
   class TemplateDecl;
+  class TemplateInstantiationProfile;
   class TemplateParameterList;
   class TemplatePartialOrderingContext;
   class TemplateTemplateParmDecl;
@@ -208,6 +210,18 @@ public:
   /// \brief Flag indicating whether or not to collect detailed statistics.
   bool CollectStats;
 
+  /// \brief If non-null, receives the wall-clock time in seconds spent
+  /// instantiating template definitions, exclusive of nested instantiations,
+  /// keyed by the file that contains the instantiated pattern.
+  llvm::DenseMap<FileID, double> *InstantiationTimes;
+
+  /// \brief The time spent in instantiations nested within the innermost
+  /// instantiation that is being timed.
+  double NestedInstantiationTime;
+
+  /// \brief If non-null, records the cost of each template instantiation.
+  OwningPtr<TemplateInstantiationProfile> TemplateProfile;
+
   /// \brief Source of additional semantic information.
   ExternalSemaSource *ExternalSource;
 
@@ -369,6 +383,16 @@ public:
     OpaqueParser = P;
   }
 
+  /// \brief The tokens of the function bodies that the parser skipped but
+  /// retained, which can be parsed on demand by ParseSkippedFunctionBody().
+  typedef llvm::DenseMap<const FunctionDecl *, CachedTokens *>
+    SkippedFunctionBodiesMap;
+  SkippedFunctionBodiesMap SkippedFunctionBodies;
+
+  /// \brief Find the redeclaration of \p FD whose body was skipped and
+  /// retained, if there is one.
+  FunctionDecl *getSkippedFunctionBodyDefinition(FunctionDecl *FD) const;
+
   class DelayedDiagnostics;
 
   class DelayedDiagnosticsState {
@@ -692,6 +716,25 @@ public:
   /// \brief The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// \brief Overload resolution statistics: the number of function
+  /// candidates considered, how many of those were rejected without
+  /// computing a conversion sequence, and how many argument conversion
+  /// sequences were computed or reused from another candidate of the set.
+  unsigned NumOverloadCandidates, NumOverloadCandidatesPruned;
+  unsigned NumConversionSequencesComputed, NumConversionSequencesReused;
+
+  /// \brief The number of pending implicit instantiations performed.
+  unsigned NumPendingInstantiationsPerformed;
+
+  /// \brief The number of pending implicit instantiations performed from the
+  /// outermost queue, and how many of those neither performed nor queued
+  /// another pending instantiation, nor created a template specialization
+  /// or a type.  The latter do not depend on the order in which the queue is
+  /// drained.  This is a measurement only; the queue is always drained
+  /// serially.
+  unsigned NumOutermostPendingInstantiations;
+  unsigned NumIndependentPendingInstantiations;
+
   typedef llvm::DenseMap<ParmVarDecl *, SmallVector<ParmVarDecl *, 1> >
     UnparsedDefaultArgInstantiationsMap;
 
@@ -5770,6 +5813,25 @@ public:
     return ExprEvalContexts.back().Context == Sema::Unevaluated;
   }
 
+  /// \brief RAII class that adds the time spent instantiating a template
+  /// definition to InstantiationTimes and TemplateProfile, if those are
+  /// being collected.
+  class InstantiationTimer {
+    Sema &SemaRef;
+    FileID PatternFile;
+    uint64_t Start;
+    double PrevNestedTime;
+    bool Profiled;
+
+    InstantiationTimer(const InstantiationTimer &) LLVM_DELETED_FUNCTION;
+    void operator=(const InstantiationTimer &) LLVM_DELETED_FUNCTION;
+
+  public:
+    InstantiationTimer(Sema &SemaRef, SourceLocation PointOfInstantiation,
+                       const Decl *Instantiation, const Decl *Pattern);
+    ~InstantiationTimer();
+  };
+
   /// \brief RAII class used to determine whether SFINAE has
   /// trapped any errors that occur during template argument
   /// deduction.`
@@ -5822,6 +5884,28 @@ public:
   /// string represents a keyword.
   UnqualifiedTyposCorrectedMap UnqualifiedTyposCorrected;
 
+  typedef std::pair<IdentifierInfo *, std::pair<DeclContext *, unsigned> >
+    MemberTypo;
+
+  /// \brief The typos in lookups of a given kind into complete classes for
+  /// which no correction was found.
+  llvm::DenseSet<MemberTypo> MemberTyposNotCorrected;
+
+  /// \brief The index of the identifiers that typos are corrected to, built
+  /// when the first typo is corrected.
+  OwningPtr<TypoCorrectionIndex> TypoIndex;
+
+  /// \brief The time spent correcting typos, in seconds.
+  double TypoCorrectionTime;
+
+  /// \brief Whether typo correction was disabled for the rest of the
+  /// translation unit because it exceeded its time limit.
+  bool TypoCorrectionDisabled;
+
+  /// \brief The number of identifiers whose edit distance to a typo was
+  /// computed, and the number that the typo correction index ruled out.
+  unsigned NumTypoCandidatesChecked, NumTypoCandidatesSkipped;
+
   /// \brief Worker object for performing CFG-based warnings.
   sema::AnalysisBasedWarnings AnalysisWarnings;
 
@@ -5848,7 +5932,12 @@ public:
   /// types, static variables, enumerators, etc.
   std::deque<PendingImplicitInstantiation> PendingLocalImplicitInstantiations;
 
+  /// \brief The number of calls to PerformPendingInstantiations() that are
+  /// draining the queue of pending implicit instantiations.
+  unsigned PendingInstantiationDepth;
+
   void PerformPendingInstantiations(bool LocalOnly = false);
+  void PerformPendingInstantiation(PendingImplicitInstantiation Inst);
 
   TypeSourceInfo *SubstType(TypeSourceInfo *T,
                             const MultiLevelTemplateArgumentList &TemplateArgs,
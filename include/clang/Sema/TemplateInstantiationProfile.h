@@ -0,0 +1,134 @@
+//===--- TemplateInstantiationProfile.h - Instantiation profile -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines TemplateInstantiationProfile, which records what the
+//  template instantiations of a translation unit cost.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_TEMPLATEINSTANTIATIONPROFILE_H
+#define LLVM_CLANG_SEMA_TEMPLATEINSTANTIATIONPROFILE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/DataTypes.h"
+
+namespace clang {
+
+class ASTContext;
+class Decl;
+
+/// \brief Records the number, time and AST nodes of the template
+/// instantiations performed by Sema, per template, per specialization and
+/// per point of instantiation in non-template code.
+///
+/// Inclusive costs contain the cost of the instantiations that were
+/// triggered while instantiating, exclusive costs do not.  A template that
+/// is instantiated recursively only accounts the outermost instantiation in
+/// its inclusive cost, so inclusive costs never exceed the total.
+class TemplateInstantiationProfile {
+public:
+  struct Stats {
+    /// \brief The number of definitions instantiated.
+    unsigned NumInstantiations;
+
+    /// \brief The number of times a specialization was named, and how many
+    /// of those found an existing specialization that could be reused.
+    unsigned NumLookups;
+    unsigned NumReused;
+
+    /// \brief Wall-clock time, in seconds.
+    double InclusiveTime;
+    double ExclusiveTime;
+
+    /// \brief The number of declarations, statements and expressions
+    /// created.
+    unsigned InclusiveNodes;
+    unsigned ExclusiveNodes;
+
+    Stats()
+      : NumInstantiations(0), NumLookups(0), NumReused(0), InclusiveTime(0),
+        ExclusiveTime(0), InclusiveNodes(0), ExclusiveNodes(0) { }
+  };
+
+  /// \brief The orders in which the report can be sorted.
+  enum SortKey {
+    SK_ExclusiveTime,
+    SK_InclusiveTime,
+    SK_Count,
+    SK_Nodes
+  };
+
+private:
+  ASTContext &Context;
+
+  struct ActiveInstantiation {
+    const Decl *Template;
+    const Decl *Specialization;
+    SourceLocation PointOfInstantiation;
+    uint64_t StartTime;
+    double NestedTime;
+    unsigned StartNodes;
+    unsigned NestedNodes;
+    unsigned NumNested;
+  };
+
+  /// \brief The instantiations in progress, innermost last.
+  SmallVector<ActiveInstantiation, 8> Stack;
+
+  /// \brief Costs keyed by the canonical declaration of the pattern.
+  llvm::DenseMap<const Decl *, Stats> Templates;
+
+  /// \brief Costs keyed by the instantiated declaration.
+  llvm::DenseMap<const Decl *, Stats> Specializations;
+
+  /// \brief Costs of the outermost instantiations and everything they
+  /// triggered, keyed by the raw encoding of the expansion location of their
+  /// point of instantiation.
+  llvm::DenseMap<unsigned, Stats> PointsOfInstantiation;
+
+  Stats Total;
+
+  static unsigned getNumNodesCreated();
+
+  TemplateInstantiationProfile(const TemplateInstantiationProfile &)
+    LLVM_DELETED_FUNCTION;
+  void operator=(const TemplateInstantiationProfile &) LLVM_DELETED_FUNCTION;
+
+public:
+  /// \brief Create a profile of the instantiations into \p Context.  This
+  /// enables the Decl and Stmt statistics, which count the AST nodes.
+  explicit TemplateInstantiationProfile(ASTContext &Context);
+
+  /// \brief Note that the definition of \p Specialization is being
+  /// instantiated from \p Pattern, until the matching call to
+  /// endInstantiation().
+  void beginInstantiation(const Decl *Specialization, const Decl *Pattern,
+                          SourceLocation PointOfInstantiation);
+  void endInstantiation();
+
+  /// \brief Note that a specialization of the template whose pattern is
+  /// \p Pattern was named, and whether an existing one was found.
+  void noteSpecializationLookup(const Decl *Pattern, bool Found);
+
+  const Stats &getTotal() const { return Total; }
+
+  /// \brief Print the templates, specializations and points of instantiation
+  /// in the given order.
+  ///
+  /// \param Limit If non-zero, the number of entries to print per table.
+  void print(raw_ostream &OS, SortKey Key, unsigned Limit) const;
+};
+
+} // end namespace clang
+
+#endif
@@ -17,9 +17,13 @@
 
 #include "clang/AST/DeclCXX.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
+#include <vector>
 
 namespace clang {
 
+class IdentifierTable;
+
 /// @brief Simple class containing the result of Sema::CorrectTypo
 class TypoCorrection {
 public:
@@ -251,6 +255,57 @@ class DeclFilterCCC : public CorrectionCandidateCallback {
   }
 };
 
+/// @brief An index over the identifiers of an IdentifierTable, used by
+/// Sema::CorrectTypo to find the identifiers that may be close enough to a
+/// typo without computing the edit distance to every one of them.
+///
+/// Identifiers are grouped by length, and each one carries the set of
+/// characters it contains, which gives a cheap lower bound on its edit
+/// distance to the typo.  Once built, the index is kept up to date with the
+/// identifiers the table logs as they are added.
+class TypoCorrectionIndex {
+  struct Entry {
+    StringRef Name;
+    uint64_t Characters;
+  };
+
+  /// \brief The indexed identifiers, grouped by length.
+  std::vector<std::vector<Entry> > ByLength;
+
+  /// \brief The number of indexed identifiers.
+  unsigned NumIndexed;
+
+  /// \brief The table being indexed, once the index has been built.
+  IdentifierTable *Idents;
+
+  /// \brief The identifiers added to the table since the index was last
+  /// updated.
+  SmallVector<StringRef, 16> NewIdentifiers;
+
+  TypoCorrectionIndex(const TypoCorrectionIndex &) LLVM_DELETED_FUNCTION;
+  void operator=(const TypoCorrectionIndex &) LLVM_DELETED_FUNCTION;
+
+  static uint64_t getCharacters(StringRef Name);
+  void add(StringRef Name);
+
+public:
+  TypoCorrectionIndex() : NumIndexed(0), Idents(0) { }
+  ~TypoCorrectionIndex();
+
+  /// \brief Index the identifiers of \p Table that were added since it was
+  /// last indexed.  The index must always be updated from the same table.
+  void update(IdentifierTable &Table);
+
+  /// \brief Find the identifiers whose length differs from that of \p Typo
+  /// by at most \p MaxLengthDifference, and whose edit distance to \p Typo
+  /// may be at most \p MaxDistance.
+  ///
+  /// \returns the number of identifiers that were ruled out.
+  unsigned lookup(StringRef Typo, unsigned MaxLengthDifference,
+                  unsigned MaxDistance,
+                  SmallVectorImpl<StringRef> &Candidates) const;
+};
+
 }
 
 #endif
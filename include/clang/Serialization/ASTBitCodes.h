@@ -490,7 +490,12 @@ namespace clang {
       SM_SLOC_BUFFER_BLOB = 3,
       /// \brief Describes a source location entry (SLocEntry) for a
       /// macro expansion.
-      SM_SLOC_EXPANSION_ENTRY = 4
+      SM_SLOC_EXPANSION_ENTRY = 4,
+      /// \brief Describes a compressed blob that contains the data for a
+      /// buffer entry. Used in place of SM_SLOC_BUFFER_BLOB when the AST
+      /// file was written with source buffer compression enabled. The
+      /// record holds the uncompressed size of the buffer.
+      SM_SLOC_BUFFER_BLOB_COMPRESSED = 5
     };
 
     /// \brief Record types used within a preprocessor block.
@@ -589,6 +589,10 @@ private:
   /// \brief Whether to accept an AST file with compiler errors.
   bool AllowASTWithCompilerErrors;
 
+  /// \brief Whether to collect per-module timing and name lookup information
+  /// for the deserialization profile.
+  bool ProfileDeserialization;
+
   /// \brief The current "generation" of the module file import stack, which 
   /// indicates how many separate module file load operations have occurred.
   unsigned CurrentGeneration;
@@ -613,6 +617,17 @@ private:
   /// \brief The number of source location entries in the chain.
   unsigned TotalNumSLocEntries;
 
+  /// \brief The number of compressed source buffers expanded while
+  /// de-serializing source location entries.
+  unsigned NumSourceBuffersDecompressed;
+
+  /// \brief The total size of the compressed source buffers that have been
+  /// expanded, before and after decompression.
+  uint64_t CompressedSourceBufferBytes, DecompressedSourceBufferBytes;
+
+  /// \brief Wall-clock seconds spent decompressing source buffers.
+  double SourceBufferDecompressionTime;
+
   /// \brief The number of statements (and expressions) de-serialized
   /// from the chain.
   unsigned NumStatementsRead;
@@ -770,6 +785,27 @@ private:
     ~ReadingKindTracker() { Reader.ReadingKind = PrevKind; }
   };
 
+  /// \brief RAII object that charges the time spent reading a record to a
+  /// module file's statistics, excluding the time spent reading any records
+  /// nested within it.
+  class ProfileTimer {
+    ASTReader &Reader;
+    double *Counter;
+    double StartTime;
+    double NestedTime;
+    ProfileTimer *Parent;
+
+    ProfileTimer(const ProfileTimer &) LLVM_DELETED_FUNCTION;
+    void operator=(const ProfileTimer &) LLVM_DELETED_FUNCTION;
+
+  public:
+    ProfileTimer(ASTReader &Reader, double &Counter);
+    ~ProfileTimer();
+  };
+
+  /// \brief The innermost active profile timer, if any.
+  ProfileTimer *CurrentProfileTimer;
+
   /// \brief All predefines buffers in the chain, to be treated as if
   /// concatenated.
   PCHPredefinesBlocks PCHPredefinesBuffers;
@@ -800,6 +836,8 @@ private:
   bool ParseLineTable(ModuleFile &F, SmallVectorImpl<uint64_t> &Record);
   ASTReadResult ReadSourceManagerBlock(ModuleFile &F);
   ASTReadResult ReadSLocEntryRecord(int ID);
+  llvm::MemoryBuffer *ReadSLocBufferBlob(llvm::BitstreamCursor &SLocEntryCursor,
+                                         StringRef Name);
   llvm::BitstreamCursor &SLocCursorForID(int ID);
   SourceLocation getImportLocation(ModuleFile *F);
   ASTReadResult ReadSubmoduleBlock(ModuleFile &F);
@@ -1199,6 +1237,18 @@ public:
   /// \brief Dump information about the AST reader to standard error.
   void dump();
 
+  /// \brief Enable or disable collection of the timing and name lookup
+  /// information reported by \c PrintDeserializationProfile.
+  ///
+  /// This should be set before any AST file is loaded.
+  void setProfileDeserialization(bool Profile) {
+    ProfileDeserialization = Profile;
+  }
+
+  /// \brief Print a JSON description of what was deserialized from each
+  /// loaded module file, and what caused it to be deserialized.
+  void PrintDeserializationProfile(raw_ostream &OS);
+
   /// Return the amount of memory used by memory buffers, breaking down
   /// by heap-backed versus mmap'ed memory.
   virtual void getMemoryBufferSizes(MemoryBufferSizes &sizes) const;
@@ -35,6 +35,7 @@ namespace llvm {
   class APFloat;
   class APInt;
   class BitstreamWriter;
+  class MemoryBuffer;
 }
 
 namespace clang {
@@ -361,6 +362,25 @@ private:
   /// file.
   unsigned NumVisibleDeclContexts;
 
+  /// \brief Whether the contents of buffers embedded in the source manager
+  /// block should be compressed.
+  bool CompressSourceBuffers;
+
+  /// \brief The number of source buffer blobs written to the AST file.
+  unsigned NumSourceBufferBlobs;
+
+  /// \brief The number of source buffer blobs that were stored compressed.
+  unsigned NumCompressedSourceBufferBlobs;
+
+  /// \brief The total size of all source buffer blobs before compression.
+  uint64_t SourceBufferBytes;
+
+  /// \brief The total size of all source buffer blobs as written.
+  uint64_t SourceBufferBytesWritten;
+
+  /// \brief Wall-clock seconds spent compressing source buffer blobs.
+  double SourceBufferCompressionTime;
+
   /// \brief The offset of each CXXBaseSpecifier set within the AST.
   SmallVector<uint32_t, 4> CXXBaseSpecifiersOffsets;
 
@@ -407,6 +427,8 @@ private:
                      const std::string &OutputFile);
   void WriteLanguageOptions(const LangOptions &LangOpts);
   void WriteStatCache(MemorizeStatCalls &StatCalls);
+  void WriteSourceBufferBlob(unsigned Abbrev, unsigned CompressedAbbrev,
+                             const llvm::MemoryBuffer *Buffer);
   void WriteSourceManagerBlock(SourceManager &SourceMgr,
                                const Preprocessor &PP,
                                StringRef isysroot);
@@ -465,6 +487,15 @@ public:
   ASTWriter(llvm::BitstreamWriter &Stream);
   ~ASTWriter();
 
+  /// \brief Set whether the contents of overridden files and memory buffers
+  /// embedded in the AST file should be compressed.
+  void setCompressSourceBuffers(bool Compress) {
+    CompressSourceBuffers = Compress;
+  }
+
+  /// \brief Print statistics about the most recently written AST file.
+  void PrintStats();
+
   /// \brief Write a precompiled header for the given semantic analysis.
   ///
   /// \param SemaRef a reference to the semantic analysis object that processed
@@ -723,6 +754,7 @@ class PCHGenerator : public SemaConsumer {
   raw_ostream *Out;
   Sema *SemaPtr;
   MemorizeStatCalls *StatCalls; // owned by the FileManager
+  bool ShowStats;
   llvm::SmallVector<char, 128> Buffer;
   llvm::BitstreamWriter Stream;
   ASTWriter Writer;
@@ -736,6 +768,15 @@ public:
                clang::Module *Module,
                StringRef isysroot, raw_ostream *Out);
   ~PCHGenerator();
+
+  /// \brief Compress the contents of buffers embedded in the AST file.
+  void setCompressSourceBuffers(bool Compress) {
+    Writer.setCompressSourceBuffers(Compress);
+  }
+
+  /// \brief Print AST writer statistics once the AST file has been written.
+  void setShowStats(bool Show) { ShowStats = Show; }
+
   virtual void InitializeSema(Sema &S) { SemaPtr = &S; }
   virtual void HandleTranslationUnit(ASTContext &Ctx);
   virtual ASTMutationListener *GetASTMutationListener();
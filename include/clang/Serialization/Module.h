@@ -20,6 +20,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include <string>
 
@@ -349,6 +350,28 @@ public:
   /// \brief List of modules which this module depends on
   llvm::SetVector<ModuleFile *> Imports;
 
+  // === Statistics ===
+
+  /// \brief The number of declarations, types, identifiers and selectors
+  /// that have been deserialized from this module file.
+  unsigned NumDeclsRead, NumTypesRead, NumIdentifiersRead, NumSelectorsRead;
+
+  /// \brief The number of bits of declaration and type records that have
+  /// been read from this module file.
+  uint64_t DeclBitsRead, TypeBitsRead;
+
+  /// \brief The time, in seconds, spent reading declaration and type records
+  /// from this module file, excluding nested reads of other records.
+  ///
+  /// Only collected when the AST reader is profiling deserialization.
+  double DeclReadTime, TypeReadTime;
+
+  /// \brief The names whose lookup found declarations in this module file,
+  /// along with the number of times each was looked up.
+  ///
+  /// Only collected when the AST reader is profiling deserialization.
+  llvm::StringMap<unsigned> LookupTriggers;
+
   /// \brief Determine whether this module was directly imported at
   /// any point during translation.
   bool isDirectlyImported() const { return DirectlyImported; }
@@ -14,6 +14,8 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/CharUnits.h"
 #include "clang/AST/CommentCommandTraits.h"
+#include "clang/AST/ConstexprCallCache.h"
+#include "clang/AST/CXXInheritance.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclTemplate.h"
@@ -576,6 +578,9 @@ ASTContext::ASTContext(LangOptions& LOpts, SourceManager &SM,
     ExternalSource(0), Listener(0),
     Comments(SM), CommentsLoaded(false),
     CommentCommandTraits(BumpAlloc),
+    NumDerivedToBaseQueries(0), NumDerivedToBaseCacheHits(0),
+    NumDeclContextLookups(0), NumDeclContextLookupMisses(0),
+    NumDeclContextLookupsFiltered(0), NumTemplateSpecializations(0),
     LastSDM(0, 0),
     UniqueBlockByRefTypeID(0) 
 {
@@ -617,6 +622,12 @@ ASTContext::~ASTContext() {
                                                     AEnd = DeclAttrs.end();
        A != AEnd; ++A)
     A->second->~AttrVec();
+
+  for (llvm::DenseMap<std::pair<const CXXRecordDecl *, const CXXRecordDecl *>,
+                      DerivedToBaseInfo>::iterator
+         I = DerivedToBaseCache.begin(), E = DerivedToBaseCache.end();
+       I != E; ++I)
+    delete I->second.Paths;
 }
 
 void ASTContext::AddDeallocation(void (*Callback)(void*), void *Data) {
@@ -628,6 +639,19 @@ ASTContext::setExternalSource(OwningPtr<ExternalASTSource> &Source) {
   ExternalSource.reset(Source.take());
 }
 
+namespace {
+  /// \brief Orders declaration contexts by decreasing number of lookup
+  /// misses, then by name.
+  struct MoreMissedContext {
+    bool operator()(const std::pair<unsigned, std::string> &X,
+                    const std::pair<unsigned, std::string> &Y) const {
+      if (X.first != Y.first)
+        return X.first > Y.first;
+      return X.second < Y.second;
+    }
+  };
+}
+
 void ASTContext::PrintStats() const {
   llvm::errs() << "\n*** AST Context Stats:\n";
   llvm::errs() << "  " << Types.size() << " types total.\n";
@@ -678,15 +702,57 @@ void ASTContext::PrintStats() const {
   llvm::errs() << NumImplicitDestructorsDeclared << "/"
                << NumImplicitDestructors
                << " implicit destructors created\n";
+  if (getLangOpts().CPlusPlus)
+    llvm::errs() << UniquedTemplateArgumentLists.size()
+                 << " template argument lists uniqued\n";
+  if (getLangOpts().CPlusPlus)
+    llvm::errs() << NumDerivedToBaseCacheHits << "/"
+                 << NumDerivedToBaseQueries
+                 << " derived-to-base queries answered from the cache\n";
+
+  if (NumDeclContextLookups) {
+    llvm::errs() << NumDeclContextLookupMisses << "/" << NumDeclContextLookups
+                 << " declaration context lookups found nothing\n";
+    llvm::errs() << NumDeclContextLookupsFiltered
+                 << " lookup table probes avoided by name filters\n";
+
+    // Show the contexts that were missed the most.
+    typedef std::pair<unsigned, std::string> MissedContext;
+    SmallVector<MissedContext, 16> Missed;
+    for (llvm::DenseMap<const DeclContext *, unsigned>::const_iterator
+           I = DeclContextLookupMisses.begin(),
+           E = DeclContextLookupMisses.end(); I != E; ++I) {
+      const Decl *D = cast<Decl>(I->first);
+      std::string Name = D->getDeclKindName();
+      if (const NamedDecl *ND = dyn_cast<NamedDecl>(D))
+        Name += " '" + ND->getQualifiedNameAsString() + "'";
+      Missed.push_back(MissedContext(I->second, Name));
+    }
+    std::sort(Missed.begin(), Missed.end(), MoreMissedContext());
+    for (unsigned I = 0, N = std::min(Missed.size(), (size_t)5); I != N; ++I)
+      llvm::errs() << "  " << Missed[I].first << " misses in "
+                   << Missed[I].second << "\n";
+  }
 
   if (ExternalSource.get()) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
   }
 
+  if (ConstexprCalls) {
+    llvm::errs() << "\n";
+    ConstexprCalls->PrintStats();
+  }
+
   BumpAlloc.PrintStats();
 }
 
+ConstexprCallCache &ASTContext::getConstexprCallCache() const {
+  if (!ConstexprCalls)
+    ConstexprCalls.reset(new ConstexprCallCache);
+  return *ConstexprCalls;
+}
+
 TypedefDecl *ASTContext::getInt128Decl() const {
   if (!Int128Decl) {
     TypeSourceInfo *TInfo = getTrivialTypeSourceInfo(Int128Ty);
@@ -3728,6 +3794,41 @@ ASTContext::getCanonicalTemplateArgument(const TemplateArgument &Arg) const {
   llvm_unreachable("Unhandled template argument kind");
 }
 
+static void ProfileTemplateArgumentList(llvm::FoldingSetNodeID &ID,
+                                        const TemplateArgument *Args,
+                                        unsigned NumArgs,
+                                        const ASTContext &Context) {
+  ID.AddInteger(NumArgs);
+  for (unsigned I = 0; I != NumArgs; ++I)
+    Args[I].Profile(ID, Context);
+}
+
+const UniquedTemplateArgumentList *
+ASTContext::findUniquedTemplateArgumentList(const TemplateArgument *Args,
+                                            unsigned NumArgs) const {
+  llvm::FoldingSetNodeID ID;
+  ProfileTemplateArgumentList(ID, Args, NumArgs, *this);
+  void *InsertPos = 0;
+  return UniquedTemplateArgumentLists.FindNodeOrInsertPos(ID, InsertPos);
+}
+
+const UniquedTemplateArgumentList *
+ASTContext::getUniquedTemplateArgumentList(const TemplateArgument *Args,
+                                           unsigned NumArgs) const {
+  llvm::FoldingSetNodeID ID;
+  ProfileTemplateArgumentList(ID, Args, NumArgs, *this);
+
+  void *InsertPos = 0;
+  if (UniquedTemplateArgumentList *List
+        = UniquedTemplateArgumentLists.FindNodeOrInsertPos(ID, InsertPos))
+    return List;
+
+  UniquedTemplateArgumentList *List
+    = new (*this) UniquedTemplateArgumentList(ID.Intern(BumpAlloc), NumArgs);
+  UniquedTemplateArgumentLists.InsertNode(List, InsertPos);
+  return List;
+}
+
 NestedNameSpecifier *
 ASTContext::getCanonicalNestedNameSpecifier(NestedNameSpecifier *NNS) const {
   if (!NNS)
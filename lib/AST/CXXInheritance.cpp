@@ -77,10 +77,23 @@ void CXXBasePaths::swap(CXXBasePaths &Other) {
   std::swap(DetectedVirtual, Other.DetectedVirtual);
 }
 
+void CXXBasePaths::copyResults(const CXXBasePaths &Other) {
+  assert(FindAmbiguities == Other.FindAmbiguities &&
+         RecordPaths == Other.RecordPaths &&
+         DetectVirtual == Other.DetectVirtual &&
+         "Copying the results of a different kind of search");
+  Origin = Other.Origin;
+  Paths = Other.Paths;
+  ClassSubobjects = Other.ClassSubobjects;
+  ScratchPath.clear();
+  DetectedVirtual = Other.DetectedVirtual;
+  delete [] DeclsFound;
+  DeclsFound = 0;
+  NumDeclsFound = 0;
+}
+
 bool CXXRecordDecl::isDerivedFrom(const CXXRecordDecl *Base) const {
-  CXXBasePaths Paths(/*FindAmbiguities=*/false, /*RecordPaths=*/false,
-                     /*DetectVirtual=*/false);
-  return isDerivedFrom(Base, Paths);
+  return getASTContext().isDerivedFrom(this, Base);
 }
 
 bool CXXRecordDecl::isDerivedFrom(const CXXRecordDecl *Base,
@@ -726,3 +739,62 @@ CXXRecordDecl::getIndirectPrimaryBases(CXXIndirectPrimaryBaseSet& Bases) const {
   }
 }
 
+/// \brief Retrieve the cached entry for \p Derived and \p Base, computing
+/// whether \p Derived is derived from \p Base if needed, or return null if
+/// the definition of \p Derived is not complete yet.
+ASTContext::DerivedToBaseInfo *
+ASTContext::getDerivedToBaseInfo(const CXXRecordDecl *Derived,
+                                 const CXXRecordDecl *Base) const {
+  ++NumDerivedToBaseQueries;
+
+  // The bases of a class are fixed once its definition is complete, so only
+  // then can the answer be remembered.
+  const CXXRecordDecl *Def = Derived->getDefinition();
+  if (!Def || !Def->isCompleteDefinition() || Def->isBeingDefined())
+    return 0;
+
+  std::pair<const CXXRecordDecl *, const CXXRecordDecl *>
+    Key(Derived->getCanonicalDecl(), Base->getCanonicalDecl());
+  llvm::DenseMap<std::pair<const CXXRecordDecl *, const CXXRecordDecl *>,
+                 DerivedToBaseInfo>::iterator Known
+    = DerivedToBaseCache.find(Key);
+  if (Known != DerivedToBaseCache.end()) {
+    ++NumDerivedToBaseCacheHits;
+    return &Known->second;
+  }
+
+  // Only whether there is a path matters here, so stop at the first one.
+  CXXBasePaths Paths(/*FindAmbiguities=*/false, /*RecordPaths=*/false,
+                     /*DetectVirtual=*/false);
+  DerivedToBaseInfo Info;
+  Info.IsDerived = Def->isDerivedFrom(Base, Paths);
+  Info.Paths = 0;
+  return &(DerivedToBaseCache[Key] = Info);
+}
+
+bool ASTContext::isDerivedFrom(const CXXRecordDecl *Derived,
+                               const CXXRecordDecl *Base) const {
+  if (DerivedToBaseInfo *Info = getDerivedToBaseInfo(Derived, Base))
+    return Info->IsDerived;
+
+  CXXBasePaths Paths(/*FindAmbiguities=*/false, /*RecordPaths=*/false,
+                     /*DetectVirtual=*/false);
+  return Derived->isDerivedFrom(Base, Paths);
+}
+
+const CXXBasePaths *
+ASTContext::getDerivedToBasePaths(const CXXRecordDecl *Derived,
+                                  const CXXRecordDecl *Base) const {
+  DerivedToBaseInfo *Info = getDerivedToBaseInfo(Derived, Base);
+  if (!Info || !Info->IsDerived)
+    return 0;
+
+  if (!Info->Paths) {
+    CXXBasePaths *Paths = new CXXBasePaths(/*FindAmbiguities=*/true,
+                                           /*RecordPaths=*/true,
+                                           /*DetectVirtual=*/false);
+    Derived->getDefinition()->isDerivedFrom(Base, *Paths);
+    Info->Paths = Paths;
+  }
+  return Info->Paths;
+}
@@ -89,6 +89,12 @@ const char *DeclContext::getDeclKindName() const {
 bool Decl::StatisticsEnabled = false;
 void Decl::EnableStatistics() {
   StatisticsEnabled = true;
+  CountingEnabled = true;
+}
+
+bool Decl::CountingEnabled = false;
+void Decl::EnableCounting() {
+  CountingEnabled = true;
 }
 
 void Decl::PrintStats() {
@@ -115,7 +121,16 @@ void Decl::PrintStats() {
   llvm::errs() << "Total bytes = " << totalBytes << "\n";
 }
 
+static unsigned NumDeclsCreated = 0;
+
+unsigned Decl::getNumCreated() {
+  return NumDeclsCreated;
+}
+
 void Decl::add(Kind k) {
+  ++NumDeclsCreated;
+  if (!StatisticsEnabled)
+    return;
   switch (k) {
 #define DECL(DERIVED, BASE) case DERIVED: ++n##DERIVED##s; break;
 #define ABSTRACT_DECL(DECL)
@@ -950,7 +965,7 @@ ExternalASTSource::SetNoExternalVisibleDeclsForName(const DeclContext *DC,
   if (!(Map = DC->LookupPtr.getPointer()))
     Map = DC->CreateStoredDeclsMap(Context);
 
-  StoredDeclsList &List = (*Map)[Name];
+  StoredDeclsList &List = Map->getOrCreate(Name);
   assert(List.isNull());
   (void) List;
 
@@ -967,7 +982,7 @@ ExternalASTSource::SetExternalVisibleDeclsForName(const DeclContext *DC,
   if (!(Map = DC->LookupPtr.getPointer()))
     Map = DC->CreateStoredDeclsMap(Context);
 
-  StoredDeclsList &List = (*Map)[Name];
+  StoredDeclsList &List = Map->getOrCreate(Name);
   for (ArrayRef<NamedDecl*>::iterator
          I = Decls.begin(), E = Decls.end(); I != E; ++I) {
     if (List.isNull())
@@ -1035,7 +1050,7 @@ void DeclContext::removeDecl(Decl *D) {
 
     StoredDeclsMap::iterator Pos = Map->find(ND->getDeclName());
     assert(Pos != Map->end() && "no lookup entry for decl");
-    if (Pos->second.getAsVector() || Pos->second.getAsDecl() == ND)
+    if (Pos->second.getAsVector() || Pos->second.isStoredInline(ND))
       Pos->second.remove(ND);
   }
 }
@@ -1119,6 +1134,21 @@ StoredDeclsMap *DeclContext::buildLookup() {
 
   llvm::SmallVector<DeclContext *, 2> Contexts;
   collectAllContexts(Contexts);
+
+  // Size the table for all of the declarations up front, so that building
+  // the lookup table of a very large context does not rehash it over and
+  // over again.
+  unsigned NumDecls = 0;
+  for (unsigned I = 0, N = Contexts.size(); I != N; ++I)
+    NumDecls += countLookupDecls(Contexts[I]);
+  if (NumDecls) {
+    StoredDeclsMap *Map = LookupPtr.getPointer();
+    if (!Map)
+      Map = CreateStoredDeclsMap(getParentASTContext());
+    // Keep the table below its maximum load factor of 3/4.
+    Map->resize((Map->size() + NumDecls) * 4 / 3 + 1);
+  }
+
   for (unsigned I = 0, N = Contexts.size(); I != N; ++I)
     buildLookupImpl(Contexts[I]);
 
@@ -1127,6 +1157,22 @@ StoredDeclsMap *DeclContext::buildLookup() {
   return LookupPtr.getPointer();
 }
 
+/// countLookupDecls - Count the declarations that buildLookupImpl would add
+/// to the lookup data structure for DCtx.  This is an upper bound on the
+/// number of new entries, since several declarations can share a name.
+unsigned DeclContext::countLookupDecls(DeclContext *DCtx) {
+  unsigned Count = 0;
+  for (decl_iterator I = DCtx->decls_begin(), E = DCtx->decls_end();
+       I != E; ++I) {
+    if (isa<NamedDecl>(*I))
+      ++Count;
+    if (DeclContext *InnerCtx = dyn_cast<DeclContext>(*I))
+      if (InnerCtx->isTransparentContext() || InnerCtx->isInlineNamespace())
+        Count += countLookupDecls(InnerCtx);
+  }
+  return Count;
+}
+
 /// buildLookupImpl - Build part of the lookup data structure for the
 /// declarations contained within DCtx, which will either be this
 /// DeclContext, a DeclContext linked to it, or a transparent context
@@ -1167,9 +1213,12 @@ DeclContext::lookup(DeclarationName Name) {
     // FIXME: For modules, we could have had more declarations added by module
     // imoprts since we saw the declaration of the local name.
     if (StoredDeclsMap *Map = LookupPtr.getPointer()) {
-      StoredDeclsMap::iterator I = Map->find(Name);
-      if (I != Map->end())
-        return I->second.getLookupResult();
+      if (Map->mayContain(Name)) {
+        StoredDeclsMap::iterator I = Map->find(Name);
+        if (I != Map->end())
+          return I->second.getLookupResult();
+      } else if (Decl::StatisticsEnabled)
+        getParentASTContext().noteFilteredDeclContextLookup();
     }
 
     ExternalASTSource *Source = getParentASTContext().getExternalSource();
@@ -1180,13 +1229,24 @@ DeclContext::lookup(DeclarationName Name) {
   if (LookupPtr.getInt())
     Map = buildLookup();
 
-  if (!Map)
+  // Consult the name filter of large maps before probing them.
+  if (Map && !Map->mayContain(Name)) {
+    if (Decl::StatisticsEnabled) {
+      getParentASTContext().noteDeclContextLookup(this, /*Found=*/false);
+      getParentASTContext().noteFilteredDeclContextLookup();
+    }
     return lookup_result(lookup_iterator(0), lookup_iterator(0));
+  }
 
-  StoredDeclsMap::iterator I = Map->find(Name);
-  if (I == Map->end())
+  StoredDeclsMap::iterator I;
+  if (!Map || (I = Map->find(Name)) == Map->end()) {
+    if (Decl::StatisticsEnabled)
+      getParentASTContext().noteDeclContextLookup(this, /*Found=*/false);
     return lookup_result(lookup_iterator(0), lookup_iterator(0));
+  }
 
+  if (Decl::StatisticsEnabled)
+    getParentASTContext().noteDeclContextLookup(this, /*Found=*/true);
   return I->second.getLookupResult();
 }
 
@@ -1338,7 +1398,7 @@ void DeclContext::makeDeclVisibleInContextImpl(NamedDecl *D, bool Internal) {
         Source->FindExternalVisibleDeclsByName(this, D->getDeclName());
 
   // Insert this declaration into the map.
-  StoredDeclsList &DeclNameEntries = (*Map)[D->getDeclName()];
+  StoredDeclsList &DeclNameEntries = Map->getOrCreate(D->getDeclName());
   if (DeclNameEntries.isNull()) {
     DeclNameEntries.setOnlyValue(D);
     return;
@@ -1408,6 +1468,52 @@ void StoredDeclsMap::DestroyAll(StoredDeclsMap *Map, bool Dependent) {
   }
 }
 
+/// \brief The number of names a StoredDeclsMap must hold before lookups
+/// consult its name filter; smaller maps are cheap enough to probe.
+static const unsigned MinFilteredNames = 64;
+
+/// \brief The number of filter bits per name, which keeps the false
+/// positive rate of the filter around 1.5%.
+static const unsigned FilterBitsPerName = 16;
+
+/// \brief The largest filter, in 64-bit words.
+static const unsigned MaxFilterWords = 1 << 18;
+
+void StoredDeclsMap::addToFilter(DeclarationName Name) {
+  if (size() < MinFilteredNames)
+    return;
+
+  if (Filter.empty() || NumFilteredNames + 1 != size() ||
+      (size() * FilterBitsPerName > Filter.size() * 64 &&
+       Filter.size() < MaxFilterWords)) {
+    rebuildFilter();
+    return;
+  }
+
+  unsigned Bit1, Bit2;
+  getFilterBits(Name, Bit1, Bit2);
+  Filter[Bit1 / 64] |= uint64_t(1) << (Bit1 % 64);
+  Filter[Bit2 / 64] |= uint64_t(1) << (Bit2 % 64);
+  ++NumFilteredNames;
+}
+
+void StoredDeclsMap::rebuildFilter() {
+  // Leave room for the map to double before the filter is rebuilt again.
+  unsigned NumWords = 1;
+  while (NumWords * 64 < 2 * size() * FilterBitsPerName &&
+         NumWords < MaxFilterWords)
+    NumWords *= 2;
+
+  Filter.assign(NumWords, 0);
+  for (iterator I = begin(), E = end(); I != E; ++I) {
+    unsigned Bit1, Bit2;
+    getFilterBits(I->first, Bit1, Bit2);
+    Filter[Bit1 / 64] |= uint64_t(1) << (Bit1 % 64);
+    Filter[Bit2 / 64] |= uint64_t(1) << (Bit2 % 64);
+  }
+  NumFilteredNames = size();
+}
+
 DependentDiagnostic *DependentDiagnostic::Create(ASTContext &C,
                                                  DeclContext *Parent,
                                            const PartialDiagnostic &PDiag) {
@@ -165,9 +165,27 @@ RedeclarableTemplateDecl::findSpecializationImpl(
                                  llvm::FoldingSetVector<EntryType> &Specs,
                                  const TemplateArgument *Args, unsigned NumArgs,
                                  void *&InsertPos) {
+  // Argument lists are uniqued when a specialization is added, so if these
+  // arguments were never uniqued there is no specialization to find, and
+  // there is no need to intern them just to look them up.
+  const UniquedTemplateArgumentList *List
+    = getASTContext().findUniquedTemplateArgumentList(Args, NumArgs);
+  if (!List) {
+    InsertPos = 0;
+    return 0;
+  }
+  return findSpecializationImpl(Specs, List, InsertPos);
+}
+
+template <class EntryType>
+typename RedeclarableTemplateDecl::SpecEntryTraits<EntryType>::DeclType*
+RedeclarableTemplateDecl::findSpecializationImpl(
+                                 llvm::FoldingSetVector<EntryType> &Specs,
+                                 const UniquedTemplateArgumentList *Args,
+                                 void *&InsertPos) {
   typedef SpecEntryTraits<EntryType> SETraits;
   llvm::FoldingSetNodeID ID;
-  EntryType::Profile(ID,Args,NumArgs, getASTContext());
+  ID.AddPointer(Args);
   EntryType *Entry = Specs.FindNodeOrInsertPos(ID, InsertPos);
   return Entry ? SETraits::getMostRecentDecl(Entry) : 0;
 }
@@ -259,6 +277,7 @@ void FunctionTemplateDecl::addSpecialization(
     getSpecializations().InsertNode(Info, InsertPos);
   else
     getSpecializations().GetOrInsertNode(Info);
+  getASTContext().noteTemplateSpecialization();
   if (ASTMutationListener *L = getASTMutationListener())
     L->AddedCXXTemplateSpecialization(this, Info->Function);
 }
@@ -340,6 +359,12 @@ ClassTemplateDecl::findSpecialization(const TemplateArgument *Args,
   return findSpecializationImpl(getSpecializations(), Args, NumArgs, InsertPos);
 }
 
+ClassTemplateSpecializationDecl *
+ClassTemplateDecl::findSpecialization(const UniquedTemplateArgumentList *Args,
+                                      void *&InsertPos) {
+  return findSpecializationImpl(getSpecializations(), Args, InsertPos);
+}
+
 void ClassTemplateDecl::AddSpecialization(ClassTemplateSpecializationDecl *D,
                                           void *InsertPos) {
   if (InsertPos)
@@ -350,6 +375,7 @@ void ClassTemplateDecl::AddSpecialization(ClassTemplateSpecializationDecl *D,
     (void)Existing;
     assert(Existing->isCanonicalDecl() && "Non-canonical specialization?");
   }
+  getASTContext().noteTemplateSpecialization();
   if (ASTMutationListener *L = getASTMutationListener())
     L->AddedCXXTemplateSpecialization(this, D);
 }
@@ -362,6 +388,13 @@ ClassTemplateDecl::findPartialSpecialization(const TemplateArgument *Args,
                                 InsertPos);
 }
 
+ClassTemplatePartialSpecializationDecl *
+ClassTemplateDecl::findPartialSpecialization(
+                                       const UniquedTemplateArgumentList *Args,
+                                       void *&InsertPos) {
+  return findSpecializationImpl(getPartialSpecializations(), Args, InsertPos);
+}
+
 void ClassTemplateDecl::AddPartialSpecialization(
                                       ClassTemplatePartialSpecializationDecl *D,
                                       void *InsertPos) {
@@ -373,6 +406,7 @@ void ClassTemplateDecl::AddPartialSpecialization(
     (void)Existing;
     assert(Existing->isCanonicalDecl() && "Non-canonical specialization?");
   }
+  getASTContext().noteTemplateSpecialization();
 
   if (ASTMutationListener *L = getASTMutationListener())
     L->AddedCXXTemplateSpecialization(this, D);
@@ -680,6 +714,23 @@ FunctionTemplateSpecializationInfo::Create(ASTContext &C, FunctionDecl *FD,
                                                     POI);
 }
 
+void FunctionTemplateSpecializationInfo::Profile(llvm::FoldingSetNodeID &ID) {
+  if (!UniquedTemplateArgs)
+    UniquedTemplateArgs = Function->getASTContext()
+      .getUniquedTemplateArgumentList(TemplateArguments->data(),
+                                      TemplateArguments->size());
+  ID.AddPointer(UniquedTemplateArgs);
+}
+
+void
+FunctionTemplateSpecializationInfo::Profile(llvm::FoldingSetNodeID &ID,
+                                          const TemplateArgument *TemplateArgs,
+                                            unsigned NumTemplateArgs,
+                                            ASTContext &Context) {
+  ID.AddPointer(Context.getUniquedTemplateArgumentList(TemplateArgs,
+                                                       NumTemplateArgs));
+}
+
 //===----------------------------------------------------------------------===//
 // TemplateDecl Implementation
 //===----------------------------------------------------------------------===//
@@ -703,15 +754,37 @@ ClassTemplateSpecializationDecl(ASTContext &Context, Kind DK, TagKind TK,
     SpecializedTemplate(SpecializedTemplate),
     ExplicitInfo(0),
     TemplateArgs(TemplateArgumentList::CreateCopy(Context, Args, NumArgs)),
-    SpecializationKind(TSK_Undeclared) {
+    UniquedTemplateArgs(0), SpecializationKind(TSK_Undeclared) {
 }
 
 ClassTemplateSpecializationDecl::ClassTemplateSpecializationDecl(Kind DK)
   : CXXRecordDecl(DK, TTK_Struct, 0, SourceLocation(), SourceLocation(), 0, 0),
-    ExplicitInfo(0),
+    ExplicitInfo(0), UniquedTemplateArgs(0),
     SpecializationKind(TSK_Undeclared) {
 }
 
+const UniquedTemplateArgumentList *
+ClassTemplateSpecializationDecl::getUniquedTemplateArgs() const {
+  if (!UniquedTemplateArgs)
+    UniquedTemplateArgs = getASTContext().getUniquedTemplateArgumentList(
+                                  TemplateArgs->data(), TemplateArgs->size());
+  return UniquedTemplateArgs;
+}
+
+void
+ClassTemplateSpecializationDecl::Profile(llvm::FoldingSetNodeID &ID) const {
+  ID.AddPointer(getUniquedTemplateArgs());
+}
+
+void
+ClassTemplateSpecializationDecl::Profile(llvm::FoldingSetNodeID &ID,
+                                         const TemplateArgument *TemplateArgs,
+                                         unsigned NumTemplateArgs,
+                                         ASTContext &Context) {
+  ID.AddPointer(Context.getUniquedTemplateArgumentList(TemplateArgs,
+                                                       NumTemplateArgs));
+}
+
 ClassTemplateSpecializationDecl *
 ClassTemplateSpecializationDecl::Create(ASTContext &Context, TagKind TK,
                                         DeclContext *DC,
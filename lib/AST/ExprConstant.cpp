@@ -36,6 +36,7 @@
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/CharUnits.h"
+#include "clang/AST/ConstexprCallCache.h"
 #include "clang/AST/RecordLayout.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/AST/TypeLoc.h"
@@ -44,6 +45,7 @@
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/raw_ostream.h"
 #include <cstring>
 #include <functional>
 
@@ -360,6 +362,10 @@ namespace {
     /// CallStackDepth - The number of calls in the call stack right now.
     unsigned CallStackDepth;
 
+    /// MaxCallStackDepth - The deepest the call stack has been, including
+    /// the calls whose results were reused from the memo table.
+    unsigned MaxCallStackDepth;
+
     /// NextCallIndex - The next call index to assign.
     unsigned NextCallIndex;
 
@@ -386,7 +392,7 @@ namespace {
 
     EvalInfo(const ASTContext &C, Expr::EvalStatus &S)
       : Ctx(const_cast<ASTContext&>(C)), EvalStatus(S), CurrentCall(0),
-        CallStackDepth(0), NextCallIndex(1),
+        CallStackDepth(0), MaxCallStackDepth(0), NextCallIndex(1),
         BottomFrame(*this, SourceLocation(), 0, 0, 0),
         EvaluatingDecl(0), EvaluatingDeclValue(0), HasActiveDiagnostic(false),
         CheckingPotentialConstantExpression(false) {}
@@ -577,6 +583,8 @@ CallStackFrame::CallStackFrame(EvalInfo &Info, SourceLocation CallLoc,
       Index(Info.NextCallIndex++), This(This), Arguments(Arguments) {
   Info.CurrentCall = this;
   ++Info.CallStackDepth;
+  Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth,
+                                    Info.CallStackDepth);
 }
 
 CallStackFrame::~CallStackFrame() {
@@ -2143,6 +2151,78 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
+template<typename T>
+static void appendToCallKey(SmallVectorImpl<char> &Key, const T &Value) {
+  const char *Bytes = reinterpret_cast<const char*>(&Value);
+  Key.append(Bytes, Bytes + sizeof(T));
+}
+
+static void appendAPIntToCallKey(SmallVectorImpl<char> &Key,
+                                 const llvm::APInt &I) {
+  appendToCallKey(Key, I.getBitWidth());
+  const char *Words = reinterpret_cast<const char*>(I.getRawData());
+  Key.append(Words, Words + I.getNumWords() * sizeof(uint64_t));
+}
+
+/// Append an encoding of the given value to the memoization key of a
+/// constexpr call. Values which refer to an object (or a label) may refer to
+/// an object local to an evaluation, so they cannot be memoized; return false
+/// if the value contains one, or contains an uninitialized component.
+static bool appendValueToCallKey(SmallVectorImpl<char> &Key,
+                                 const APValue &V) {
+  appendToCallKey(Key, static_cast<unsigned char>(V.getKind()));
+  switch (V.getKind()) {
+  case APValue::Uninitialized:
+  case APValue::LValue:
+  case APValue::MemberPointer:
+  case APValue::AddrLabelDiff:
+    return false;
+  case APValue::Int:
+    appendToCallKey(Key, V.getInt().isUnsigned());
+    appendAPIntToCallKey(Key, V.getInt());
+    return true;
+  case APValue::Float:
+    appendAPIntToCallKey(Key, V.getFloat().bitcastToAPInt());
+    return true;
+  case APValue::ComplexInt:
+    appendAPIntToCallKey(Key, V.getComplexIntReal());
+    appendAPIntToCallKey(Key, V.getComplexIntImag());
+    return true;
+  case APValue::ComplexFloat:
+    appendAPIntToCallKey(Key, V.getComplexFloatReal().bitcastToAPInt());
+    appendAPIntToCallKey(Key, V.getComplexFloatImag().bitcastToAPInt());
+    return true;
+  case APValue::Vector:
+    appendToCallKey(Key, V.getVectorLength());
+    for (unsigned I = 0, N = V.getVectorLength(); I != N; ++I)
+      if (!appendValueToCallKey(Key, V.getVectorElt(I)))
+        return false;
+    return true;
+  case APValue::Array:
+    appendToCallKey(Key, V.getArraySize());
+    appendToCallKey(Key, V.getArrayInitializedElts());
+    for (unsigned I = 0, N = V.getArrayInitializedElts(); I != N; ++I)
+      if (!appendValueToCallKey(Key, V.getArrayInitializedElt(I)))
+        return false;
+    return !V.hasArrayFiller() ||
+           appendValueToCallKey(Key, V.getArrayFiller());
+  case APValue::Struct:
+    appendToCallKey(Key, V.getStructNumBases());
+    appendToCallKey(Key, V.getStructNumFields());
+    for (unsigned I = 0, N = V.getStructNumBases(); I != N; ++I)
+      if (!appendValueToCallKey(Key, V.getStructBase(I)))
+        return false;
+    for (unsigned I = 0, N = V.getStructNumFields(); I != N; ++I)
+      if (!appendValueToCallKey(Key, V.getStructField(I)))
+        return false;
+    return true;
+  case APValue::Union:
+    appendToCallKey(Key, V.getUnionField());
+    return !V.getUnionField() || appendValueToCallKey(Key, V.getUnionValue());
+  }
+  llvm_unreachable("Unknown APValue kind");
+}
+
 /// Evaluate a function call.
 static bool HandleFunctionCall(SourceLocation CallLoc,
                                const FunctionDecl *Callee, const LValue *This,
@@ -2152,11 +2232,77 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   if (!EvaluateArgs(Args, ArgValues, Info))
     return false;
 
+  // A constexpr call to a non-member function whose arguments are plain
+  // values always produces the same result, so look it up in the memo table.
+  // Member calls are not memoized, since 'this' refers to an object.
+  ConstexprCallCache &Calls = Info.Ctx.getConstexprCallCache();
+  SmallString<64> Key;
+  bool Memoize = Info.getLangOpts().ConstexprCallMemoization &&
+                 !Info.CheckingPotentialConstantExpression;
+  if (Memoize) {
+    appendToCallKey(Key, Callee->getCanonicalDecl());
+    for (unsigned I = 0, N = ArgValues.size(); Memoize && I != N; ++I)
+      Memoize = appendValueToCallKey(Key, ArgValues[I]);
+    if (This || !Memoize) {
+      Memoize = false;
+      ++Calls.NumUncacheable;
+    } else if (const ConstexprCallCache::Entry *Entry = Calls.lookup(Key)) {
+      // A result that was only folded may not be reused when the caller
+      // needs to know whether this is a constant expression, and no result
+      // may be reused where evaluating the call would exceed the depth
+      // limit.
+      if ((Entry->IsConstantExpression || !Info.EvalStatus.Diag) &&
+          Info.CallStackDepth + Entry->Depth <=
+            Info.getLangOpts().ConstexprCallDepth + 1) {
+        ++Calls.NumHits;
+        Result = Entry->Result;
+        Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth,
+                                          Info.CallStackDepth + Entry->Depth);
+        return true;
+      }
+    }
+    if (Memoize)
+      ++Calls.NumMisses;
+  }
+
   if (!Info.CheckCallLimit(CallLoc))
     return false;
 
-  CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
-  return EvaluateStmt(Result, Info, Body) == ESR_Returned;
+  // Notes and side effects can't be replayed from the memo table, so only
+  // memoize calls which produce neither.
+  bool WasConstantExpression =
+    Info.EvalStatus.Diag && Info.EvalStatus.Diag->empty();
+  if (Info.EvalStatus.HasSideEffects)
+    Memoize = false;
+
+  ++Calls.NumCallsEvaluated;
+
+  // Measure how deep the call stack gets below this call.
+  unsigned DepthBefore = Info.CallStackDepth;
+  unsigned SavedMaxCallStackDepth = Info.MaxCallStackDepth;
+  Info.MaxCallStackDepth = DepthBefore;
+  bool Evaluated;
+  {
+    CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
+    Evaluated = EvaluateStmt(Result, Info, Body) == ESR_Returned;
+  }
+  unsigned Depth = Info.MaxCallStackDepth - DepthBefore;
+  Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth,
+                                    SavedMaxCallStackDepth);
+  if (!Evaluated)
+    return false;
+
+  if (Memoize) {
+    SmallString<64> ResultKey;
+    if (!Info.EvalStatus.HasSideEffects &&
+        appendValueToCallKey(ResultKey, Result))
+      Calls.insert(Key, Result,
+                   WasConstantExpression && Info.EvalStatus.Diag->empty(),
+                   Depth);
+    else
+      ++Calls.NumUncacheable;
+  }
+  return true;
 }
 
 /// Evaluate a constructor call.
@@ -2177,6 +2323,7 @@ static bool HandleConstructorCall(SourceLocation CallLoc, const LValue &This,
     return false;
   }
 
+  ++Info.Ctx.getConstexprCallCache().NumCallsEvaluated;
   CallStackFrame Frame(Info, CallLoc, Definition, &This, ArgValues.data());
 
   // If it's a delegating constructor, just delegate.
@@ -6896,3 +7043,15 @@ bool Expr::isPotentialConstantExpr(const FunctionDecl *FD,
 
   return Diags.empty();
 }
+
+void ConstexprCallCache::PrintStats() const {
+  llvm::errs() << "*** Constexpr Evaluation Stats:\n";
+  llvm::errs() << "  " << NumCallsEvaluated << " constexpr calls evaluated.\n";
+  unsigned Lookups = NumHits + NumMisses;
+  if (Lookups || NumUncacheable)
+    llvm::errs() << "  " << NumHits << "/" << Lookups
+                 << " memoizable calls reused ("
+                 << (Lookups ? NumHits * 100 / Lookups : 0) << "%), "
+                 << NumUncacheable << " not memoizable, " << size()
+                 << " memoized.\n";
+}
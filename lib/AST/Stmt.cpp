@@ -75,13 +75,27 @@ void Stmt::PrintStats() {
   llvm::errs() << "Total bytes = " << sum << "\n";
 }
 
+static unsigned NumStmtsCreated = 0;
+
+unsigned Stmt::getNumCreated() {
+  return NumStmtsCreated;
+}
+
 void Stmt::addStmtClass(StmtClass s) {
-  ++getStmtInfoTableEntry(s).Counter;
+  ++NumStmtsCreated;
+  if (StatisticsEnabled)
+    ++getStmtInfoTableEntry(s).Counter;
 }
 
 bool Stmt::StatisticsEnabled = false;
 void Stmt::EnableStatistics() {
   StatisticsEnabled = true;
+  CountingEnabled = true;
+}
+
+bool Stmt::CountingEnabled = false;
+void Stmt::EnableCounting() {
+  CountingEnabled = true;
 }
 
 Stmt *Stmt::IgnoreImplicit() {
@@ -375,7 +375,8 @@ SourceManager::SourceManager(DiagnosticsEngine &Diag, FileManager &FileMgr,
   : Diag(Diag), FileMgr(FileMgr), OverridenFilesKeepOriginalName(true),
     UserFilesAreVolatile(UserFilesAreVolatile),
     ExternalSLocEntries(0), LineTable(0), NumLinearScans(0),
-    NumBinaryProbes(0), FakeBufferForRecovery(0),
+    NumBinaryProbes(0), NumLocalExpansions(0), LocalExpansionAddrSpace(0),
+    NumLocalMacroArgExpansions(0), FakeBufferForRecovery(0),
     FakeContentCacheForRecovery(0) {
   clearIDTables();
   Diag.setSourceManager(this);
@@ -413,8 +414,10 @@ SourceManager::~SourceManager() {
 void SourceManager::clearIDTables() {
   MainFileID = FileID();
   LocalSLocEntryTable.clear();
+  LocalSLocEntryOffsets.clear();
   LoadedSLocEntryTable.clear();
   SLocEntryLoaded.clear();
+  NumCreatedFIDs.clear();
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = 0;
   LastFileIDLookup = FileID();
@@ -560,6 +563,7 @@ FileID SourceManager::createFileID(const ContentCache *File,
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset,
                                                FileInfo::get(IncludePos, File,
                                                              FileCharacter)));
+  LocalSLocEntryOffsets.push_back(NextLocalOffset);
   unsigned FileSize = File->getSize();
   assert(NextLocalOffset + FileSize + 1 > NextLocalOffset &&
          NextLocalOffset + FileSize + 1 <= CurrentLoadedOffset &&
@@ -610,11 +614,16 @@ SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
     return SourceLocation::getMacroLoc(LoadedOffset);
   }
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset, Info));
+  LocalSLocEntryOffsets.push_back(NextLocalOffset);
   assert(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
          NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset &&
          "Ran out of source locations!");
   // See createFileID for that +1.
   NextLocalOffset += TokLength + 1;
+  ++NumLocalExpansions;
+  LocalExpansionAddrSpace += TokLength + 1;
+  if (Info.isMacroArgExpansion())
+    ++NumLocalMacroArgExpansions;
   return SourceLocation::getMacroLoc(NextLocalOffset - (TokLength + 1));
 }
 
@@ -716,33 +725,33 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
   // completely random and may be a very long way away.
   //
   // To handle this, we do a linear search for up to 8 steps to catch #1 quickly
-  // then we fall back to a less cache efficient, but more scalable, binary
-  // search to find the location.
+  // then we fall back to a binary search over the dense offset array to find
+  // the location.
+  const unsigned *Offsets = &LocalSLocEntryOffsets[0];
 
   // See if this is near the file point - worst case we start scanning from the
   // most newly created FileID.
-  std::vector<SrcMgr::SLocEntry>::const_iterator I;
-
+  unsigned GreaterIndex;
   if (LastFileIDLookup.ID < 0 ||
-      LocalSLocEntryTable[LastFileIDLookup.ID].getOffset() < SLocOffset) {
+      Offsets[LastFileIDLookup.ID] < SLocOffset) {
     // Neither loc prunes our search.
-    I = LocalSLocEntryTable.end();
+    GreaterIndex = LocalSLocEntryOffsets.size();
   } else {
     // Perhaps it is near the file point.
-    I = LocalSLocEntryTable.begin()+LastFileIDLookup.ID;
+    GreaterIndex = LastFileIDLookup.ID;
   }
 
-  // Find the FileID that contains this.  "I" is an iterator that points to a
-  // FileID whose offset is known to be larger than SLocOffset.
+  // Find the FileID that contains this.  GreaterIndex is the index of a FileID
+  // whose offset is known to be larger than SLocOffset.
   unsigned NumProbes = 0;
   while (1) {
-    --I;
-    if (I->getOffset() <= SLocOffset) {
-      FileID Res = FileID::get(int(I - LocalSLocEntryTable.begin()));
+    --GreaterIndex;
+    if (Offsets[GreaterIndex] <= SLocOffset) {
+      FileID Res = FileID::get(GreaterIndex);
 
       // If this isn't an expansion, remember it.  We have good locality across
       // FileID lookups.
-      if (!I->isExpansion())
+      if (!LocalSLocEntryTable[GreaterIndex].isExpansion())
         LastFileIDLookup = Res;
       NumLinearScans += NumProbes+1;
       return Res;
@@ -751,47 +760,29 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
       break;
   }
 
-  // Convert "I" back into an index.  We know that it is an entry whose index is
-  // larger than the offset we are looking for.
-  unsigned GreaterIndex = I - LocalSLocEntryTable.begin();
-  // LessIndex - This is the lower bound of the range that we're searching.
-  // We know that the offset corresponding to the FileID is is less than
-  // SLocOffset.
-  unsigned LessIndex = 0;
+  // The offsets are strictly increasing and entry 0 is at offset 0, so the
+  // entry containing SLocOffset is the last one in [0, GreaterIndex) whose
+  // offset is not larger than it.  Find it without data-dependent branches,
+  // so that random lookups don't pay for mispredictions.
+  const unsigned *Base = Offsets;
+  unsigned Count = GreaterIndex;
   NumProbes = 0;
-  while (1) {
-    bool Invalid = false;
-    unsigned MiddleIndex = (GreaterIndex-LessIndex)/2+LessIndex;
-    unsigned MidOffset = getLocalSLocEntry(MiddleIndex, &Invalid).getOffset();
-    if (Invalid)
-      return FileID::get(0);
-    
+  while (Count > 1) {
+    unsigned Half = Count / 2;
+    Base = Base[Half] <= SLocOffset ? Base + Half : Base;
+    Count -= Half;
     ++NumProbes;
+  }
+  NumBinaryProbes += NumProbes;
 
-    // If the offset of the midpoint is too large, chop the high side of the
-    // range to the midpoint.
-    if (MidOffset > SLocOffset) {
-      GreaterIndex = MiddleIndex;
-      continue;
-    }
-
-    // If the middle index contains the value, succeed and return.
-    // FIXME: This could be made faster by using a function that's aware of
-    // being in the local area.
-    if (isOffsetInFileID(FileID::get(MiddleIndex), SLocOffset)) {
-      FileID Res = FileID::get(MiddleIndex);
-
-      // If this isn't a macro expansion, remember it.  We have good locality
-      // across FileID lookups.
-      if (!LocalSLocEntryTable[MiddleIndex].isExpansion())
-        LastFileIDLookup = Res;
-      NumBinaryProbes += NumProbes;
-      return Res;
-    }
+  unsigned Index = Base - Offsets;
+  FileID Res = FileID::get(Index);
 
-    // Otherwise, move the low-side up to the middle index.
-    LessIndex = MiddleIndex;
-  }
+  // If this isn't a macro expansion, remember it.  We have good locality
+  // across FileID lookups.
+  if (!LocalSLocEntryTable[Index].isExpansion())
+    LastFileIDLookup = Res;
+  return Res;
 }
 
 /// \brief Return the FileID for a SourceLocation with a high offset.
@@ -1089,64 +1080,50 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
   // Line #1 starts at char 0.
   LineOffsets.push_back(0);
 
-  const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
+  const unsigned char *Start = (const unsigned char *)Buffer->getBufferStart();
   const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
-  unsigned Offs = 0;
-  while (1) {
-    // Skip over the contents of the line.
-    const unsigned char *NextBuf = (const unsigned char *)Buf;
+
+  // Everything before NextLineStart has been accounted for.  A newline before
+  // it is the second half of a \r\n or \n\r pair.
+  const unsigned char *NextLineStart = Start;
+  const unsigned char *Buf = Start;
 
 #ifdef __SSE2__
-    // Try to skip to the next newline using SSE instructions. This is very
-    // performance sensitive for programs with lots of diagnostics and in -E
-    // mode.
-    __m128i CRs = _mm_set1_epi8('\r');
-    __m128i LFs = _mm_set1_epi8('\n');
-
-    // First fix up the alignment to 16 bytes.
-    while (((uintptr_t)NextBuf & 0xF) != 0) {
-      if (*NextBuf == '\n' || *NextBuf == '\r' || *NextBuf == '\0')
-        goto FoundSpecialChar;
-      ++NextBuf;
-    }
+  // Find the newlines 16 bytes at a time, walking the set bits of each
+  // chunk's mask rather than restarting the scan after every line.  This is
+  // very performance sensitive for programs with lots of diagnostics and in
+  // -E mode.
+  const __m128i CRs = _mm_set1_epi8('\r');
+  const __m128i LFs = _mm_set1_epi8('\n');
+  for (; Buf + 16 <= End; Buf += 16) {
+    const __m128i Chunk = _mm_loadu_si128((const __m128i*)Buf);
+    unsigned Mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
+                                                   _mm_cmpeq_epi8(Chunk, LFs)));
+    while (Mask != 0) {
+      const unsigned char *NL = Buf + llvm::CountTrailingZeros_32(Mask);
+      Mask &= Mask - 1;
+      if (NL < NextLineStart)
+        continue;
 
-    // Scan 16 byte chunks for '\r' and '\n'. Ignore '\0'.
-    while (NextBuf+16 <= End) {
-      const __m128i Chunk = *(const __m128i*)NextBuf;
-      __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
-                                 _mm_cmpeq_epi8(Chunk, LFs));
-      unsigned Mask = _mm_movemask_epi8(Cmp);
-
-      // If we found a newline, adjust the pointer and jump to the handling code.
-      if (Mask != 0) {
-        NextBuf += llvm::CountTrailingZeros_32(Mask);
-        goto FoundSpecialChar;
-      }
-      NextBuf += 16;
+      // If this is \n\r or \r\n, skip both characters.  The buffer is null
+      // terminated, so NL[1] is always readable.
+      NextLineStart = NL + 1;
+      if ((NL[1] == '\n' || NL[1] == '\r') && NL[0] != NL[1])
+        ++NextLineStart;
+      LineOffsets.push_back(NextLineStart - Start);
     }
+  }
 #endif
 
-    while (*NextBuf != '\n' && *NextBuf != '\r' && *NextBuf != '\0')
-      ++NextBuf;
+  // Handle whatever is left one character at a time.  Nulls are just skipped.
+  for (; Buf != End; ++Buf) {
+    if ((*Buf != '\n' && *Buf != '\r') || Buf < NextLineStart)
+      continue;
 
-#ifdef __SSE2__
-FoundSpecialChar:
-#endif
-    Offs += NextBuf-Buf;
-    Buf = NextBuf;
-
-    if (Buf[0] == '\n' || Buf[0] == '\r') {
-      // If this is \n\r or \r\n, skip both characters.
-      if ((Buf[1] == '\n' || Buf[1] == '\r') && Buf[0] != Buf[1])
-        ++Offs, ++Buf;
-      ++Offs, ++Buf;
-      LineOffsets.push_back(Offs);
-    } else {
-      // Otherwise, this is a null.  If end of file, exit.
-      if (Buf == End) break;
-      // Otherwise, skip the null.
-      ++Offs, ++Buf;
-    }
+    NextLineStart = Buf + 1;
+    if ((Buf[1] == '\n' || Buf[1] == '\r') && Buf[0] != Buf[1])
+      ++NextLineStart;
+    LineOffsets.push_back(NextLineStart - Start);
   }
 
   // Copy the offsets into the FileInfo structure.
@@ -1678,8 +1655,8 @@ void SourceManager::computeMacroArgsCache(MacroArgsMap *&CachePtr,
 
       // Skip the files/macros of the #include'd file, we only care about macros
       // that lexed macro arguments from our file.
-      if (Entry.getFile().NumCreatedFIDs)
-        ID += Entry.getFile().NumCreatedFIDs - 1/*because of next ++ID*/;
+      if (unsigned NumFIDs = getNumCreatedFIDsForFileID(FileID::get(ID)))
+        ID += NumFIDs - 1/*because of next ++ID*/;
       continue;
     }
 
@@ -1888,6 +1865,10 @@ void SourceManager::PrintStats() const {
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
                << NumBinaryProbes << " binary.\n";
+  llvm::errs() << NumLocalExpansions << " local macro expansion SLocEntry's ("
+               << NumLocalMacroArgExpansions << " for macro arguments), "
+               << LocalExpansionAddrSpace << "B of Sloc address space used, "
+               << sizeof(SrcMgr::SLocEntry) << " bytes each.\n";
 }
 
 ExternalSLocEntrySource::~ExternalSLocEntrySource() { }
@@ -1915,6 +1896,7 @@ SourceManager::MemoryBufferSizes SourceManager::getMemoryBufferSizes() const {
 size_t SourceManager::getDataStructureSizes() const {
   size_t size = llvm::capacity_in_bytes(MemBufferInfos)
     + llvm::capacity_in_bytes(LocalSLocEntryTable)
+    + llvm::capacity_in_bytes(LocalSLocEntryOffsets)
     + llvm::capacity_in_bytes(LoadedSLocEntryTable)
     + llvm::capacity_in_bytes(SLocEntryLoaded)
     + llvm::capacity_in_bytes(FileInfos);
@@ -0,0 +1,155 @@
+//===--- TimeTrace.cpp - Scoped frontend phase profiler -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the TimeTraceProfiler.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+using namespace clang;
+
+TimeTraceProfiler *TimeTraceProfiler::Instance = 0;
+
+uint64_t TimeTraceProfiler::getCurrentTime() {
+  llvm::sys::TimeValue Now = llvm::sys::TimeValue::now();
+  return uint64_t(Now.seconds()) * 1000000 + Now.microseconds();
+}
+
+TimeTraceProfiler::TimeTraceProfiler(unsigned Granularity)
+  : StartTime(getCurrentTime()), Granularity(Granularity) { }
+
+void TimeTraceProfiler::start(unsigned Granularity) {
+  assert(!Instance && "Time tracing already started");
+  Instance = new TimeTraceProfiler(Granularity);
+}
+
+void TimeTraceProfiler::stop() {
+  delete Instance;
+  Instance = 0;
+}
+
+void TimeTraceProfiler::begin(StringRef Name, StringRef Detail, Track T) {
+  std::vector<Event> &Stack = Stacks[T];
+  Stack.push_back(Event());
+  Event &E = Stack.back();
+  E.Name = Name;
+  E.Detail = Detail;
+  E.Duration = 0;
+  E.Start = getCurrentTime();
+}
+
+void TimeTraceProfiler::end(Track T) {
+  std::vector<Event> &Stack = Stacks[T];
+  assert(!Stack.empty() && "Time trace event ended without being begun");
+  Event &E = Stack.back();
+  E.Duration = getCurrentTime() - E.Start;
+
+  // Recursive events, like nested template instantiations, would otherwise
+  // be counted several times in the total for their name.
+  bool IsOutermost = true;
+  for (unsigned I = 0, N = Stack.size() - 1; I != N; ++I)
+    if (Stack[I].Name == E.Name) {
+      IsOutermost = false;
+      break;
+    }
+  if (IsOutermost) {
+    Total &T = Totals.GetOrCreateValue(E.Name).getValue();
+    ++T.Count;
+    T.Duration += E.Duration;
+  }
+
+  if (E.Duration >= Granularity) {
+    Events[T].push_back(Event());
+    std::swap(Events[T].back(), E);
+  }
+  Stack.pop_back();
+}
+
+void TimeTraceProfiler::setDetail(StringRef Detail, Track T) {
+  assert(!Stacks[T].empty() && "No time trace event to describe");
+  Stacks[T].back().Detail = Detail;
+}
+
+/// \brief Write \p Str as a quoted JSON string.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (StringRef::iterator I = Str.begin(), E = Str.end(); I != E; ++I) {
+    unsigned char C = *I;
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+static void writeEvent(raw_ostream &OS, StringRef Name, StringRef Detail,
+                       uint64_t Start, uint64_t Duration, unsigned Thread) {
+  OS << "{\"pid\":1,\"tid\":" << Thread << ",\"ph\":\"X\",\"ts\":" << Start
+     << ",\"dur\":" << Duration << ",\"name\":";
+  writeJSONString(OS, Name);
+  if (!Detail.empty()) {
+    OS << ",\"args\":{\"detail\":";
+    writeJSONString(OS, Detail);
+    OS << '}';
+  }
+  OS << '}';
+}
+
+void TimeTraceProfiler::write(raw_ostream &OS) {
+  uint64_t Now = getCurrentTime();
+
+  OS << "{\"traceEvents\":[\n";
+  for (unsigned T = 0; T != NumTracks; ++T) {
+    for (unsigned I = 0, N = Events[T].size(); I != N; ++I) {
+      const Event &E = Events[T][I];
+      writeEvent(OS, E.Name, E.Detail, E.Start - StartTime, E.Duration, T);
+      OS << ",\n";
+    }
+    for (unsigned I = 0, N = Stacks[T].size(); I != N; ++I) {
+      const Event &E = Stacks[T][I];
+      writeEvent(OS, E.Name, E.Detail, E.Start - StartTime, Now - E.Start, T);
+      OS << ",\n";
+    }
+  }
+
+  // Write the totals on their own track, longest first, so that they show up
+  // as a summary next to the timeline.
+  typedef std::pair<uint64_t, std::pair<StringRef, unsigned> > SortedTotal;
+  std::vector<SortedTotal> SortedTotals;
+  for (llvm::StringMap<Total>::const_iterator I = Totals.begin(),
+                                              E = Totals.end();
+       I != E; ++I)
+    SortedTotals.push_back(std::make_pair(I->getValue().Duration,
+                                          std::make_pair(I->getKey(),
+                                                         I->getValue().Count)));
+  std::sort(SortedTotals.begin(), SortedTotals.end(),
+            std::greater<SortedTotal>());
+  for (unsigned I = 0, N = SortedTotals.size(); I != N; ++I) {
+    const SortedTotal &T = SortedTotals[I];
+    writeEvent(OS, "Total " + T.second.first.str(),
+               (Twine(T.second.second) + " events").str(), 0, T.first,
+               NumTracks);
+    OS << ",\n";
+  }
+
+  OS << "{\"pid\":1,\"tid\":0,\"ph\":\"M\",\"name\":\"process_name\","
+     << "\"args\":{\"name\":\"clang\"}}\n"
+     << "]}\n";
+}
@@ -17,6 +17,7 @@
 #include "CGCXXABI.h"
 #include "CGDebugInfo.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
@@ -491,6 +492,10 @@ static void TryMarkNoThrow(llvm::Function *F) {
 void CodeGenFunction::GenerateCode(GlobalDecl GD, llvm::Function *Fn,
                                    const CGFunctionInfo &FnInfo) {
   const FunctionDecl *FD = cast<FunctionDecl>(GD.getDecl());
+
+  TimeTraceScope TimeScope("CodeGenFunction");
+  if (TimeScope.isActive())
+    TimeScope.setDetail(FD->getQualifiedNameAsString());
   
   // Check if we should generate debug info for this function.
   if (CGM.getModuleDebugInfo() && !FD->hasAttr<NoDebugAttr>())
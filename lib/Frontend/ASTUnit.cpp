@@ -27,6 +27,7 @@
 #include "clang/Serialization/ASTWriter.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Parse/ParseAST.h"
 #include "clang/Basic/TargetOptions.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/Diagnostic.h"
@@ -1525,6 +1526,8 @@ llvm::MemoryBuffer *ASTUnit::getMainBufferWithPrecompiledPreamble(
   FrontendOpts.ProgramAction = frontend::GeneratePCH;
   // FIXME: Generate the precompiled header into memory?
   FrontendOpts.OutputFile = PreamblePCHPath;
+  // Bodies skipped in the preamble can't be parsed once it is serialized.
+  FrontendOpts.RetainSkippedFunctionBodies = false;
   PreprocessorOpts.PrecompiledPreambleBytes.first = 0;
   PreprocessorOpts.PrecompiledPreambleBytes.second = false;
   
@@ -1926,6 +1929,7 @@ ASTUnit *ASTUnit::LoadFromCommandLine(const char **ArgBegin,
                                       bool IncludeBriefCommentsInCodeCompletion,
                                       bool AllowPCHWithCompilerErrors,
                                       bool SkipFunctionBodies,
+                                      bool RetainSkippedFunctionBodies,
                                       bool UserFilesAreVolatile,
                                       OwningPtr<ASTUnit> *ErrAST) {
   if (!Diags.getPtr()) {
@@ -1971,6 +1975,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(const char **ArgBegin,
   CI->getHeaderSearchOpts().ResourceDir = ResourceFilesPath;
 
   CI->getFrontendOpts().SkipFunctionBodies = SkipFunctionBodies;
+  CI->getFrontendOpts().RetainSkippedFunctionBodies
+    = RetainSkippedFunctionBodies;
 
   // Create the AST unit.
   OwningPtr<ASTUnit> AST;
@@ -2070,6 +2076,20 @@ bool ASTUnit::Reparse(RemappedFile *RemappedFiles, unsigned NumRemappedFiles) {
   return Result;
 }
 
+bool ASTUnit::parseSkippedFunctionBody(FunctionDecl *FD) {
+  if (!TheSema)
+    return false;
+
+  SimpleTimer ParsingTimer(WantTiming);
+  ParsingTimer.setOutput("Parsing skipped function body in " +
+                         getMainFileName());
+
+  // Diagnostics in the body are kept with those of the rest of the unit.
+  CaptureDroppedDiagnostics Capture(CaptureDiagnostics, getDiagnostics(),
+                                    StoredDiagnostics);
+  return ParseSkippedFunctionBody(*TheSema, FD);
+}
+
 //----------------------------------------------------------------------------//
 // Code completion
 //----------------------------------------------------------------------------//
@@ -2415,6 +2435,7 @@ void ASTUnit::CodeComplete(StringRef File, unsigned Line, unsigned Column,
   Clang->setCodeCompletionConsumer(AugmentedConsumer);
 
   Clang->getFrontendOpts().SkipFunctionBodies = true;
+  Clang->getFrontendOpts().RetainSkippedFunctionBodies = false;
 
   // If we have a precompiled preamble, try to use it. We only allow
   // the use of the precompiled preamble if we're if the completion
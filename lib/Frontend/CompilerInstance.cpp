@@ -9,6 +9,7 @@
 
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Sema/Sema.h"
+#include "clang/Sema/TemplateInstantiationProfile.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
@@ -16,8 +17,11 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
+#include "clang/Lex/DirectoryListingCache.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PTHManager.h"
 #include "clang/Frontend/ChainedDiagnosticConsumer.h"
@@ -245,6 +249,8 @@ void CompilerInstance::createPreprocessor() {
                                               getDiagnostics(),
                                               getLangOpts(),
                                               &getTarget());
+  if (getHeaderSearchOpts().UseSharedDirectoryListings)
+    HeaderInfo->setDirectoryListingCache(&DirectoryListingCache::getShared());
   PP = new Preprocessor(getDiagnostics(), getLangOpts(), &getTarget(),
                         getSourceManager(), *HeaderInfo, *this, PTHMgr,
                         /*OwnsHeaderSearch=*/true);
@@ -257,8 +263,26 @@ void CompilerInstance::createPreprocessor() {
     PP->setPTHManager(PTHMgr);
   }
 
+  for (unsigned I = 0, N = PPOpts.TokenCacheShards.size(); I != N; ++I)
+    if (PTHManager *Shard = PTHManager::Create(PPOpts.TokenCacheShards[I],
+                                               getDiagnostics()))
+      PP->addTokenCacheShard(Shard);
+
+  if (PPOpts.UseSharedIncludeGuardCache) {
+    IncludeGuardCache &GuardCache = IncludeGuardCache::getShared();
+    if (!PPOpts.IncludeGuardCacheFile.empty() &&
+        GuardCache.load(PPOpts.IncludeGuardCacheFile))
+      getDiagnostics().Report(diag::warn_fe_include_guard_cache_failure)
+        << 0 << PPOpts.IncludeGuardCacheFile;
+    PP->setIncludeGuardCache(&GuardCache);
+  }
+
+  if (PPOpts.MemoizeMacroArgExpansions)
+    PP->setMemoizeMacroArgExpansions(true);
+
   if (PPOpts.DetailedRecord)
-    PP->createPreprocessingRecord(PPOpts.DetailedRecordConditionalDirectives);
+    PP->createPreprocessingRecord(PPOpts.DetailedRecordConditionalDirectives,
+                                  PPOpts.DetailedRecordOnlyMainFileExpansions);
 
   InitializePreprocessor(*PP, PPOpts, getHeaderSearchOpts(), getFrontendOpts());
 
@@ -317,7 +341,8 @@ void CompilerInstance::createPCHExternalASTSource(StringRef Path,
                                           AllowPCHWithCompilerErrors,
                                           getPreprocessor(), getASTContext(),
                                           DeserializationListener,
-                                          Preamble));
+                                          Preamble,
+                     !getFrontendOpts().ASTDeserializationProfileFile.empty()));
   ModuleManager = static_cast<ASTReader*>(Source.get());
   getASTContext().setExternalSource(Source);
 }
@@ -331,12 +356,14 @@ CompilerInstance::createPCHExternalASTSource(StringRef Path,
                                              Preprocessor &PP,
                                              ASTContext &Context,
                                              void *DeserializationListener,
-                                             bool Preamble) {
+                                             bool Preamble,
+                                             bool ProfileDeserialization) {
   OwningPtr<ASTReader> Reader;
   Reader.reset(new ASTReader(PP, Context,
                              Sysroot.empty() ? "" : Sysroot.c_str(),
                              DisablePCHValidation, DisableStatCache,
                              AllowPCHWithCompilerErrors));
+  Reader->setProfileDeserialization(ProfileDeserialization);
 
   Reader->setDeserializationListener(
             static_cast<ASTDeserializationListener *>(DeserializationListener));
@@ -426,6 +453,9 @@ void CompilerInstance::createSema(TranslationUnitKind TUKind,
                                   CodeCompleteConsumer *CompletionConsumer) {
   TheSema.reset(new Sema(getPreprocessor(), getASTContext(), getASTConsumer(),
                          TUKind, CompletionConsumer));
+  if (getFrontendOpts().ShowTemplateProfile)
+    TheSema->TemplateProfile.reset(
+      new TemplateInstantiationProfile(getASTContext()));
 }
 
 // Output Files
@@ -663,17 +693,35 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
   if (getFrontendOpts().ShowStats)
     llvm::EnableStatistics();
 
+  // Modules built on the way are traced as part of the importing compilation.
+  const std::string &TimeTraceFile = getFrontendOpts().TimeTraceFile;
+  bool OwnsTimeTrace = !TimeTraceFile.empty() && !TimeTraceProfiler::get();
+  if (OwnsTimeTrace)
+    TimeTraceProfiler::start(getFrontendOpts().TimeTraceGranularity);
+
   for (unsigned i = 0, e = getFrontendOpts().Inputs.size(); i != e; ++i) {
     // Reset the ID tables if we are reusing the SourceManager.
     if (hasSourceManager())
       getSourceManager().clearIDTables();
 
+    TimeTraceScope TimeScope("Frontend", getFrontendOpts().Inputs[i].File);
     if (Act.BeginSourceFile(*this, getFrontendOpts().Inputs[i])) {
       Act.Execute();
       Act.EndSourceFile();
     }
   }
 
+  if (OwnsTimeTrace) {
+    std::string ErrorInfo;
+    llvm::raw_fd_ostream TraceOS(TimeTraceFile.c_str(), ErrorInfo);
+    if (ErrorInfo.empty())
+      TimeTraceProfiler::get()->write(TraceOS);
+    else
+      getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << TimeTraceFile << ErrorInfo;
+    TimeTraceProfiler::stop();
+  }
+
   // Notify the diagnostic client that all files were processed.
   getDiagnostics().getClient()->finish();
 
@@ -941,6 +989,8 @@ Module *CompilerInstance::loadModule(SourceLocation ImportLoc,
                                     Sysroot.empty() ? "" : Sysroot.c_str(),
                                     PPOpts.DisablePCHValidation,
                                     PPOpts.DisableStatCache);
+      ModuleManager->setProfileDeserialization(
+                   !getFrontendOpts().ASTDeserializationProfileFile.empty());
       if (hasASTConsumer()) {
         ModuleManager->setDeserializationListener(
           getASTConsumer().GetASTDeserializationListener());
@@ -455,6 +455,7 @@ static const char *getActionName(frontend::ActionKind Kind) {
   case frontend::InitOnly:               return "-init-only";
   case frontend::ParseSyntaxOnly:        return "-fsyntax-only";
   case frontend::PrintDeclContext:       return "-print-decl-contexts";
+  case frontend::PrintHeaderCosts:       return "-print-header-costs";
   case frontend::PrintPreamble:          return "-print-preamble";
   case frontend::PrintPreprocessedInput: return "-E";
   case frontend::RewriteMacros:          return "-rewrite-macros";
@@ -490,6 +491,8 @@ static void FrontendOptsToArgs(const FrontendOptions &Opts, ToArgsList &Res) {
     Res.push_back("-disable-free");
   if (Opts.RelocatablePCH)
     Res.push_back("-relocatable-pch");
+  if (Opts.CompressASTSourceBuffers)
+    Res.push_back("-compress-ast-source-buffers");
   if (Opts.ShowHelp)
     Res.push_back("-help");
   if (Opts.ShowStats)
@@ -561,6 +564,20 @@ static void FrontendOptsToArgs(const FrontendOptions &Opts, ToArgsList &Res) {
   }
   if (!Opts.ASTDumpFilter.empty())
     Res.push_back("-ast-dump-filter", Opts.ASTDumpFilter);
+  if (!Opts.ASTDeserializationProfileFile.empty())
+    Res.push_back("-ast-deserialization-profile",
+                  Opts.ASTDeserializationProfileFile);
+  if (!Opts.TimeTraceFile.empty()) {
+    Res.push_back("-ftime-trace=" + Opts.TimeTraceFile);
+    Res.push_back("-ftime-trace-granularity=" +
+                  llvm::utostr(Opts.TimeTraceGranularity));
+  }
+  if (Opts.ShowTemplateProfile) {
+    Res.push_back("-ftemplate-profile");
+    Res.push_back("-ftemplate-profile-sort=" + Opts.TemplateProfileSort);
+    Res.push_back("-ftemplate-profile-limit=" +
+                  llvm::utostr(Opts.TemplateProfileLimit));
+  }
   for (unsigned i = 0, e = Opts.Plugins.size(); i != e; ++i)
     Res.push_back("-load", Opts.Plugins[i]);
   for (unsigned i = 0, e = Opts.AddPluginActions.size(); i != e; ++i) {
@@ -667,6 +684,8 @@ static void HeaderSearchOptsToArgs(const HeaderSearchOptions &Opts,
     Res.push_back("-stdlib=libc++");
   if (Opts.Verbose)
     Res.push_back("-v");
+  if (Opts.UseSharedDirectoryListings)
+    Res.push_back("-fshared-directory-listings");
 }
 
 static void LangOptsToArgs(const LangOptions &Opts, ToArgsList &Res) {
@@ -841,6 +860,14 @@ static void LangOptsToArgs(const LangOptions &Opts, ToArgsList &Res) {
     Res.push_back("-ftemplate-depth", llvm::utostr(Opts.InstantiationDepth));
   if (Opts.ConstexprCallDepth != DefaultLangOpts.ConstexprCallDepth)
     Res.push_back("-fconstexpr-depth", llvm::utostr(Opts.ConstexprCallDepth));
+  if (Opts.ConstexprCallMemoization)
+    Res.push_back("-fconstexpr-memoize");
+  if (Opts.TypoCorrectionLimit != DefaultLangOpts.TypoCorrectionLimit)
+    Res.push_back("-ftypo-correction-limit",
+                  llvm::utostr(Opts.TypoCorrectionLimit));
+  if (Opts.TypoCorrectionTimeLimit)
+    Res.push_back("-ftypo-correction-time-limit",
+                  llvm::utostr(Opts.TypoCorrectionTimeLimit));
   if (!Opts.ObjCConstantStringClass.empty())
     Res.push_back("-fconstant-string-class", Opts.ObjCConstantStringClass);
   if (Opts.FakeAddressSpaceMap)
@@ -878,6 +905,8 @@ static void PreprocessorOptsToArgs(const PreprocessorOptions &Opts,
     Res.push_back("-undef");
   if (Opts.DetailedRecord)
     Res.push_back("-detailed-preprocessing-record");
+  if (Opts.DetailedRecordOnlyMainFileExpansions)
+    Res.push_back("-detailed-preprocessing-record-main-file-expansions");
   if (!Opts.ImplicitPCHInclude.empty())
     Res.push_back("-include-pch", Opts.ImplicitPCHInclude);
   if (!Opts.ImplicitPTHInclude.empty())
@@ -889,6 +918,14 @@ static void PreprocessorOptsToArgs(const PreprocessorOptions &Opts,
       assert(Opts.ImplicitPTHInclude == Opts.TokenCache &&
              "Unsupported option combination!");
   }
+  for (unsigned i = 0, e = Opts.TokenCacheShards.size(); i != e; ++i)
+    Res.push_back("-token-cache-shard", Opts.TokenCacheShards[i]);
+  if (Opts.UseSharedIncludeGuardCache)
+    Res.push_back("-fshared-include-guard-cache");
+  if (!Opts.IncludeGuardCacheFile.empty())
+    Res.push_back("-include-guard-cache", Opts.IncludeGuardCacheFile);
+  if (Opts.MemoizeMacroArgExpansions)
+    Res.push_back("-fmemoize-macro-expansions");
   for (unsigned i = 0, e = Opts.ChainedIncludes.size(); i != e; ++i)
     Res.push_back("-chain-include", Opts.ChainedIncludes[i]);
   for (unsigned i = 0, e = Opts.RemappedFiles.size(); i != e; ++i) {
@@ -1517,6 +1554,8 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Opts.ProgramAction = frontend::ParseSyntaxOnly; break;
     case OPT_print_decl_contexts:
       Opts.ProgramAction = frontend::PrintDeclContext; break;
+    case OPT_print_header_costs:
+      Opts.ProgramAction = frontend::PrintHeaderCosts; break;
     case OPT_print_preamble:
       Opts.ProgramAction = frontend::PrintPreamble; break;
     case OPT_E:
@@ -1570,6 +1609,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.OutputFile = Args.getLastArgValue(OPT_o);
   Opts.Plugins = Args.getAllArgValues(OPT_load);
   Opts.RelocatablePCH = Args.hasArg(OPT_relocatable_pch);
+  Opts.CompressASTSourceBuffers = Args.hasArg(OPT_compress_ast_source_buffers);
   Opts.ShowHelp = Args.hasArg(OPT_help);
   Opts.ShowStats = Args.hasArg(OPT_print_stats);
   Opts.ShowTimers = Args.hasArg(OPT_ftime_report);
@@ -1581,6 +1621,23 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.FixAndRecompile = Args.hasArg(OPT_fixit_recompile);
   Opts.FixToTemporaries = Args.hasArg(OPT_fixit_to_temp);
   Opts.ASTDumpFilter = Args.getLastArgValue(OPT_ast_dump_filter);
+  Opts.ASTDeserializationProfileFile
+    = Args.getLastArgValue(OPT_ast_deserialization_profile);
+  Opts.TimeTraceFile = Args.getLastArgValue(OPT_ftime_trace_EQ);
+  Opts.TimeTraceGranularity
+    = Args.getLastArgIntValue(OPT_ftime_trace_granularity_EQ, 500, Diags);
+  Opts.ShowTemplateProfile = Args.hasArg(OPT_ftemplate_profile);
+  if (Arg *A = Args.getLastArg(OPT_ftemplate_profile_sort_EQ)) {
+    StringRef Key = A->getValue(Args);
+    if (Key == "time" || Key == "inclusive" || Key == "count" ||
+        Key == "nodes")
+      Opts.TemplateProfileSort = Key;
+    else
+      Diags.Report(diag::err_drv_invalid_value)
+        << A->getAsString(Args) << Key;
+  }
+  Opts.TemplateProfileLimit
+    = Args.getLastArgIntValue(OPT_ftemplate_profile_limit_EQ, 20, Diags);
 
   Opts.CodeCompleteOpts.IncludeMacros
     = Args.hasArg(OPT_code_completion_macros);
@@ -1705,6 +1762,7 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args) {
   Opts.ResourceDir = Args.getLastArgValue(OPT_resource_dir);
   Opts.ModuleCachePath = Args.getLastArgValue(OPT_fmodule_cache_path);
   Opts.DisableModuleHash = Args.hasArg(OPT_fdisable_module_hash);
+  Opts.UseSharedDirectoryListings = Args.hasArg(OPT_fshared_directory_listings);
   
   // Add -I..., -F..., and -index-header-map options in order.
   bool IsIndexHeaderMap = false;
@@ -2096,6 +2154,11 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
                                                     Diags);
   Opts.ConstexprCallDepth = Args.getLastArgIntValue(OPT_fconstexpr_depth, 512,
                                                     Diags);
+  Opts.ConstexprCallMemoization = Args.hasArg(OPT_fconstexpr_memoize);
+  Opts.TypoCorrectionLimit = Args.getLastArgIntValue(OPT_ftypo_correction_limit,
+                                                     20, Diags);
+  Opts.TypoCorrectionTimeLimit =
+    Args.getLastArgIntValue(OPT_ftypo_correction_time_limit, 0, Diags);
   Opts.DelayedTemplateParsing = Args.hasArg(OPT_fdelayed_template_parsing);
   Opts.NumLargeByValueCopy = Args.getLastArgIntValue(OPT_Wlarge_by_value_copy_EQ,
                                                     0, Diags);
@@ -2176,8 +2239,16 @@ static void ParsePreprocessorArgs(PreprocessorOptions &Opts, ArgList &Args,
       Opts.TokenCache = A->getValue(Args);
   else
     Opts.TokenCache = Opts.ImplicitPTHInclude;
+  Opts.TokenCacheShards = Args.getAllArgValues(OPT_token_cache_shard);
+  Opts.IncludeGuardCacheFile = Args.getLastArgValue(OPT_include_guard_cache);
+  Opts.UseSharedIncludeGuardCache =
+    Args.hasArg(OPT_fshared_include_guard_cache) ||
+    !Opts.IncludeGuardCacheFile.empty();
+  Opts.MemoizeMacroArgExpansions = Args.hasArg(OPT_fmemoize_macro_expansions);
   Opts.UsePredefines = !Args.hasArg(OPT_undef);
   Opts.DetailedRecord = Args.hasArg(OPT_detailed_preprocessing_record);
+  Opts.DetailedRecordOnlyMainFileExpansions
+    = Args.hasArg(OPT_detailed_preprocessing_record_main_file_expansions);
   Opts.DisablePCHValidation = Args.hasArg(OPT_fno_validate_pch);
 
   Opts.DumpDeserializedPCHDecls = Args.hasArg(OPT_dump_deserialized_pch_decls);
@@ -2440,6 +2511,7 @@ std::string CompilerInvocation::getModuleHash() const {
   // Extend the signature with preprocessor options.
   Signature.add(getPreprocessorOpts().UsePredefines, 1);
   Signature.add(getPreprocessorOpts().DetailedRecord, 1);
+  Signature.add(getPreprocessorOpts().DetailedRecordOnlyMainFileExpansions, 1);
   
   // Hash the preprocessor defines.
   // FIXME: This is terrible. Use an MD5 sum of the preprocessor defines.
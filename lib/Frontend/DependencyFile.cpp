@@ -40,6 +40,7 @@ class DependencyFileCallback : public PPCallbacks {
 private:
   bool FileMatchesDepCriteria(const char *Filename,
                               SrcMgr::CharacteristicKind FileType);
+  void AddFileEntry(const FileEntry *FE, SrcMgr::CharacteristicKind FileType);
   void AddFilename(StringRef Filename);
   void OutputDependencyFile();
 
@@ -55,6 +56,9 @@ public:
   virtual void FileChanged(SourceLocation Loc, FileChangeReason Reason,
                            SrcMgr::CharacteristicKind FileType,
                            FileID PrevFID);
+  virtual void FileSkipped(const FileEntry &SkippedFile,
+                           const Token &FilenameTok,
+                           SrcMgr::CharacteristicKind FileType);
   virtual void InclusionDirective(SourceLocation HashLoc,
                                   const Token &IncludeTok,
                                   StringRef FileName,
@@ -114,6 +118,20 @@ void DependencyFileCallback::FileChanged(SourceLocation Loc,
     SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)));
   if (FE == 0) return;
 
+  AddFileEntry(FE, FileType);
+}
+
+/// FileSkipped - A header that was not entered is still a dependency: its
+/// include guard may have been learned from another translation unit, in
+/// which case it was never entered in this one.
+void DependencyFileCallback::FileSkipped(const FileEntry &SkippedFile,
+                                         const Token &FilenameTok,
+                                         SrcMgr::CharacteristicKind FileType) {
+  AddFileEntry(&SkippedFile, FileType);
+}
+
+void DependencyFileCallback::AddFileEntry(const FileEntry *FE,
+                                          SrcMgr::CharacteristicKind FileType) {
   StringRef Filename = FE->getName();
   if (!FileMatchesDepCriteria(Filename.data(), FileType))
     return;
@@ -12,6 +12,7 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/ChainedIncludesSource.h"
@@ -22,7 +23,10 @@
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Parse/ParseAST.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
+#include "clang/Sema/Sema.h"
+#include "clang/Sema/TemplateInstantiationProfile.h"
 #include "clang/Serialization/ASTReader.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -350,6 +354,30 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  // Write out the deserialization profile while the AST reader is still
+  // alive.
+  const std::string &ProfileFile
+    = CI.getFrontendOpts().ASTDeserializationProfileFile;
+  if (!ProfileFile.empty() && CI.getModuleManager()) {
+    std::string ErrorInfo;
+    llvm::raw_fd_ostream OS(ProfileFile.c_str(), ErrorInfo);
+    if (ErrorInfo.empty())
+      CI.getModuleManager()->PrintDeserializationProfile(OS);
+    else
+      CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << ProfileFile << ErrorInfo;
+  }
+
+  // Save the include guards found in this translation unit, so that later
+  // compilations can use them.
+  const std::string &GuardCacheFile
+    = CI.getPreprocessorOpts().IncludeGuardCacheFile;
+  if (!GuardCacheFile.empty() && CI.hasPreprocessor() &&
+      CI.getPreprocessor().getIncludeGuardCache() &&
+      CI.getPreprocessor().getIncludeGuardCache()->save(GuardCacheFile))
+    CI.getDiagnostics().Report(diag::warn_fe_include_guard_cache_failure)
+      << 1 << GuardCacheFile;
+
   // Release the consumer and the AST, in that order since the consumer may
   // perform actions in its destructor which require the context.
   //
@@ -419,7 +447,21 @@ void ASTFrontendAction::ExecuteAction() {
     CI.createSema(getTranslationUnitKind(), CompletionConsumer);
 
   ParseAST(CI.getSema(), CI.getFrontendOpts().ShowStats,
-           CI.getFrontendOpts().SkipFunctionBodies);
+           CI.getFrontendOpts().SkipFunctionBodies,
+           CI.getFrontendOpts().RetainSkippedFunctionBodies);
+
+  if (TemplateInstantiationProfile *Profile
+        = CI.getSema().TemplateProfile.get()) {
+    const FrontendOptions &Opts = CI.getFrontendOpts();
+    TemplateInstantiationProfile::SortKey Key
+      = llvm::StringSwitch<TemplateInstantiationProfile::SortKey>(
+          Opts.TemplateProfileSort)
+        .Case("inclusive", TemplateInstantiationProfile::SK_InclusiveTime)
+        .Case("count", TemplateInstantiationProfile::SK_Count)
+        .Case("nodes", TemplateInstantiationProfile::SK_Nodes)
+        .Default(TemplateInstantiationProfile::SK_ExclusiveTime);
+    Profile->print(llvm::errs(), Key, Opts.TemplateProfileLimit);
+  }
 }
 
 void PluginASTAction::anchor() { }
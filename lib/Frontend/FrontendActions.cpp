@@ -18,6 +18,7 @@
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/HeaderCostReport.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Serialization/ASTWriter.h"
 #include "llvm/ADT/OwningPtr.h"
@@ -92,7 +93,12 @@ ASTConsumer *GeneratePCHAction::CreateASTConsumer(CompilerInstance &CI,
 
   if (!CI.getFrontendOpts().RelocatablePCH)
     Sysroot.clear();
-  return new PCHGenerator(CI.getPreprocessor(), OutputFile, 0, Sysroot, OS);
+  PCHGenerator *Generator
+    = new PCHGenerator(CI.getPreprocessor(), OutputFile, 0, Sysroot, OS);
+  Generator->setCompressSourceBuffers(
+                               CI.getFrontendOpts().CompressASTSourceBuffers);
+  Generator->setShowStats(CI.getFrontendOpts().ShowStats);
+  return Generator;
 }
 
 bool GeneratePCHAction::ComputeASTConsumerArguments(CompilerInstance &CI,
@@ -127,8 +133,12 @@ ASTConsumer *GenerateModuleAction::CreateASTConsumer(CompilerInstance &CI,
   if (ComputeASTConsumerArguments(CI, InFile, Sysroot, OutputFile, OS))
     return 0;
   
-  return new PCHGenerator(CI.getPreprocessor(), OutputFile, Module, 
-                          Sysroot, OS);
+  PCHGenerator *Generator
+    = new PCHGenerator(CI.getPreprocessor(), OutputFile, Module, Sysroot, OS);
+  Generator->setCompressSourceBuffers(
+                               CI.getFrontendOpts().CompressASTSourceBuffers);
+  Generator->setShowStats(CI.getFrontendOpts().ShowStats);
+  return Generator;
 }
 
 /// \brief Collect the set of header includes needed to construct the given 
@@ -359,6 +369,11 @@ ASTConsumer *SyntaxOnlyAction::CreateASTConsumer(CompilerInstance &CI,
   return new ASTConsumer();
 }
 
+ASTConsumer *HeaderCostReportAction::CreateASTConsumer(CompilerInstance &CI,
+                                                       StringRef InFile) {
+  return CreateHeaderCostConsumer(CI, Aggregate);
+}
+
 //===----------------------------------------------------------------------===//
 // Preprocessor Actions
 //===----------------------------------------------------------------------===//
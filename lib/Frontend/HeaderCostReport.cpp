@@ -0,0 +1,343 @@
+//===--- HeaderCostReport.cpp - Per-header compile cost report ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file attributes the cost of compiling a translation unit to the
+// headers it includes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/HeaderCostReport.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclGroup.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Sema/Sema.h"
+#include "clang/Sema/SemaConsumer.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+using namespace clang;
+
+void HeaderCost::add(const HeaderCost &Other) {
+  NumTranslationUnits += Other.NumTranslationUnits;
+  NumIncludes += Other.NumIncludes;
+  NumEntered += Other.NumEntered;
+  BytesLexed += Other.BytesLexed;
+  RawTokens += Other.RawTokens;
+  InclusiveTime += Other.InclusiveTime;
+  ExclusiveTime += Other.ExclusiveTime;
+  NumDecls += Other.NumDecls;
+  ParseTime += Other.ParseTime;
+  InstantiationTime += Other.InstantiationTime;
+}
+
+void HeaderCostReport::merge(const HeaderCostReport &Other) {
+  for (llvm::StringMap<HeaderCost>::const_iterator I = Other.Headers.begin(),
+                                                   E = Other.Headers.end();
+       I != E; ++I)
+    Headers[I->getKey()].add(I->getValue());
+  NumTranslationUnits += Other.NumTranslationUnits;
+}
+
+namespace {
+  typedef std::pair<StringRef, const HeaderCost *> HeaderAndCost;
+
+  struct MoreInclusiveTime {
+    bool operator()(const HeaderAndCost &LHS, const HeaderAndCost &RHS) const {
+      if (LHS.second->InclusiveTime != RHS.second->InclusiveTime)
+        return LHS.second->InclusiveTime > RHS.second->InclusiveTime;
+      return LHS.first < RHS.first;
+    }
+  };
+}
+
+void HeaderCostReport::print(raw_ostream &OS, unsigned MaxHeaders) const {
+  std::vector<HeaderAndCost> Sorted;
+  Sorted.reserve(Headers.size());
+  for (llvm::StringMap<HeaderCost>::const_iterator I = Headers.begin(),
+                                                   E = Headers.end();
+       I != E; ++I)
+    Sorted.push_back(HeaderAndCost(I->getKey(), &I->getValue()));
+  std::sort(Sorted.begin(), Sorted.end(), MoreInclusiveTime());
+  if (MaxHeaders && Sorted.size() > MaxHeaders)
+    Sorted.resize(MaxHeaders);
+
+  OS << "*** Header Costs (" << NumTranslationUnits << " translation unit"
+     << (NumTranslationUnits == 1 ? "" : "s") << ", " << Headers.size()
+     << " headers):\n";
+  OS << "  Incl(s)   Excl(s)  Parse(s)   Inst(s)    TUs   #incl  #lexed"
+        "      Bytes  RawTokens   Decls  Header\n";
+  for (unsigned I = 0, N = Sorted.size(); I != N; ++I) {
+    const HeaderCost &C = *Sorted[I].second;
+    OS << llvm::format("%9.4f %9.4f %9.4f %9.4f %6u %7u %7u %10llu %10llu "
+                       "%7u  ",
+                       C.InclusiveTime, C.ExclusiveTime, C.ParseTime,
+                       C.InstantiationTime, C.NumTranslationUnits,
+                       C.NumIncludes, C.NumEntered,
+                       (unsigned long long)C.BytesLexed,
+                       (unsigned long long)C.RawTokens, C.NumDecls)
+       << Sorted[I].first << '\n';
+  }
+}
+
+namespace {
+/// \brief Tracks the include stack to measure the time spent in each header
+/// and how often it is included.
+///
+/// The preprocessor owns this object and outlives the consumer, so this is
+/// also where the costs of the translation unit are accumulated.
+class HeaderCostCallbacks : public PPCallbacks {
+  SourceManager &SM;
+
+  struct IncludeStackEntry {
+    FileID FID;
+    uint64_t Start;
+    double NestedTime;
+  };
+  SmallVector<IncludeStackEntry, 16> IncludeStack;
+
+public:
+  struct FileCosts {
+    HeaderCost Cost;
+
+    /// \brief The first FileID the header was entered with, if any.
+    FileID FirstFID;
+  };
+  llvm::DenseMap<const FileEntry *, FileCosts> Files;
+
+  explicit HeaderCostCallbacks(SourceManager &SM) : SM(SM) { }
+
+  virtual void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                           SrcMgr::CharacteristicKind FileType,
+                           FileID PrevFID);
+
+  virtual void InclusionDirective(SourceLocation HashLoc,
+                                  const Token &IncludeTok,
+                                  StringRef FileName,
+                                  bool IsAngled,
+                                  CharSourceRange FilenameRange,
+                                  const FileEntry *File,
+                                  StringRef SearchPath,
+                                  StringRef RelativePath,
+                                  const Module *Imported) {
+    if (File)
+      ++Files[File].Cost.NumIncludes;
+  }
+};
+}
+
+void HeaderCostCallbacks::FileChanged(SourceLocation Loc,
+                                      FileChangeReason Reason,
+                                      SrcMgr::CharacteristicKind FileType,
+                                      FileID PrevFID) {
+  if (Reason == PPCallbacks::EnterFile) {
+    IncludeStackEntry Entry;
+    Entry.FID = SM.getFileID(Loc);
+    Entry.NestedTime = 0;
+    if (const FileEntry *FE = SM.getFileEntryForID(Entry.FID)) {
+      FileCosts &Costs = Files[FE];
+      ++Costs.Cost.NumEntered;
+      Costs.Cost.BytesLexed += SM.getBuffer(Entry.FID)->getBufferSize();
+      if (Costs.FirstFID.isInvalid())
+        Costs.FirstFID = Entry.FID;
+    }
+    Entry.Start = TimeTraceProfiler::getCurrentTime();
+    IncludeStack.push_back(Entry);
+    return;
+  }
+
+  if (Reason != PPCallbacks::ExitFile || IncludeStack.empty())
+    return;
+
+  IncludeStackEntry Entry = IncludeStack.pop_back_val();
+  double Elapsed
+    = (TimeTraceProfiler::getCurrentTime() - Entry.Start) / 1000000.0;
+  if (!IncludeStack.empty())
+    IncludeStack.back().NestedTime += Elapsed;
+
+  if (const FileEntry *FE = SM.getFileEntryForID(Entry.FID)) {
+    HeaderCost &Cost = Files[FE].Cost;
+    Cost.ExclusiveTime += Elapsed - Entry.NestedTime;
+
+    // A header that (indirectly) includes itself is only counted once.
+    bool IsOutermost = true;
+    for (unsigned I = 0, N = IncludeStack.size(); I != N; ++I)
+      if (SM.getFileEntryForID(IncludeStack[I].FID) == FE) {
+        IsOutermost = false;
+        break;
+      }
+    if (IsOutermost)
+      Cost.InclusiveTime += Elapsed;
+  }
+}
+
+namespace {
+/// \brief Attributes declarations, and the time spent parsing and analyzing
+/// them, to the headers they are written in.
+class HeaderCostConsumer : public SemaConsumer {
+  SourceManager &SM;
+  const LangOptions &LangOpts;
+  HeaderCostCallbacks *Callbacks;
+  HeaderCostReport *Aggregate;
+  Sema *SemaRef;
+  llvm::DenseMap<FileID, double> InstantiationTimes;
+  uint64_t LastDeclTime;
+
+  HeaderCost *getCost(SourceLocation Loc);
+  void countDecls(Decl *D);
+  uint64_t countRawTokens(FileID FID);
+
+public:
+  HeaderCostConsumer(CompilerInstance &CI, HeaderCostCallbacks *Callbacks,
+                     HeaderCostReport *Aggregate)
+    : SM(CI.getSourceManager()), LangOpts(CI.getLangOpts()),
+      Callbacks(Callbacks), Aggregate(Aggregate), SemaRef(0),
+      LastDeclTime(0) { }
+
+  virtual void Initialize(ASTContext &Context) {
+    LastDeclTime = TimeTraceProfiler::getCurrentTime();
+  }
+
+  virtual void InitializeSema(Sema &S) {
+    SemaRef = &S;
+    S.InstantiationTimes = &InstantiationTimes;
+  }
+
+  virtual void ForgetSema() {
+    if (SemaRef)
+      SemaRef->InstantiationTimes = 0;
+    SemaRef = 0;
+  }
+
+  virtual bool HandleTopLevelDecl(DeclGroupRef DG);
+  virtual void HandleTranslationUnit(ASTContext &Context);
+};
+}
+
+HeaderCost *HeaderCostConsumer::getCost(SourceLocation Loc) {
+  if (Loc.isInvalid())
+    return 0;
+  FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+  if (FID == SM.getMainFileID())
+    return 0;
+  if (const FileEntry *FE = SM.getFileEntryForID(FID))
+    return &Callbacks->Files[FE].Cost;
+  return 0;
+}
+
+void HeaderCostConsumer::countDecls(Decl *D) {
+  if (D->isImplicit())
+    return;
+  if (HeaderCost *Cost = getCost(D->getLocation()))
+    ++Cost->NumDecls;
+
+  // Count the members of namespaces, classes and so on, but not the local
+  // declarations of functions.
+  if (isa<FunctionDecl>(D))
+    return;
+  if (DeclContext *DC = dyn_cast<DeclContext>(D))
+    for (DeclContext::decl_iterator I = DC->decls_begin(),
+                                    E = DC->decls_end();
+         I != E; ++I)
+      countDecls(*I);
+}
+
+bool HeaderCostConsumer::HandleTopLevelDecl(DeclGroupRef DG) {
+  if (DG.isNull())
+    return true;
+
+  // Instantiated functions and static data members are handed to the
+  // consumer while the declaration that caused their instantiation is being
+  // analyzed; their time is accounted for in InstantiationTimes.
+  if (FunctionDecl *FD = dyn_cast<FunctionDecl>(*DG.begin()))
+    if (FD->isTemplateInstantiation())
+      return true;
+  if (VarDecl *VD = dyn_cast<VarDecl>(*DG.begin()))
+    if (VD->getTemplateSpecializationKind() == TSK_ImplicitInstantiation)
+      return true;
+
+  uint64_t Now = TimeTraceProfiler::getCurrentTime();
+  if (HeaderCost *Cost = getCost((*DG.begin())->getLocation()))
+    Cost->ParseTime += (Now - LastDeclTime) / 1000000.0;
+  LastDeclTime = Now;
+
+  for (DeclGroupRef::iterator I = DG.begin(), E = DG.end(); I != E; ++I)
+    countDecls(*I);
+  return true;
+}
+
+uint64_t HeaderCostConsumer::countRawTokens(FileID FID) {
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer = SM.getBuffer(FID, &Invalid);
+  if (Invalid)
+    return 0;
+
+  Lexer RawLex(FID, Buffer, SM, LangOpts);
+  uint64_t NumTokens = 0;
+  Token Tok;
+  while (true) {
+    RawLex.LexFromRawLexer(Tok);
+    if (Tok.is(tok::eof))
+      break;
+    ++NumTokens;
+  }
+  return NumTokens;
+}
+
+void HeaderCostConsumer::HandleTranslationUnit(ASTContext &Context) {
+  for (llvm::DenseMap<FileID, double>::iterator I = InstantiationTimes.begin(),
+                                                E = InstantiationTimes.end();
+       I != E; ++I)
+    if (HeaderCost *Cost = getCost(SM.getLocForStartOfFile(I->first)))
+      Cost->InstantiationTime += I->second;
+
+  HeaderCostReport Report;
+  Report.addTranslationUnit();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  for (llvm::DenseMap<const FileEntry *,
+                      HeaderCostCallbacks::FileCosts>::iterator
+         I = Callbacks->Files.begin(), E = Callbacks->Files.end();
+       I != E; ++I) {
+    if (I->first == MainFile)
+      continue;
+
+    HeaderCost Cost = I->second.Cost;
+    Cost.NumTranslationUnits = 1;
+    if (I->second.FirstFID.isValid())
+      Cost.RawTokens = countRawTokens(I->second.FirstFID) * Cost.NumEntered;
+
+    // Use absolute paths, so that the headers of translation units built in
+    // different directories match up.
+    SmallString<256> Path(I->first->getName());
+    llvm::sys::fs::make_absolute(Path);
+    Report.getCost(Path).add(Cost);
+  }
+
+  if (Aggregate)
+    Aggregate->merge(Report);
+  else
+    Report.print(llvm::outs());
+}
+
+ASTConsumer *clang::CreateHeaderCostConsumer(CompilerInstance &CI,
+                                             HeaderCostReport *Aggregate) {
+  HeaderCostCallbacks *Callbacks
+    = new HeaderCostCallbacks(CI.getSourceManager());
+  CI.getPreprocessor().addPPCallbacks(Callbacks);
+  return new HeaderCostConsumer(CI, Callbacks, Aggregate);
+}
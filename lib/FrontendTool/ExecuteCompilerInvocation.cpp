@@ -71,6 +71,7 @@ static FrontendAction *CreateFrontendBaseAction(CompilerInstance &CI) {
   }
 
   case PrintDeclContext:       return new DeclContextPrintAction();
+  case PrintHeaderCosts:       return new HeaderCostReportAction();
   case PrintPreamble:          return new PrintPreambleAction();
   case PrintPreprocessedInput: {
     if (CI.getPreprocessorOutputOpts().RewriteIncludes)
@@ -0,0 +1,73 @@
+//===--- DirectoryListingCache.cpp - Search directory contents ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the DirectoryListingCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DirectoryListingCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/system_error.h"
+#include <cstdio>
+using namespace clang;
+
+static llvm::ManagedStatic<DirectoryListingCache> SharedCache;
+
+DirectoryListingCache &DirectoryListingCache::getShared() {
+  return *SharedCache;
+}
+
+DirectoryListingCache::~DirectoryListingCache() {
+  for (unsigned I = 0, N = AllListings.size(); I != N; ++I)
+    delete AllListings[I];
+}
+
+bool DirectoryListingCache::Listing::mayContain(StringRef Name) const {
+  return Names.count(Name.lower());
+}
+
+const DirectoryListingCache::Listing *
+DirectoryListingCache::getListing(StringRef DirName, time_t ModTime) {
+  llvm::MutexGuard Guard(Lock);
+  Listing *&Current = Listings[DirName];
+
+  // A directory modified in the same second that it was listed may have
+  // changed after it was listed, without changing its modification time.
+  if (Current && Current->ModTime == ModTime && Current->ReadTime > ModTime) {
+    ++NumListingsReused;
+    return Current;
+  }
+
+  Listing *New = new Listing;
+  New->ModTime = ModTime;
+  New->ReadTime = time(0);
+  llvm::error_code EC;
+  for (llvm::sys::fs::directory_iterator Dir(DirName, EC), DirEnd;
+       Dir != DirEnd && !EC; Dir.increment(EC))
+    New->Names.insert(llvm::sys::path::filename(Dir->path()).lower());
+  if (EC) {
+    delete New;
+    return 0;
+  }
+
+  ++NumListingsRead;
+  AllListings.push_back(New);
+  Current = New;
+  return New;
+}
+
+void DirectoryListingCache::PrintStats() const {
+  llvm::MutexGuard Guard(Lock);
+  fprintf(stderr, "  %d directory listings read, %d reused.\n",
+          NumListingsRead, NumListingsReused);
+}
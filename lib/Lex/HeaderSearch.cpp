@@ -22,6 +22,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Capacity.h"
 #include <cstdio>
+#include <sys/stat.h>
 using namespace clang;
 
 const IdentifierInfo *
@@ -48,11 +49,13 @@ HeaderSearch::HeaderSearch(FileManager &FM, DiagnosticsEngine &Diags,
   SystemDirIdx = 0;
   NoCurDirSearch = false;
 
+  ListingCache = 0;
   ExternalLookup = 0;
   ExternalSource = 0;
   NumIncluded = 0;
   NumMultiIncludeFileOptzn = 0;
   NumFrameworkLookups = NumSubFrameworkLookups = 0;
+  NumLookupsSkippedByListing = 0;
 }
 
 HeaderSearch::~HeaderSearch() {
@@ -79,6 +82,12 @@ void HeaderSearch::PrintStats() {
   fprintf(stderr, "    %d #includes skipped due to"
           " the multi-include optimization.\n", NumMultiIncludeFileOptzn);
 
+  if (ListingCache) {
+    fprintf(stderr, "  %d lookups skipped by directory listings.\n",
+            NumLookupsSkippedByListing);
+    ListingCache->PrintStats();
+  }
+
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
 }
@@ -222,6 +231,9 @@ const FileEntry *DirectoryLookup::LookupFile(
       RelativePath->clear();
       RelativePath->append(Filename.begin(), Filename.end());
     }
+
+    if (!HS.mayContainFile(getDir(), Filename))
+      return 0;
     
     // If we have a module map that might map this header, load it and
     // check whether we'll have a suggestion for a module.
@@ -793,6 +805,41 @@ bool HeaderSearch::ShouldEnterIncludeFile(const FileEntry *File, bool isImport){
   return true;
 }
 
+bool HeaderSearch::mayContainFile(const DirectoryEntry *Dir,
+                                  StringRef Filename) {
+  // Virtual files need not exist on disk.
+  if (!ListingCache || FileMgr.hasVirtualFiles())
+    return true;
+
+  llvm::DenseMap<const DirectoryEntry *,
+                 const DirectoryListingCache::Listing *>::iterator Known
+    = DirectoryListings.find(Dir);
+  if (Known == DirectoryListings.end()) {
+    // Validate the shared listing of this directory against its current
+    // modification time, once per translation unit.
+    const DirectoryListingCache::Listing *Listing = 0;
+    SmallString<256> DirName(Dir->getName());
+    FileMgr.FixupRelativePath(DirName);
+    struct stat StatBuf;
+    if (!llvm::sys::fs::make_absolute(DirName) &&
+        !FileMgr.getNoncachedStatValue(DirName, StatBuf))
+      Listing = ListingCache->getListing(DirName, StatBuf.st_mtime);
+    Known = DirectoryListings.insert(std::make_pair(Dir, Listing)).first;
+  }
+
+  if (!Known->second)
+    return true;
+
+  // Only the first component of the file name has to be in the directory.
+  StringRef FirstComponent = *llvm::sys::path::begin(Filename);
+  if (FirstComponent == "." || FirstComponent == ".." ||
+      Known->second->mayContain(FirstComponent))
+    return true;
+
+  ++NumLookupsSkippedByListing;
+  return false;
+}
+
 size_t HeaderSearch::getTotalMemory() const {
   return SearchDirs.capacity()
     + llvm::capacity_in_bytes(FileInfo)
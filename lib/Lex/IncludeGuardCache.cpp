@@ -0,0 +1,163 @@
+//===--- IncludeGuardCache.cpp - Include guards shared across TUs ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the IncludeGuardCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/IncludeGuardCache.h"
+#include "clang/Basic/FileManager.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/system_error.h"
+using namespace clang;
+
+/// \brief The signature line at the start of a saved cache.
+static const char CacheSignature[] = "clang-include-guard-cache 1";
+
+static llvm::ManagedStatic<IncludeGuardCache> SharedCache;
+
+IncludeGuardCache &IncludeGuardCache::getShared() {
+  return *SharedCache;
+}
+
+std::string IncludeGuardCache::getKey(const FileEntry *File) {
+  SmallString<256> Path(File->getName());
+  llvm::sys::fs::make_absolute(Path);
+  return Path.str();
+}
+
+bool IncludeGuardCache::lookup(const FileEntry *File,
+                               std::string &Macro) const {
+  std::string Key = getKey(File);
+  llvm::MutexGuard Guard(Lock);
+  llvm::StringMap<Entry>::const_iterator I = Entries.find(Key);
+  if (I == Entries.end())
+    return false;
+
+  // The header may have been edited since its guard was recorded.
+  const Entry &E = I->second;
+  if (E.Size != File->getSize() || E.ModTime != File->getModificationTime())
+    return false;
+
+  Macro = E.Macro;
+  return true;
+}
+
+void IncludeGuardCache::record(const FileEntry *File, StringRef Macro) {
+  std::string Key = getKey(File);
+  llvm::MutexGuard Guard(Lock);
+  Entry &E = Entries[Key];
+  if (E.Size == File->getSize() && E.ModTime == File->getModificationTime() &&
+      E.Macro == Macro)
+    return;
+
+  E.Size = File->getSize();
+  E.ModTime = File->getModificationTime();
+  E.Macro = Macro;
+  Dirty = true;
+}
+
+bool IncludeGuardCache::load(StringRef Path) {
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  if (llvm::error_code EC = llvm::MemoryBuffer::getFile(Path, Buffer))
+    return EC != llvm::errc::no_such_file_or_directory;
+
+  StringRef Rest = Buffer->getBuffer();
+  StringRef Line;
+  llvm::tie(Line, Rest) = Rest.split('\n');
+  if (Line != CacheSignature)
+    return true;
+
+  llvm::MutexGuard Guard(Lock);
+  while (!Rest.empty()) {
+    llvm::tie(Line, Rest) = Rest.split('\n');
+    if (Line.empty())
+      continue;
+
+    // Each line has the form "<size> <mtime> <macro> <path>".
+    StringRef SizeStr, ModTimeStr, Macro;
+    llvm::tie(SizeStr, Line) = Line.split(' ');
+    llvm::tie(ModTimeStr, Line) = Line.split(' ');
+    llvm::tie(Macro, Line) = Line.split(' ');
+    unsigned long long Size, ModTime;
+    if (SizeStr.getAsInteger(10, Size) ||
+        ModTimeStr.getAsInteger(10, ModTime) || Macro.empty() ||
+        Line.empty())
+      return true;
+
+    // Entries recorded by this process take precedence.
+    if (Entries.count(Line))
+      continue;
+
+    Entry &E = Entries[Line];
+    E.Size = Size;
+    E.ModTime = ModTime;
+    E.Macro = Macro;
+  }
+
+  return false;
+}
+
+bool IncludeGuardCache::save(StringRef Path) {
+  // Pick up whatever other processes have saved in the meantime, so that
+  // concurrent compilations don't discard each other's entries.
+  load(Path);
+
+  llvm::MutexGuard Guard(Lock);
+  if (!Dirty)
+    return false;
+
+  // Write to a temporary file and later rename it to the actual file, to avoid
+  // possible race conditions.
+  SmallString<128> TempPath;
+  TempPath = Path;
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::unique_file(TempPath.str(), FD, TempPath,
+                                 /*makeAbsolute=*/false))
+    return true;
+
+  llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+  Out << CacheSignature << '\n';
+  for (llvm::StringMap<Entry>::const_iterator I = Entries.begin(),
+                                              E = Entries.end();
+       I != E; ++I)
+    Out << (unsigned long long)I->second.Size << ' '
+        << (unsigned long long)I->second.ModTime << ' '
+        << I->second.Macro << ' ' << I->getKey() << '\n';
+  Out.close();
+  if (Out.has_error()) {
+    Out.clear_error();
+    bool Exists;
+    llvm::sys::fs::remove(TempPath.str(), Exists);
+    return true;
+  }
+
+  if (llvm::sys::fs::rename(TempPath.str(), Path)) {
+    bool Exists;
+    llvm::sys::fs::remove(TempPath.str(), Exists);
+    return true;
+  }
+
+  Dirty = false;
+  return false;
+}
+
+unsigned IncludeGuardCache::size() const {
+  llvm::MutexGuard Guard(Lock);
+  return Entries.size();
+}
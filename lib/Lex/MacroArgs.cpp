@@ -15,49 +15,54 @@
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/LexDiagnostic.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/AlignOf.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include <algorithm>
 
 using namespace clang;
 
+/// MinSizeClass - The smallest MacroArgs allocation has room for 2^MinSizeClass
+/// unexpanded tokens, which covers most invocations.
+static const unsigned MinSizeClass = 3;
+
 /// MacroArgs ctor function - This destroys the vector passed in.
 MacroArgs *MacroArgs::create(const MacroInfo *MI,
                              llvm::ArrayRef<Token> UnexpArgTokens,
                              bool VarargsElided, Preprocessor &PP) {
   assert(MI->isFunctionLike() &&
          "Can't have args for an object-like macro!");
-  MacroArgs **ResultEnt = 0;
-  unsigned ClosestMatch = ~0U;
-  
-  // See if we have an entry with a big enough argument list to reuse on the
-  // free list.  If so, reuse it.
-  for (MacroArgs **Entry = &PP.MacroArgCache; *Entry;
-       Entry = &(*Entry)->ArgCache)
-    if ((*Entry)->NumUnexpArgTokens >= UnexpArgTokens.size() &&
-        (*Entry)->NumUnexpArgTokens < ClosestMatch) {
-      ResultEnt = Entry;
-      
-      // If we have an exact match, use it.
-      if ((*Entry)->NumUnexpArgTokens == UnexpArgTokens.size())
-        break;
-      // Otherwise, use the best fit.
-      ClosestMatch = (*Entry)->NumUnexpArgTokens;
-    }
-  
+
+  // Round the number of tokens up to a power of two, so that any object on
+  // the free list of that size class is big enough.
+  unsigned SizeClass = std::max(MinSizeClass,
+                                llvm::Log2_32_Ceil(UnexpArgTokens.size()));
+  assert(SizeClass < Preprocessor::NumMacroArgSizeClasses &&
+         "Too many macro argument tokens");
+  MacroArgs *&FreeList = PP.MacroArgCache[SizeClass];
+
   MacroArgs *Result;
-  if (ResultEnt == 0) {
-    // Allocate memory for a MacroArgs object with the lexer tokens at the end.
-    Result = (MacroArgs*)malloc(sizeof(MacroArgs) + 
-                                UnexpArgTokens.size() * sizeof(Token));
+  if (FreeList == 0) {
+    // Allocate memory for a MacroArgs object with the lexer tokens at the end,
+    // from the preprocessor's arena.  The memory is never released before the
+    // preprocessor is destroyed; it goes back to the free list instead.
+    size_t Size = sizeof(MacroArgs) + (size_t(1) << SizeClass) * sizeof(Token);
+    Result = (MacroArgs*)PP.getPreprocessorAllocator().Allocate(
+                           Size, llvm::AlignOf<MacroArgs>::Alignment);
     // Construct the MacroArgs object.
-    new (Result) MacroArgs(UnexpArgTokens.size(), VarargsElided);
+    new (Result) MacroArgs(UnexpArgTokens.size(), VarargsElided, SizeClass);
+    ++PP.NumMacroArgsAllocated;
+    PP.MacroArgsBytesAllocated += Size;
   } else {
-    Result = *ResultEnt;
+    Result = FreeList;
     // Unlink this node from the preprocessors singly linked list.
-    *ResultEnt = Result->ArgCache;
+    FreeList = Result->ArgCache;
     Result->NumUnexpArgTokens = UnexpArgTokens.size();
     Result->VarargsElided = VarargsElided;
+    ++PP.NumMacroArgsReused;
   }
 
   // Copy the actual unexpanded tokens to immediately after the result ptr.
@@ -78,9 +83,9 @@ void MacroArgs::destroy(Preprocessor &PP) {
   for (unsigned i = 0, e = PreExpArgTokens.size(); i != e; ++i)
     PreExpArgTokens[i].clear();
   
-  // Add this to the preprocessor's free list.
-  ArgCache = PP.MacroArgCache;
-  PP.MacroArgCache = this;
+  // Add this to the preprocessor's free list for its size class.
+  ArgCache = PP.MacroArgCache[SizeClass];
+  PP.MacroArgCache[SizeClass] = this;
 }
 
 /// deallocate - This should only be called by the Preprocessor when managing
@@ -88,10 +93,9 @@ void MacroArgs::destroy(Preprocessor &PP) {
 MacroArgs *MacroArgs::deallocate() {
   MacroArgs *Next = ArgCache;
   
-  // Run the dtor to deallocate the vectors.
+  // Run the dtor to deallocate the vectors.  The memory for the object itself
+  // belongs to the preprocessor's allocator.
   this->~MacroArgs();
-  // Release the memory for the object.
-  free(this);
   
   return Next;
 }
@@ -161,6 +165,22 @@ MacroArgs::getPreExpArgument(unsigned Arg, const MacroInfo *MI,
   const Token *AT = getUnexpArgument(Arg);
   unsigned NumToks = getArgLength(AT)+1;  // Include the EOF.
 
+  // If memoization is enabled and an identical argument was pre-expanded
+  // before, replay that expansion instead of expanding the argument again.
+  PreExpansionCache *Cache = PP.PreExpCache;
+  SmallString<128> Key;
+  PreExpansionCache::Recording Rec;
+  if (Cache) {
+    if (NumToks == 1 || !PreExpansionCache::getKey(AT, NumToks, Key)) {
+      ++Cache->NumUncacheable;
+      Cache = 0;
+    } else if (Cache->replay(Key, AT, NumToks, Result, PP)) {
+      return Result;
+    } else {
+      Cache->beginRecording(Rec, PP);
+    }
+  }
+
   // Otherwise, we have to pre-expand this argument, populating Result.  To do
   // this, we set up a fake TokenLexer to lex from the unexpanded argument
   // list.  With this installed, we lex expanded tokens until we hit the EOF
@@ -168,7 +188,9 @@ MacroArgs::getPreExpArgument(unsigned Arg, const MacroInfo *MI,
   PP.EnterTokenStream(AT, NumToks, false /*disable expand*/,
                       false /*owns tokens*/);
 
-  // Lex all of the macro-expanded tokens into Result.
+  // Lex all of the macro-expanded tokens into Result.  Most arguments expand
+  // to about as many tokens as they started with.
+  Result.reserve(NumToks);
   do {
     Result.push_back(Token());
     Token &Tok = Result.back();
@@ -183,9 +205,229 @@ MacroArgs::getPreExpArgument(unsigned Arg, const MacroInfo *MI,
   if (PP.InCachingLexMode())
     PP.ExitCachingLexMode();
   PP.RemoveTopOfLexerStack();
+
+  if (Cache)
+    Cache->endRecording(Rec, Key, AT, NumToks, Result, PP);
   return Result;
 }
 
+//===----------------------------------------------------------------------===//
+// PreExpansionCache Implementation
+//===----------------------------------------------------------------------===//
+
+/// MaxPreExpansionEntries - The cache is flushed when it grows beyond this
+/// many entries, which bounds its memory use on huge translation units.
+static const unsigned MaxPreExpansionEntries = 1 << 14;
+
+/// MaxChunkGap - Tokens whose spellings are at most this far apart share an
+/// expansion SLocEntry when replayed.
+static const unsigned MaxChunkGap = 50;
+
+/// getNumErrors - Return the number of errors reported so far.
+static unsigned getNumErrors(DiagnosticsEngine &Diags) {
+  return Diags.getClient() ? Diags.getClient()->getNumErrors() : 0;
+}
+
+template <typename T>
+static void appendKeyBytes(SmallVectorImpl<char> &Key, const T &Val) {
+  const char *Bytes = reinterpret_cast<const char *>(&Val);
+  Key.append(Bytes, Bytes + sizeof(T));
+}
+
+bool PreExpansionCache::getKey(const Token *ArgToks, unsigned NumToks,
+                               SmallVectorImpl<char> &Key) {
+  for (unsigned I = 0; I != NumToks; ++I) {
+    const Token &Tok = ArgToks[I];
+    if (Tok.isAnnotation() || Tok.is(tok::code_completion))
+      return false;
+
+    appendKeyBytes(Key, (unsigned short)Tok.getKind());
+    appendKeyBytes(Key, (unsigned char)Tok.getFlags());
+    if (IdentifierInfo *II = Tok.getIdentifierInfo()) {
+      appendKeyBytes(Key, II);
+    } else if (Tok.isLiteral()) {
+      // Literals are identified by their spelling.
+      const char *Data = Tok.getLiteralData();
+      if (!Data)
+        return false;
+      appendKeyBytes(Key, Tok.getLength());
+      Key.append(Data, Data + Tok.getLength());
+    } else {
+      // Punctuators only differ in their length, e.g. for digraphs.
+      appendKeyBytes(Key, Tok.getLength());
+    }
+  }
+  return true;
+}
+
+bool PreExpansionCache::replay(StringRef Key, const Token *ArgToks,
+                               unsigned NumToks, std::vector<Token> &Result,
+                               Preprocessor &PP) {
+  llvm::StringMap<Entry>::iterator I = Entries.find(Key);
+  if (I == Entries.end()) {
+    ++NumMisses;
+    return false;
+  }
+
+  Entry &E = I->second;
+  if (E.Generation != PP.MacroDefinitionGeneration) {
+    Entries.erase(I);
+    ++NumMisses;
+    return false;
+  }
+
+  // A macro that was expanded when recording may be disabled now because we
+  // are inside its own expansion; then the argument expands differently.
+  for (unsigned J = 0, N = E.Expanded.size(); J != N; ++J)
+    if (!E.Expanded[J]->isEnabled()) {
+      ++NumMisses;
+      return false;
+    }
+
+  ++NumHits;
+  for (unsigned J = 0, N = E.Expanded.size(); J != N; ++J) {
+    PP.markMacroAsUsed(E.Expanded[J]);
+    noteMacroExpanded(E.Expanded[J]);
+  }
+
+  // Rebuild the locations of the tokens for this occurrence of the argument.
+  // Tokens that came from macro expansions are attributed to an expansion of
+  // the whole argument.
+  SourceManager &SM = PP.getSourceManager();
+  SourceLocation ArgStart = ArgToks[0].getLocation();
+  SourceLocation ArgEnd = ArgToks[NumToks-2].getLocation();
+  Result = E.Result;
+  SourceLocation ChunkLoc;
+  for (unsigned J = 0, N = Result.size(); J != N; ++J) {
+    const TokenOrigin &O = E.Origins[J];
+    Token &Tok = Result[J];
+    if (O.ArgIndex >= 0) {
+      Tok.setLocation(ArgToks[O.ArgIndex].getLocation());
+    } else if (O.SpellingArgIndex >= 0) {
+      SourceLocation Spelling =
+        SM.getSpellingLoc(ArgToks[O.SpellingArgIndex].getLocation());
+      Tok.setLocation(SM.createExpansionLoc(Spelling, ArgStart, ArgEnd,
+                                            Tok.getLength()));
+    } else {
+      if (O.ChunkOffset == 0)
+        ChunkLoc = SM.createExpansionLoc(O.Spelling, ArgStart, ArgEnd,
+                                         O.ChunkLength);
+      Tok.setLocation(ChunkLoc.getLocWithOffset(O.ChunkOffset));
+    }
+  }
+  return true;
+}
+
+void PreExpansionCache::beginRecording(Recording &R, Preprocessor &PP) {
+  R.Generation = PP.MacroDefinitionGeneration;
+  R.NumBuiltinMacroExpanded = PP.NumBuiltinMacroExpanded;
+  R.NumPragma = PP.NumPragma;
+  R.NumSuppressedMacroExpansions = PP.NumSuppressedMacroExpansions;
+  R.NumWarnings = PP.getDiagnostics().getNumWarnings();
+  R.NumErrors = getNumErrors(PP.getDiagnostics());
+  R.LogStart = ExpandedLog.size();
+  ++RecordingDepth;
+}
+
+void PreExpansionCache::endRecording(const Recording &R, StringRef Key,
+                                     const Token *ArgToks, unsigned NumToks,
+                                     const std::vector<Token> &Result,
+                                     Preprocessor &PP) {
+  assert(RecordingDepth && "Unbalanced pre-expansion recording");
+  --RecordingDepth;
+
+  // The expanded macros stay in the log for the enclosing recordings.
+  std::vector<MacroInfo*> Expanded(ExpandedLog.begin() + R.LogStart,
+                                   ExpandedLog.end());
+  if (!RecordingDepth)
+    ExpandedLog.clear();
+
+  // Don't remember expansions whose result depends on more than the argument
+  // tokens and the macro definitions, or that produced diagnostics that
+  // would be lost when replaying them.
+  DiagnosticsEngine &Diags = PP.getDiagnostics();
+  if (R.Generation != PP.MacroDefinitionGeneration ||
+      R.NumBuiltinMacroExpanded != PP.NumBuiltinMacroExpanded ||
+      R.NumPragma != PP.NumPragma ||
+      R.NumSuppressedMacroExpansions != PP.NumSuppressedMacroExpansions ||
+      R.NumWarnings != Diags.getNumWarnings() ||
+      R.NumErrors != getNumErrors(Diags) ||
+      PP.getPreprocessingRecord()) {
+    ++NumUncacheable;
+    return;
+  }
+
+  // Map the locations and spellings of the argument tokens back to their
+  // index, so replayed tokens can refer to the new argument.
+  SourceManager &SM = PP.getSourceManager();
+  llvm::DenseMap<unsigned, int> ArgLocs, ArgSpellings;
+  for (unsigned I = 0; I != NumToks; ++I) {
+    SourceLocation Loc = ArgToks[I].getLocation();
+    if (Loc.isInvalid() ||
+        !ArgLocs.insert(std::make_pair(Loc.getRawEncoding(), I)).second) {
+      ++NumUncacheable;
+      return;
+    }
+    ArgSpellings.insert(std::make_pair(
+        SM.getSpellingLoc(Loc).getRawEncoding(), I));
+  }
+
+  Entry E;
+  E.Generation = R.Generation;
+  E.Result = Result;
+  E.Expanded.swap(Expanded);
+  E.Origins.resize(Result.size());
+
+  // Group the remaining tokens into chunks of tokens spelled close together
+  // in the same buffer.
+  TokenOrigin *ChunkStart = 0;
+  std::pair<FileID, unsigned> ChunkSpelling;
+  for (unsigned I = 0, N = Result.size(); I != N; ++I) {
+    TokenOrigin &O = E.Origins[I];
+    O.ArgIndex = O.SpellingArgIndex = -1;
+    O.ChunkOffset = O.ChunkLength = 0;
+
+    SourceLocation Loc = Result[I].getLocation();
+    if (Loc.isInvalid()) {
+      ++NumUncacheable;
+      return;
+    }
+
+    llvm::DenseMap<unsigned, int>::iterator Pos =
+      ArgLocs.find(Loc.getRawEncoding());
+    if (Pos != ArgLocs.end()) {
+      O.ArgIndex = Pos->second;
+      ChunkStart = 0;
+      continue;
+    }
+
+    SourceLocation Spelling = SM.getSpellingLoc(Loc);
+    Pos = ArgSpellings.find(Spelling.getRawEncoding());
+    if (Pos != ArgSpellings.end()) {
+      O.SpellingArgIndex = Pos->second;
+      ChunkStart = 0;
+      continue;
+    }
+
+    std::pair<FileID, unsigned> Decomposed = SM.getDecomposedLoc(Spelling);
+    unsigned LastOffset = ChunkStart ? (&O - 1)->ChunkOffset : 0;
+    if (ChunkStart && Decomposed.first == ChunkSpelling.first &&
+        Decomposed.second > ChunkSpelling.second + LastOffset &&
+        Decomposed.second - ChunkSpelling.second - LastOffset <= MaxChunkGap) {
+      O.ChunkOffset = Decomposed.second - ChunkSpelling.second;
+    } else {
+      ChunkStart = &O;
+      ChunkSpelling = Decomposed;
+      O.Spelling = Spelling;
+    }
+    ChunkStart->ChunkLength = O.ChunkOffset + Result[I].getLength();
+  }
+
+  if (Entries.size() >= MaxPreExpansionEntries)
+    Entries.clear();
+  Entries[Key] = E;
+}
+
 
 /// StringifyArgument - Implement C99 6.10.3.2p2, converting a sequence of
 /// tokens into the literal string token that should be produced by the C #
@@ -14,15 +14,16 @@
 #ifndef LLVM_CLANG_MACROARGS_H
 #define LLVM_CLANG_MACROARGS_H
 
+#include "clang/Lex/Token.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 
 #include <vector>
 
 namespace clang {
   class MacroInfo;
   class Preprocessor;
-  class Token;
-  class SourceLocation;
 
 /// MacroArgs - An instance of this class captures information about
 /// the formal arguments specified to a function-like macro invocation.
@@ -39,22 +40,30 @@ class MacroArgs {
   /// if in strict mode and the C99 varargs macro had only a ... argument, this
   /// is false.
   bool VarargsElided;
+
+  /// SizeClass - The allocation holds room for 2^SizeClass unexpanded tokens.
+  /// This is the index of the Preprocessor free list this object returns to.
+  unsigned char SizeClass;
   
   /// PreExpArgTokens - Pre-expanded tokens for arguments that need them.  Empty
   /// if not yet computed.  This includes the EOF marker at the end of the
-  /// stream.
+  /// stream.  The vectors keep their storage when this object is recycled, so
+  /// they only allocate when an argument grows larger than any argument
+  /// previously expanded in the same slot.
   std::vector<std::vector<Token> > PreExpArgTokens;
 
   /// StringifiedArgs - This contains arguments in 'stringified' form.  If the
   /// stringified form of an argument has not yet been computed, this is empty.
   std::vector<Token> StringifiedArgs;
 
-  /// ArgCache - This is a linked list of MacroArgs objects that the
-  /// Preprocessor owns which we use to avoid thrashing malloc/free.
+  /// ArgCache - This is a linked list of MacroArgs objects of the same size
+  /// class that the Preprocessor owns which we use to avoid thrashing
+  /// malloc/free.
   MacroArgs *ArgCache;
   
-  MacroArgs(unsigned NumToks, bool varargsElided)
-    : NumUnexpArgTokens(NumToks), VarargsElided(varargsElided), ArgCache(0) {}
+  MacroArgs(unsigned NumToks, bool varargsElided, unsigned sizeClass)
+    : NumUnexpArgTokens(NumToks), VarargsElided(varargsElided),
+      SizeClass(sizeClass), ArgCache(0) {}
   ~MacroArgs() {}
 public:
   /// MacroArgs ctor function - Create a new MacroArgs object with the specified
@@ -120,6 +129,107 @@ public:
   MacroArgs *deallocate();
 };
 
+/// PreExpansionCache - Remembers the pre-expanded form (C99 6.10.3.1) of
+/// macro arguments, keyed by their unexpanded token sequence, so that an
+/// argument that is passed to macros over and over again (like the
+/// arguments of nested assertion or logging macros) only has to be expanded
+/// once.  A remembered expansion is only replayed while the macro definitions
+/// it depends on are unchanged; its tokens are given fresh expansion
+/// locations covering the argument they are replayed for.
+class PreExpansionCache {
+  /// TokenOrigin - Describes where the location of a pre-expanded token comes
+  /// from, so that it can be rebuilt for another occurrence of the argument.
+  struct TokenOrigin {
+    /// ArgIndex - If the token is one of the unexpanded argument tokens, its
+    /// index within the argument, otherwise -1.
+    int ArgIndex;
+
+    /// SpellingArgIndex - If the token was produced by a macro expansion but is
+    /// spelled by one of the argument tokens, the index of that token,
+    /// otherwise -1.
+    int SpellingArgIndex;
+
+    /// ChunkOffset - The offset of the token's spelling from the first token
+    /// of its chunk.  Tokens spelled close together in the same buffer share
+    /// a single expansion SLocEntry, like TokenLexer does for macro bodies.
+    unsigned ChunkOffset;
+
+    /// ChunkLength - For the first token of a chunk, the length of the chunk.
+    unsigned ChunkLength;
+
+    /// Spelling - For the first token of a chunk, its spelling location.
+    SourceLocation Spelling;
+  };
+
+  struct Entry {
+    /// Generation - The macro definition generation this entry is valid for.
+    unsigned Generation;
+
+    /// Result - The pre-expanded tokens, including the trailing EOF.
+    std::vector<Token> Result;
+    std::vector<TokenOrigin> Origins;
+
+    /// Expanded - The macros that were expanded while computing Result; they
+    /// all have to be enabled for it to be replayed.
+    std::vector<MacroInfo*> Expanded;
+  };
+
+  llvm::StringMap<Entry> Entries;
+
+  /// ExpandedLog - The macros expanded while any argument is being recorded.
+  /// Nested recordings share the log and remember where they started.
+  SmallVector<MacroInfo*, 32> ExpandedLog;
+  unsigned RecordingDepth;
+
+  PreExpansionCache(const PreExpansionCache&) LLVM_DELETED_FUNCTION;
+  void operator=(const PreExpansionCache&) LLVM_DELETED_FUNCTION;
+
+public:
+  /// Recording - The state of the preprocessor when an argument started to be
+  /// pre-expanded, used to detect expansions that cannot be replayed.
+  struct Recording {
+    unsigned Generation;
+    unsigned NumBuiltinMacroExpanded;
+    unsigned NumPragma;
+    unsigned NumSuppressedMacroExpansions;
+    unsigned NumWarnings;
+    unsigned NumErrors;
+    unsigned LogStart;
+  };
+
+  unsigned NumHits, NumMisses, NumUncacheable;
+
+  PreExpansionCache()
+    : RecordingDepth(0), NumHits(0), NumMisses(0), NumUncacheable(0) {}
+
+  /// getKey - Compute the key for the specified unexpanded argument, including
+  /// its EOF.  Returns false if the argument contains tokens that cannot be
+  /// described by a key.
+  static bool getKey(const Token *ArgToks, unsigned NumToks,
+                     SmallVectorImpl<char> &Key);
+
+  /// replay - If the argument with the specified key has been recorded and is
+  /// still valid, fill in Result with its pre-expanded tokens and return true.
+  bool replay(StringRef Key, const Token *ArgToks, unsigned NumToks,
+              std::vector<Token> &Result, Preprocessor &PP);
+
+  /// beginRecording/endRecording - Bracket the pre-expansion of an argument,
+  /// remembering its result if the expansion can be replayed later.
+  void beginRecording(Recording &R, Preprocessor &PP);
+  void endRecording(const Recording &R, StringRef Key, const Token *ArgToks,
+                    unsigned NumToks, const std::vector<Token> &Result,
+                    Preprocessor &PP);
+
+  /// noteMacroExpanded - Called by the preprocessor for every macro it
+  /// expands.
+  void noteMacroExpanded(MacroInfo *MI) {
+    if (RecordingDepth)
+      ExpandedLog.push_back(MI);
+  }
+
+  size_t size() const { return Entries.size(); }
+};
+
 }  // end namespace clang
 
 #endif
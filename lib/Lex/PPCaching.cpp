@@ -24,11 +24,14 @@ using namespace clang;
 /// be called multiple times and CommitBacktrackedTokens/Backtrack calls will
 /// be combined with the EnableBacktrackAtThisPos calls in reverse order.
 void Preprocessor::EnableBacktrackAtThisPos() {
+  ++NumBacktrackPositions;
   BacktrackPositions.push_back(CachedLexPos);
   EnterCachingLexMode();
 }
 
 /// CommitBacktrackedTokens - Disable the last EnableBacktrackAtThisPos call.
+/// The cached tokens stay where they are; they are dropped once they have
+/// all been consumed and no backtrack position remains.
 void Preprocessor::CommitBacktrackedTokens() {
   assert(!BacktrackPositions.empty()
          && "EnableBacktrackAtThisPos was not called!");
@@ -40,6 +43,8 @@ void Preprocessor::CommitBacktrackedTokens() {
 void Preprocessor::Backtrack() {
   assert(!BacktrackPositions.empty()
          && "EnableBacktrackAtThisPos was not called!");
+  ++NumBacktracks;
+  NumBacktrackedTokens += CachedLexPos - BacktrackPositions.back();
   CachedLexPos = BacktrackPositions.back();
   BacktrackPositions.pop_back();
   recomputeCurLexerKind();
@@ -62,6 +67,8 @@ void Preprocessor::CachingLex(Token &Result) {
     EnterCachingLexMode();
     CachedTokens.push_back(Result);
     ++CachedLexPos;
+    if (CachedTokens.size() > MaxCachedTokens)
+      MaxCachedTokens = CachedTokens.size();
     return;
   }
 
@@ -90,6 +97,8 @@ const Token &Preprocessor::PeekAhead(unsigned N) {
     CachedTokens.push_back(Token());
     Lex(CachedTokens.back());
   }
+  if (CachedTokens.size() > MaxCachedTokens)
+    MaxCachedTokens = CachedTokens.size();
   EnterCachingLexMode();
   return CachedTokens.back();
 }
@@ -102,17 +111,36 @@ void Preprocessor::AnnotatePreviousCachedTokens(const Token &Tok) {
 
   // Start from the end of the cached tokens list and look for the token
   // that is the beginning of the annotation token.
-  for (CachedTokensTy::size_type i = CachedLexPos; i != 0; --i) {
-    CachedTokensTy::iterator AnnotBegin = CachedTokens.begin() + i-1;
-    if (AnnotBegin->getLocation() == Tok.getLocation()) {
+  for (unsigned i = CachedLexPos; i != 0; --i) {
+    Token &AnnotBegin = CachedTokens[i-1];
+    if (AnnotBegin.getLocation() == Tok.getLocation()) {
       assert((BacktrackPositions.empty() || BacktrackPositions.back() < i) &&
              "The backtrack pos points inside the annotated tokens!");
       // Replace the cached tokens with the single annotation token.
+      AnnotBegin = Tok;
       if (i < CachedLexPos)
-        CachedTokens.erase(AnnotBegin + 1, CachedTokens.begin() + CachedLexPos);
-      *AnnotBegin = Tok;
+        CachedTokens.erase(i, CachedLexPos);
       CachedLexPos = i;
       return;
     }
   }
 }
+
+void CachedTokenBuffer::insert(unsigned I, const Token &Tok) {
+  assert(I <= Size && "Insertion point out of range");
+  if (I == Size) {
+    push_back(Tok);
+    return;
+  }
+  push_back(back());
+  for (unsigned J = Size - 2; J != I; --J)
+    get(J) = get(J - 1);
+  get(I) = Tok;
+}
+
+void CachedTokenBuffer::erase(unsigned Begin, unsigned End) {
+  assert(Begin <= End && End <= Size && "Erased range out of range");
+  for (unsigned I = End; I != Size; ++I)
+    get(Begin + I - End) = get(I);
+  Size -= End - Begin;
+}
@@ -15,6 +15,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/LiteralSupport.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/CodeCompletionHandler.h"
@@ -1519,7 +1520,25 @@ void Preprocessor::HandleIncludeDirective(SourceLocation HashLoc,
 
   // Ask HeaderInfo if we should enter this #include file.  If not, #including
   // this file will have no effect.
-  if (!HeaderInfo.ShouldEnterIncludeFile(File, isImport)) {
+  bool SkipFile = !HeaderInfo.ShouldEnterIncludeFile(File, isImport);
+
+  // If another translation unit has already found the controlling macro of
+  // this file, tell HeaderInfo about it, and skip the file without entering
+  // it if the macro is already defined.
+  if (!SkipFile && GuardCache &&
+      !HeaderInfo.isFileMultipleIncludeGuarded(File)) {
+    std::string Macro;
+    if (GuardCache->lookup(File, Macro)) {
+      IdentifierInfo *ControllingMacro = getIdentifierInfo(Macro);
+      HeaderInfo.SetFileControllingMacro(File, ControllingMacro);
+      if (ControllingMacro->hasMacroDefinition()) {
+        ++NumIncludeGuardCacheHits;
+        SkipFile = true;
+      }
+    }
+  }
+
+  if (SkipFile) {
     if (Callbacks)
       Callbacks->FileSkipped(*File, FilenameTok, FileCharacter);
     return;
@@ -14,10 +14,12 @@
 
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PathV2.h"
@@ -82,6 +84,14 @@ void Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
       return;
     }
   }
+
+  for (unsigned I = 0, N = TokenCacheShards.size(); I != N; ++I) {
+    if (PTHLexer *PL = TokenCacheShards[I]->CreateLexer(FID)) {
+      ++NumTokenCacheShardHits;
+      EnterSourceFileWithPTH(PL, CurDir);
+      return;
+    }
+  }
   
   // Get the MemoryBuffer for this FID, if it fails, we fail.
   bool Invalid = false;
@@ -111,9 +121,19 @@ void Preprocessor::EnterSourceFileWithLexer(Lexer *TheLexer,
                                             const DirectoryLookup *CurDir) {
 
   // Add the current lexer to the include stack.
-  if (CurPPLexer || CurTokenLexer)
+  if (CurPPLexer || CurTokenLexer) {
     PushIncludeMacroStack();
 
+    // Time each #included file until HandleEndOfFile pops it again.  Files
+    // begin and end in the middle of parsing a declaration, so they are kept
+    // on their own track.
+    if (TimeTraceProfiler *Profiler = TimeTraceProfiler::get())
+      if (!TheLexer->Is_PragmaLexer)
+        Profiler->begin("Include",
+                        SourceMgr.getBufferName(TheLexer->getFileLoc()),
+                        TimeTraceProfiler::IncludeTrack);
+  }
+
   CurLexer.reset(TheLexer);
   CurPPLexer = TheLexer;
   CurDirLookup = CurDir;
@@ -135,9 +155,15 @@ void Preprocessor::EnterSourceFileWithLexer(Lexer *TheLexer,
 void Preprocessor::EnterSourceFileWithPTH(PTHLexer *PL,
                                           const DirectoryLookup *CurDir) {
 
-  if (CurPPLexer || CurTokenLexer)
+  if (CurPPLexer || CurTokenLexer) {
     PushIncludeMacroStack();
 
+    if (TimeTraceProfiler *Profiler = TimeTraceProfiler::get())
+      Profiler->begin("Include", SourceMgr.getBufferName(
+                        SourceMgr.getLocForStartOfFile(PL->getFileID())),
+                      TimeTraceProfiler::IncludeTrack);
+  }
+
   CurDirLookup = CurDir;
   CurPTHLexer.reset(PL);
   CurPPLexer = CurPTHLexer.get();
@@ -240,8 +266,11 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
           CurPPLexer->MIOpt.GetControllingMacroAtEndOfFile()) {
       // Okay, this has a controlling macro, remember in HeaderFileInfo.
       if (const FileEntry *FE =
-            SourceMgr.getFileEntryForID(CurPPLexer->getFileID()))
+            SourceMgr.getFileEntryForID(CurPPLexer->getFileID())) {
         HeaderInfo.SetFileControllingMacro(FE, ControllingMacro);
+        if (GuardCache)
+          GuardCache->record(FE, ControllingMacro->getName());
+      }
     }
   }
 
@@ -291,6 +320,11 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
     FileID ExitedFID;
     if (Callbacks && !isEndOfMacro && CurPPLexer)
       ExitedFID = CurPPLexer->getFileID();
+
+    if (TimeTraceProfiler *Profiler = TimeTraceProfiler::get())
+      if (!isEndOfMacro && CurPPLexer &&
+          !(CurLexer && CurLexer->Is_PragmaLexer))
+        Profiler->end(TimeTraceProfiler::IncludeTrack);
     
     // We're done with the #included file.
     RemoveTopOfLexerStack();
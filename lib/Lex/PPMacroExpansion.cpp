@@ -54,6 +54,7 @@ void Preprocessor::setMacroInfo(IdentifierInfo *II, MacroInfo *MI,
          "Undefined macros can only be registered when just LoadedFromAST");
   MI->setPreviousDefinition(Macros[II]);
   Macros[II] = MI;
+  ++MacroDefinitionGeneration;
   II->setHasMacroDefinition(MI->getUndefLoc().isInvalid());
   if (II->isFromAST() && !LoadedFromAST)
     II->setChangedSinceDeserialization();
@@ -64,6 +65,7 @@ void Preprocessor::clearMacroInfo(IdentifierInfo *II) {
   assert(II->hasMacroDefinition() && "Macro is not defined!");
   assert(Macros[II]->getUndefLoc().isValid() && "Macro is still defined!");
   II->setHasMacroDefinition(false);
+  ++MacroDefinitionGeneration;
   if (II->isFromAST())
     II->setChangedSinceDeserialization();
 }
@@ -259,6 +261,8 @@ bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
 
   // Notice that this macro has been used.
   markMacroAsUsed(MI);
+  if (PreExpCache)
+    PreExpCache->noteMacroExpanded(MI);
 
   // Remember where the token is expanded.
   SourceLocation ExpandLoc = Identifier.getLocation();
@@ -346,6 +350,7 @@ bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
       if (MacroInfo *NewMI = getMacroInfo(NewII))
         if (!NewMI->isEnabled() || NewMI == MI) {
           Identifier.setFlag(Token::DisableExpand);
+          ++NumSuppressedMacroExpansions;
           Diag(Identifier, diag::pp_disabled_macro_expansion);
         }
     }
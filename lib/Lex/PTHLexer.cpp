@@ -308,12 +308,27 @@ namespace {
 class PTHFileData {
   const uint32_t TokenOff;
   const uint32_t PPCondOff;
+  const uint32_t Inode;
+  const uint32_t Device;
+  const uint64_t ModTime;
+  const uint64_t Size;
 public:
-  PTHFileData(uint32_t tokenOff, uint32_t ppCondOff)
-    : TokenOff(tokenOff), PPCondOff(ppCondOff) {}
+  PTHFileData(uint32_t tokenOff, uint32_t ppCondOff, uint32_t inode,
+              uint32_t device, uint64_t modTime, uint64_t size)
+    : TokenOff(tokenOff), PPCondOff(ppCondOff), Inode(inode), Device(device),
+      ModTime(modTime), Size(size) {}
 
   uint32_t getTokenOffset() const { return TokenOff; }
   uint32_t getPPCondOffset() const { return PPCondOff; }
+
+  /// matches - Return true if the file that was cached has the same
+  ///  identity, size and modification time as the given file.
+  bool matches(const FileEntry *FE) const {
+    return Inode == (uint32_t) FE->getInode() &&
+           Device == (uint32_t) FE->getDevice() &&
+           ModTime == (uint64_t) FE->getModificationTime() &&
+           Size == (uint64_t) FE->getSize();
+  }
 };
 
 
@@ -356,7 +371,13 @@ public:
     assert(k.first == 0x1 && "Only file lookups can match!");
     uint32_t x = ::ReadUnalignedLE32(d);
     uint32_t y = ::ReadUnalignedLE32(d);
-    return PTHFileData(x, y);
+    // The stat information recorded for the file follows the offsets.
+    uint32_t ino = ::ReadUnalignedLE32(d);
+    uint32_t dev = ::ReadUnalignedLE32(d);
+    d += 2; // Skip the file mode.
+    uint64_t mtime = ::ReadUnalignedLE64(d);
+    uint64_t size = ::ReadUnalignedLE64(d);
+    return PTHFileData(x, y, ino, dev, mtime, size);
   }
 };
 
@@ -419,7 +440,7 @@ PTHManager::PTHManager(const llvm::MemoryBuffer* buf, void* fileLookup,
 : Buf(buf), PerIDCache(perIDCache), FileLookup(fileLookup),
   IdDataTable(idDataTable), StringIdLookup(stringIdLookup),
   NumIds(numIds), PP(0), SpellingBase(spellingBase),
-  OriginalSourceFile(originalSourceFile) {}
+  OriginalSourceFile(originalSourceFile), IsShard(false) {}
 
 PTHManager::~PTHManager() {
   delete Buf;
@@ -556,6 +577,16 @@ IdentifierInfo* PTHManager::LazilyCreateIdentifierInfo(unsigned PersistentID) {
     (const unsigned char*)Buf->getBufferStart() + ReadLE32(TableEntry);
   assert(IDData < (const unsigned char*)Buf->getBufferEnd());
 
+  // Shards share the preprocessor's identifiers, so that the same identifier
+  // coming from different shards maps to the same IdentifierInfo.
+  if (IsShard) {
+    assert(PP && "No preprocessor set yet!");
+    IdentifierInfo *II
+      = &PP->getIdentifierTable().get(StringRef((const char*) IDData));
+    PerIDCache[PersistentID] = II;
+    return II;
+  }
+
   // Allocate the object.
   std::pair<IdentifierInfo,const unsigned char*> *Mem =
     Alloc.Allocate<std::pair<IdentifierInfo,const unsigned char*> >();
@@ -600,6 +631,11 @@ PTHLexer *PTHManager::CreateLexer(FileID FID) {
 
   const PTHFileData& FileData = *I;
 
+  // A shard may have been generated by another compilation, possibly before
+  // the file was last modified. Only trust it if the file is unchanged.
+  if (IsShard && !FileData.matches(FE))
+    return 0;
+
   const unsigned char *BufStart = (const unsigned char *)Buf->getBufferStart();
   // Compute the offset of the token data within the buffer.
   const unsigned char* data = BufStart + FileData.getTokenOffset();
@@ -38,8 +38,9 @@ InclusionDirective::InclusionDirective(PreprocessingRecord &PPRec,
 }
 
 PreprocessingRecord::PreprocessingRecord(SourceManager &SM,
-                                         bool RecordConditionalDirectives)
-  : SourceMgr(SM),
+                                         bool RecordConditionalDirectives,
+                                         bool OnlyMainFileExpansions)
+  : SourceMgr(SM), OnlyMainFileExpansions(OnlyMainFileExpansions),
     RecordCondDirectives(RecordConditionalDirectives), CondDirectiveNextIdx(0),
     ExternalSource(0)
 {
@@ -118,10 +119,32 @@ bool PreprocessingRecord::isEntityInFileID(iterator PPEI, FileID FID) {
                                           FID, SourceMgr);
   }
 
-  assert(unsigned(PPID) < PreprocessedEntities.size() &&
+  assert(unsigned(PPID) < LocalBegins.size() &&
          "Out-of bounds local preprocessed entity");
-  return isPreprocessedEntityIfInFileID(PreprocessedEntities[PPID],
-                                        FID, SourceMgr);
+  SourceLocation Loc = LocalBegins[PPID];
+  if (Loc.isInvalid())
+    return false;
+  return SourceMgr.isInFileID(SourceMgr.getFileLoc(Loc), FID);
+}
+
+PreprocessedEntity::EntityKind
+PreprocessingRecord::getEntityKind(iterator PPEI) {
+  PPEntityID PPID = PPEI.Position;
+  if (PPID < 0)
+    return getPreprocessedEntity(PPID)->getKind();
+
+  assert(unsigned(PPID) < LocalKinds.size() &&
+         "Out-of bounds local preprocessed entity");
+  switch (LocalKinds[PPID]) {
+  case LEK_MacroExpansion:
+  case LEK_BuiltinMacroExpansion:
+    return PreprocessedEntity::MacroExpansionKind;
+  case LEK_MacroDefinition:
+    return PreprocessedEntity::MacroDefinitionKind;
+  case LEK_Materialized:
+    return MaterializedEntities[PPID]->getKind();
+  }
+  llvm_unreachable("Invalid local entity kind");
 }
 
 /// \brief Returns a pair of [Begin, End) iterators of preprocessed entities
@@ -168,48 +191,15 @@ PreprocessingRecord::findLocalPreprocessedEntitiesInRange(
   return std::make_pair(Begin, End);
 }
 
-namespace {
-
-template <SourceLocation (SourceRange::*getRangeLoc)() const>
-struct PPEntityComp {
-  const SourceManager &SM;
-
-  explicit PPEntityComp(const SourceManager &SM) : SM(SM) { }
-
-  bool operator()(PreprocessedEntity *L, PreprocessedEntity *R) const {
-    SourceLocation LHS = getLoc(L);
-    SourceLocation RHS = getLoc(R);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
-  }
-
-  bool operator()(PreprocessedEntity *L, SourceLocation RHS) const {
-    SourceLocation LHS = getLoc(L);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
-  }
-
-  bool operator()(SourceLocation LHS, PreprocessedEntity *R) const {
-    SourceLocation RHS = getLoc(R);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
-  }
-
-  SourceLocation getLoc(PreprocessedEntity *PPE) const {
-    SourceRange Range = PPE->getSourceRange();
-    return (Range.*getRangeLoc)();
-  }
-};
-
-}
-
 unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
                                                      SourceLocation Loc) const {
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  size_t Count = PreprocessedEntities.size();
+  size_t Count = LocalEnds.size();
   size_t Half;
-  std::vector<PreprocessedEntity *>::const_iterator
-    First = PreprocessedEntities.begin();
-  std::vector<PreprocessedEntity *>::const_iterator I;
+  std::vector<SourceLocation>::const_iterator First = LocalEnds.begin();
+  std::vector<SourceLocation>::const_iterator I;
 
   // Do a binary search manually instead of using std::lower_bound because
   // The end locations of entities may be unordered (when a macro expansion
@@ -219,8 +209,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
     Half = Count/2;
     I = First;
     std::advance(I, Half);
-    if (SourceMgr.isBeforeInTranslationUnit((*I)->getSourceRange().getEnd(),
-                                            Loc)){
+    if (SourceMgr.isBeforeInTranslationUnit(*I, Loc)) {
       First = I;
       ++First;
       Count = Count - Half - 1;
@@ -228,7 +217,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
       Count = Half;
   }
 
-  return First - PreprocessedEntities.begin();
+  return First - LocalEnds.begin();
 }
 
 unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
@@ -236,66 +225,94 @@ unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  std::vector<PreprocessedEntity *>::const_iterator
-  I = std::upper_bound(PreprocessedEntities.begin(),
-                       PreprocessedEntities.end(),
-                       Loc,
-                       PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  return I - PreprocessedEntities.begin();
+  std::vector<SourceLocation>::const_iterator
+  I = std::upper_bound(LocalBegins.begin(), LocalBegins.end(), Loc,
+                       BeforeThanCompare<SourceLocation>(SourceMgr));
+  return I - LocalBegins.begin();
+}
+
+unsigned PreprocessingRecord::getNameID(const IdentifierInfo *II) {
+  std::pair<llvm::DenseMap<const IdentifierInfo *, unsigned>::iterator, bool>
+    Known = NameIDs.insert(std::make_pair(II, Names.size()));
+  if (Known.second)
+    Names.push_back(const_cast<IdentifierInfo *>(II));
+  return Known.first->second;
 }
 
 PreprocessingRecord::PPEntityID
 PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   assert(Entity);
-  SourceLocation BeginLoc = Entity->getSourceRange().getBegin();
+  return addLocalEntity(LEK_Materialized, Entity->getSourceRange(), 0, Entity);
+}
 
-  if (!isa<class InclusionDirective>(Entity)) {
-    assert((PreprocessedEntities.empty() ||
-            !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) &&
-           "a macro directive was encountered out-of-order");
-    PreprocessedEntities.push_back(Entity);
-    return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
-  }
+PreprocessingRecord::PPEntityID
+PreprocessingRecord::addLocalEntity(LocalEntityKind Kind, SourceRange Range,
+                                    int Data,
+                                    PreprocessedEntity *Materialized) {
+  SourceLocation BeginLoc = Range.getBegin();
+  unsigned Index = LocalBegins.size();
 
   // Check normal case, this entity begin location is after the previous one.
-  if (PreprocessedEntities.empty() ||
-      !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) {
-    PreprocessedEntities.push_back(Entity);
-    return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
-  }
+  if (!LocalBegins.empty() &&
+      SourceMgr.isBeforeInTranslationUnit(BeginLoc, LocalBegins.back())) {
+    // The entity's location is not after the previous one; this can happen
+    // with include directives that form the filename using macros, e.g:
+    // "#include MACRO(STUFF)".
+    assert(Materialized && isa<class InclusionDirective>(Materialized) &&
+           "a macro directive was encountered out-of-order");
 
-  // The entity's location is not after the previous one; this can happen with
-  // include directives that form the filename using macros, e.g:
-  // "#include MACRO(STUFF)".
-
-  typedef std::vector<PreprocessedEntity *>::iterator pp_iter;
-
-  // Usually there are few macro expansions when defining the filename, do a
-  // linear search for a few entities.
-  unsigned count = 0;
-  for (pp_iter RI    = PreprocessedEntities.end(),
-               Begin = PreprocessedEntities.begin();
-       RI != Begin && count < 4; --RI, ++count) {
-    pp_iter I = RI;
-    --I;
-    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                                           (*I)->getSourceRange().getBegin())) {
-      pp_iter insertI = PreprocessedEntities.insert(RI, Entity);
-      return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                           /*isLoaded=*/false);
+    // Usually there are few macro expansions when defining the filename, do
+    // a linear search for a few entities, then fall back to a binary search.
+    unsigned Count = 0;
+    while (Index > 0 && Count < 4 &&
+           SourceMgr.isBeforeInTranslationUnit(BeginLoc,
+                                               LocalBegins[Index - 1])) {
+      --Index;
+      ++Count;
     }
+    if (Index > 0 && Count == 4 &&
+        SourceMgr.isBeforeInTranslationUnit(BeginLoc, LocalBegins[Index - 1]))
+      Index = std::upper_bound(LocalBegins.begin(), LocalBegins.end(),
+                               BeginLoc,
+                               BeforeThanCompare<SourceLocation>(SourceMgr))
+                - LocalBegins.begin();
+
+    shiftLocalEntities(Index);
   }
 
-  // Linear search unsuccessful. Do a binary search.
-  pp_iter I = std::upper_bound(PreprocessedEntities.begin(),
-                               PreprocessedEntities.end(),
-                               BeginLoc,
-                               PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  pp_iter insertI = PreprocessedEntities.insert(I, Entity);
-  return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                       /*isLoaded=*/false);
+  LocalBegins.insert(LocalBegins.begin() + Index, BeginLoc);
+  LocalEnds.insert(LocalEnds.begin() + Index, Range.getEnd());
+  LocalKinds.insert(LocalKinds.begin() + Index, Kind);
+  LocalData.insert(LocalData.begin() + Index, Data);
+  if (Materialized)
+    setMaterializedEntity(Index, Materialized);
+  return getPPEntityID(Index, /*isLoaded=*/false);
+}
+
+void PreprocessingRecord::shiftLocalEntities(unsigned Index) {
+  // Renumber the materialized entities after the insertion point.
+  if (Index < MaterializedEntities.size())
+    MaterializedEntities.insert(MaterializedEntities.begin() + Index, 0);
+
+  // Macro expansions refer to their definition by ID, so if a definition
+  // moves, they have to be updated as well.
+  bool MovesDefinition = false;
+  for (unsigned I = Index, N = LocalKinds.size(); I != N; ++I)
+    if (LocalKinds[I] == LEK_MacroDefinition) {
+      MovesDefinition = true;
+      break;
+    }
+  if (!MovesDefinition)
+    return;
+
+  for (unsigned I = 0, N = LocalKinds.size(); I != N; ++I)
+    if (LocalKinds[I] == LEK_MacroExpansion && LocalData[I] >= int(Index))
+      ++LocalData[I];
+  for (llvm::DenseMap<const MacroInfo *, PPEntityID>::iterator
+         I = MacroDefinitions.begin(), E = MacroDefinitions.end();
+       I != E; ++I)
+    if (I->second >= int(Index))
+      ++I->second;
 }
 
 void PreprocessingRecord::SetExternalSource(
@@ -324,9 +341,45 @@ PreprocessedEntity *PreprocessingRecord::getPreprocessedEntity(PPEntityID PPID){
            "Out-of bounds loaded preprocessed entity");
     return getLoadedPreprocessedEntity(LoadedPreprocessedEntities.size()+PPID);
   }
-  assert(unsigned(PPID) < PreprocessedEntities.size() &&
+  return getLocalPreprocessedEntity(PPID);
+}
+
+/// \brief Retrieve the local preprocessed entity at the given index, creating
+/// it if needed.
+PreprocessedEntity *
+PreprocessingRecord::getLocalPreprocessedEntity(unsigned Index) {
+  assert(Index < LocalBegins.size() &&
          "Out-of bounds local preprocessed entity");
-  return PreprocessedEntities[PPID];
+  if (Index < MaterializedEntities.size() && MaterializedEntities[Index])
+    return MaterializedEntities[Index];
+
+  // Don't hold on to a reference into MaterializedEntities: creating a macro
+  // expansion may materialize its definition as well.
+  PreprocessedEntity *Entity = 0;
+  SourceRange Range(LocalBegins[Index], LocalEnds[Index]);
+  switch (LocalKinds[Index]) {
+  case LEK_MacroExpansion:
+    Entity = new (*this) MacroExpansion(
+        cast<MacroDefinition>(getPreprocessedEntity(LocalData[Index])), Range);
+    break;
+  case LEK_BuiltinMacroExpansion:
+    Entity = new (*this) MacroExpansion(Names[LocalData[Index]], Range);
+    break;
+  case LEK_MacroDefinition:
+    Entity = new (*this) MacroDefinition(Names[LocalData[Index]], Range);
+    break;
+  case LEK_Materialized:
+    llvm_unreachable("Materialized entity is missing");
+  }
+  setMaterializedEntity(Index, Entity);
+  return Entity;
+}
+
+void PreprocessingRecord::setMaterializedEntity(unsigned Index,
+                                                PreprocessedEntity *Entity) {
+  if (Index >= MaterializedEntities.size())
+    MaterializedEntities.resize(Index + 1);
+  MaterializedEntities[Index] = Entity;
 }
 
 /// \brief Retrieve the loaded preprocessed entity at the given index.
@@ -346,15 +399,24 @@ PreprocessingRecord::getLoadedPreprocessedEntity(unsigned Index) {
 }
 
 MacroDefinition *PreprocessingRecord::findMacroDefinition(const MacroInfo *MI) {
+  llvm::Optional<PPEntityID> PPID = findMacroDefinitionID(MI);
+  if (!PPID.hasValue())
+    return 0;
+  return cast<MacroDefinition>(getPreprocessedEntity(PPID.getValue()));
+}
+
+llvm::Optional<PreprocessingRecord::PPEntityID>
+PreprocessingRecord::findMacroDefinitionID(const MacroInfo *MI) {
   llvm::DenseMap<const MacroInfo *, PPEntityID>::iterator Pos
     = MacroDefinitions.find(MI);
   if (Pos == MacroDefinitions.end())
-    return 0;
-  
-  PreprocessedEntity *Entity = getPreprocessedEntity(Pos->second);
-  if (Entity->isInvalid())
-    return 0;
-  return cast<MacroDefinition>(Entity);
+    return llvm::Optional<PPEntityID>();
+
+  // Local definitions are always valid; loaded ones have to be read to find
+  // out.
+  if (Pos->second < 0 && getPreprocessedEntity(Pos->second)->isInvalid())
+    return llvm::Optional<PPEntityID>();
+  return Pos->second;
 }
 
 void PreprocessingRecord::MacroExpands(const Token &Id, const MacroInfo* MI,
@@ -363,20 +425,25 @@ void PreprocessingRecord::MacroExpands(const Token &Id, const MacroInfo* MI,
   if (Id.getLocation().isMacroID())
     return;
 
-  if (MI->isBuiltinMacro())
-    addPreprocessedEntity(
-                      new (*this) MacroExpansion(Id.getIdentifierInfo(),Range));
-  else if (MacroDefinition *Def = findMacroDefinition(MI))
-    addPreprocessedEntity(
-                       new (*this) MacroExpansion(Def, Range));
+  if (OnlyMainFileExpansions && !SourceMgr.isFromMainFile(Id.getLocation()))
+    return;
+
+  if (MI->isBuiltinMacro()) {
+    addLocalEntity(LEK_BuiltinMacroExpansion, Range,
+                   getNameID(Id.getIdentifierInfo()), 0);
+    return;
+  }
+
+  llvm::Optional<PPEntityID> DefID = findMacroDefinitionID(MI);
+  if (DefID.hasValue())
+    addLocalEntity(LEK_MacroExpansion, Range, DefID.getValue(), 0);
 }
 
 void PreprocessingRecord::MacroDefined(const Token &Id,
                                        const MacroInfo *MI) {
   SourceRange R(MI->getDefinitionLoc(), MI->getDefinitionEndLoc());
-  MacroDefinition *Def
-      = new (*this) MacroDefinition(Id.getIdentifierInfo(), R);
-  MacroDefinitions[MI] = addPreprocessedEntity(Def);
+  MacroDefinitions[MI] = addLocalEntity(LEK_MacroDefinition, R,
+                                        getNameID(Id.getIdentifierInfo()), 0);
 }
 
 void PreprocessingRecord::MacroUndefined(const Token &Id,
@@ -524,6 +591,12 @@ void PreprocessingRecord::Endif(SourceLocation Loc, SourceLocation IfLoc) {
 size_t PreprocessingRecord::getTotalMemory() const {
   return BumpAlloc.getTotalMemory()
     + llvm::capacity_in_bytes(MacroDefinitions)
-    + llvm::capacity_in_bytes(PreprocessedEntities)
+    + llvm::capacity_in_bytes(LocalBegins)
+    + llvm::capacity_in_bytes(LocalEnds)
+    + llvm::capacity_in_bytes(LocalKinds)
+    + llvm::capacity_in_bytes(LocalData)
+    + llvm::capacity_in_bytes(MaterializedEntities)
+    + llvm::capacity_in_bytes(Names)
+    + llvm::capacity_in_bytes(NameIDs)
     + llvm::capacity_in_bytes(LoadedPreprocessedEntities);
 }
@@ -44,6 +44,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Capacity.h"
+#include <algorithm>
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -58,12 +59,12 @@ Preprocessor::Preprocessor(DiagnosticsEngine &diags, LangOptions &opts,
                            bool IncrProcessing)
   : Diags(&diags), LangOpts(opts), Target(target),FileMgr(Headers.getFileMgr()),
     SourceMgr(SM), HeaderInfo(Headers), TheModuleLoader(TheModuleLoader),
-    ExternalSource(0), Identifiers(opts, IILookup), 
+    ExternalSource(0), GuardCache(0), Identifiers(opts, IILookup), 
     IncrementalProcessing(IncrProcessing), CodeComplete(0), 
     CodeCompletionFile(0), CodeCompletionOffset(0), CodeCompletionReached(0),
     SkipMainFilePreamble(0, true), CurPPLexer(0), 
-    CurDirLookup(0), CurLexerKind(CLK_Lexer), Callbacks(0), MacroArgCache(0), 
-    Record(0), MIChainHead(0), MICache(0) 
+    CurDirLookup(0), CurLexerKind(CLK_Lexer), Callbacks(0), 
+    Record(0), CachedTokens(BP), MIChainHead(0), MICache(0) 
 {
   OwnsHeaderSearch = OwnsHeaders;
   
@@ -74,10 +75,18 @@ Preprocessor::Preprocessor(DiagnosticsEngine &diags, LangOptions &opts,
   NumDirectives = NumDefined = NumUndefined = NumPragma = 0;
   NumIf = NumElse = NumEndif = 0;
   NumEnteredSourceFiles = 0;
+  NumTokenCacheShardHits = NumIncludeGuardCacheHits = 0;
   NumMacroExpanded = NumFnMacroExpanded = NumBuiltinMacroExpanded = 0;
   NumFastMacroExpanded = NumTokenPaste = NumFastTokenPaste = 0;
   MaxIncludeStackDepth = 0;
   NumSkipped = 0;
+  NumMacroArgsAllocated = NumMacroArgsReused = 0;
+  MacroArgsBytesAllocated = 0;
+  std::fill(MacroArgCache, MacroArgCache + NumMacroArgSizeClasses,
+            (MacroArgs *)0);
+  PreExpCache = 0;
+  MacroDefinitionGeneration = 0;
+  NumSuppressedMacroExpansions = 0;
   
   // Default to discarding comments.
   KeepComments = false;
@@ -93,6 +102,8 @@ Preprocessor::Preprocessor(DiagnosticsEngine &diags, LangOptions &opts,
   PragmasEnabled = true;
 
   CachedLexPos = 0;
+  NumBacktrackPositions = NumBacktracks = NumBacktrackedTokens = 0;
+  MaxCachedTokens = 0;
   
   // We haven't read anything from the external source.
   ReadMacrosFromExternalSource = false;
@@ -148,9 +159,15 @@ Preprocessor::~Preprocessor() {
   for (unsigned i = 0, e = NumCachedTokenLexers; i != e; ++i)
     delete TokenLexerCache[i];
 
+  for (unsigned I = 0, N = TokenCacheShards.size(); I != N; ++I)
+    delete TokenCacheShards[I];
+
   // Free any cached MacroArgs.
-  for (MacroArgs *ArgList = MacroArgCache; ArgList; )
-    ArgList = ArgList->deallocate();
+  for (unsigned I = 0; I != NumMacroArgSizeClasses; ++I)
+    for (MacroArgs *ArgList = MacroArgCache[I]; ArgList; )
+      ArgList = ArgList->deallocate();
+
+  delete PreExpCache;
 
   // Release pragma information.
   delete PragmaHandlers;
@@ -165,6 +182,15 @@ Preprocessor::~Preprocessor() {
   delete Callbacks;
 }
 
+void Preprocessor::setMemoizeMacroArgExpansions(bool Memoize) {
+  if (!Memoize) {
+    delete PreExpCache;
+    PreExpCache = 0;
+  } else if (!PreExpCache) {
+    PreExpCache = new PreExpansionCache();
+  }
+}
+
 void Preprocessor::Initialize(const TargetInfo &Target) {
   assert((!this->Target || this->Target == &Target) &&
          "Invalid override of target information");
@@ -180,6 +206,14 @@ void Preprocessor::setPTHManager(PTHManager* pm) {
   FileMgr.addStatCache(PTH->createStatCache());
 }
 
+void Preprocessor::addTokenCacheShard(PTHManager *Shard) {
+  // Shards are validated against the real file system, so unlike the primary
+  // PTH file they do not install a stat cache.
+  Shard->setPreprocessor(this);
+  Shard->setIsShard(true);
+  TokenCacheShards.push_back(Shard);
+}
+
 void Preprocessor::DumpToken(const Token &Tok, bool DumpFlags) const {
   llvm::errs() << tok::getTokenName(Tok.getKind()) << " '"
                << getSpelling(Tok) << "'";
@@ -225,6 +259,13 @@ void Preprocessor::PrintStats() {
   llvm::errs() << "  #include/#include_next/#import:\n";
   llvm::errs() << "    " << NumEnteredSourceFiles << " source files entered.\n";
   llvm::errs() << "    " << MaxIncludeStackDepth << " max include stack depth\n";
+  if (!TokenCacheShards.empty())
+    llvm::errs() << "    " << NumTokenCacheShardHits
+                 << " source files read from token cache shards.\n";
+  if (GuardCache)
+    llvm::errs() << "    " << NumIncludeGuardCacheHits
+                 << " #includes skipped using the shared include guard"
+                    " cache.\n";
   llvm::errs() << "  " << NumIf << " #if/#ifndef/#ifdef.\n";
   llvm::errs() << "  " << NumElse << " #else/#elif.\n";
   llvm::errs() << "  " << NumEndif << " #endif.\n";
@@ -237,6 +278,22 @@ void Preprocessor::PrintStats() {
   llvm::errs() << (NumFastTokenPaste+NumTokenPaste)
              << " token paste (##) operations performed, "
              << NumFastTokenPaste << " on the fast path.\n";
+  llvm::errs() << NumMacroArgsAllocated << "/" << NumMacroArgsReused
+               << " macro argument lists allocated/reused, "
+               << MacroArgsBytesAllocated << "B allocated.\n";
+  if (PreExpCache) {
+    unsigned Lookups = PreExpCache->NumHits + PreExpCache->NumMisses;
+    llvm::errs() << PreExpCache->NumHits << "/" << Lookups
+                 << " macro argument pre-expansions reused ("
+                 << (Lookups ? PreExpCache->NumHits * 100 / Lookups : 0)
+                 << "%), " << PreExpCache->NumUncacheable
+                 << " not memoizable, " << PreExpCache->size()
+                 << " memoized.\n";
+  }
+  llvm::errs() << NumBacktracks << "/" << NumBacktrackPositions
+               << " backtrack positions rewound, re-lexing "
+               << NumBacktrackedTokens << " cached tokens; at most "
+               << MaxCachedTokens << " tokens cached.\n";
 
   llvm::errs() << "\nPreprocessor Memory: " << getTotalMemory() << "B total";
 
@@ -587,6 +644,7 @@ void Preprocessor::HandleIdentifier(Token &Identifier) {
   if (MacroInfo *MI = getMacroInfo(&II)) {
     if (!DisableMacroExpansion) {
       if (Identifier.isExpandDisabled()) {
+        ++NumSuppressedMacroExpansions;
         Diag(Identifier, diag::pp_disabled_macro_expansion);
       } else if (MI->isEnabled()) {
         if (!HandleMacroExpandedIdentifier(Identifier, MI))
@@ -596,6 +654,7 @@ void Preprocessor::HandleIdentifier(Token &Identifier) {
         // expanded, even if it's in a context where it could be expanded in the
         // future.
         Identifier.setFlag(Token::DisableExpand);
+        ++NumSuppressedMacroExpansions;
         Diag(Identifier, diag::pp_disabled_macro_expansion);
       }
     }
@@ -718,11 +777,13 @@ CommentHandler::~CommentHandler() { }
 
 CodeCompletionHandler::~CodeCompletionHandler() { }
 
-void Preprocessor::createPreprocessingRecord(bool RecordConditionalDirectives) {
+void Preprocessor::createPreprocessingRecord(bool RecordConditionalDirectives,
+                                             bool OnlyMainFileExpansions) {
   if (Record)
     return;
   
   Record = new PreprocessingRecord(getSourceManager(),
-                                   RecordConditionalDirectives);
+                                   RecordConditionalDirectives,
+                                   OnlyMainFileExpansions);
   addPPCallbacks(Record);
 }
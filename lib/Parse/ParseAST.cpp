@@ -22,6 +22,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/ExternalASTSource.h"
 #include "clang/AST/Stmt.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Parse/Parser.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/Support/CrashRecoveryContext.h"
@@ -29,6 +30,20 @@
 
 using namespace clang;
 
+/// \brief Parse the next top-level declaration, recording the time spent
+/// parsing and analyzing it if time tracing is on.
+static bool parseTopLevelDecl(Parser &P, Parser::DeclGroupPtrTy &ADecl) {
+  TimeTraceScope TimeScope("ParseTopLevelDecl");
+  bool AtEOF = P.ParseTopLevelDecl(ADecl);
+  if (TimeScope.isActive() && ADecl) {
+    DeclGroupRef DG = ADecl.get();
+    if (!DG.isNull())
+      if (NamedDecl *ND = dyn_cast<NamedDecl>(*DG.begin()))
+        TimeScope.setDetail(ND->getQualifiedNameAsString());
+  }
+  return AtEOF;
+}
+
 //===----------------------------------------------------------------------===//
 // Public interface to the file
 //===----------------------------------------------------------------------===//
@@ -41,7 +56,8 @@ void clang::ParseAST(Preprocessor &PP, ASTConsumer *Consumer,
                      ASTContext &Ctx, bool PrintStats,
                      TranslationUnitKind TUKind,
                      CodeCompleteConsumer *CompletionConsumer,
-                     bool SkipFunctionBodies) {
+                     bool SkipFunctionBodies,
+                     bool RetainSkippedFunctionBodies) {
 
   OwningPtr<Sema> S(new Sema(PP, Ctx, *Consumer,
                                    TUKind,
@@ -50,10 +66,12 @@ void clang::ParseAST(Preprocessor &PP, ASTConsumer *Consumer,
   // Recover resources if we crash before exiting this method.
   llvm::CrashRecoveryContextCleanupRegistrar<Sema> CleanupSema(S.get());
   
-  ParseAST(*S.get(), PrintStats, SkipFunctionBodies);
+  ParseAST(*S.get(), PrintStats, SkipFunctionBodies,
+           RetainSkippedFunctionBodies);
 }
 
-void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
+void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies,
+                     bool RetainSkippedFunctionBodies) {
   // Collect global stats on Decls/Stmts (until we have a module streamer).
   if (PrintStats) {
     Decl::EnableStatistics();
@@ -67,7 +85,8 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
   ASTConsumer *Consumer = &S.getASTConsumer();
 
   OwningPtr<Parser> ParseOP(new Parser(S.getPreprocessor(), S,
-                                       SkipFunctionBodies));
+                                       SkipFunctionBodies,
+                                       RetainSkippedFunctionBodies));
   Parser &P = *ParseOP.get();
 
   PrettyStackTraceParserEntry CrashInfo(P);
@@ -89,7 +108,7 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
   if (External)
     External->StartTranslationUnit(Consumer);
 
-  if (P.ParseTopLevelDecl(ADecl)) {
+  if (parseTopLevelDecl(P, ADecl)) {
     if (!External && !S.getLangOpts().CPlusPlus)
       P.Diag(diag::ext_empty_translation_unit);
   } else {
@@ -99,7 +118,7 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
       // skipping something.
       if (ADecl && !Consumer->HandleTopLevelDecl(ADecl.get()))
 	return;
-    } while (!P.ParseTopLevelDecl(ADecl));
+    } while (!parseTopLevelDecl(P, ADecl));
   }
 
   // Process any TopLevelDecls generated by #pragma weak.
@@ -108,7 +127,10 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
        E = S.WeakTopLevelDecls().end(); I != E; ++I)
     Consumer->HandleTopLevelDecl(DeclGroupRef(*I));
   
-  Consumer->HandleTranslationUnit(S.getASTContext());
+  {
+    TimeTraceScope TimeScope("HandleTranslationUnit");
+    Consumer->HandleTranslationUnit(S.getASTContext());
+  }
 
   std::swap(OldCollectStats, S.CollectStats);
   if (PrintStats) {
@@ -120,3 +142,12 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
     Consumer->PrintStats();
   }
 }
+
+bool clang::ParseSkippedFunctionBody(Sema &S, FunctionDecl *FD) {
+  if (!S.getSkippedFunctionBodyDefinition(FD))
+    return false;
+
+  Parser P(S.getPreprocessor(), S, /*SkipFunctionBodies=*/false);
+  PrettyStackTraceParserEntry CrashInfo(P);
+  return P.ParseSkippedFunctionBody(FD);
+}
@@ -1918,9 +1918,28 @@ Decl *Parser::ParseFunctionStatementBody(Decl *Decl, ParseScope &BodyScope) {
   assert(Tok.is(tok::l_brace));
   SourceLocation LBraceLoc = Tok.getLocation();
 
-  if (SkipFunctionBodies && trySkippingFunctionBody()) {
-    BodyScope.Exit();
-    return Actions.ActOnFinishFunctionBody(Decl, 0);
+  if (SkipFunctionBodies) {
+    // Keep the tokens of the body if it can be parsed on demand later. Only
+    // bodies that do not depend on template parameters can be, and none
+    // when templates are parsed late: a body parsed on demand may need to
+    // instantiate a template whose definition only the parser of the
+    // translation unit, which is gone by then, could parse.
+    FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(Decl);
+    OwningPtr<CachedTokens> Toks;
+    if (RetainSkippedFunctionBodies && FD && !FD->isDependentContext() &&
+        !getLangOpts().DelayedTemplateParsing &&
+        !PP.isCodeCompletionEnabled())
+      Toks.reset(new CachedTokens);
+
+    if (trySkippingFunctionBody(Toks.get())) {
+      if (Toks) {
+        CachedTokens *&Skipped = Actions.SkippedFunctionBodies[FD];
+        delete Skipped;
+        Skipped = Toks.take();
+      }
+      BodyScope.Exit();
+      return Actions.ActOnFinishFunctionBody(Decl, 0);
+    }
   }
 
   PrettyDeclStackTraceEntry CrashInfo(Actions, Decl, LBraceLoc,
@@ -1979,7 +1998,7 @@ Decl *Parser::ParseFunctionTryBlock(Decl *Decl, ParseScope &BodyScope) {
   return Actions.ActOnFinishFunctionBody(Decl, FnBody.take());
 }
 
-bool Parser::trySkippingFunctionBody() {
+bool Parser::trySkippingFunctionBody(CachedTokens *Toks) {
   assert(Tok.is(tok::l_brace));
   assert(SkipFunctionBodies &&
          "Should only be called when SkipFunctionBodies is enabled");
@@ -1987,9 +2006,18 @@ bool Parser::trySkippingFunctionBody() {
   // We're in code-completion mode. Skip parsing for all function bodies unless
   // the body contains the code-completion point.
   TentativeParsingAction PA(*this);
-  ConsumeBrace();
-  if (SkipUntil(tok::r_brace, /*StopAtSemi=*/false, /*DontConsume=*/false,
-                /*StopAtCodeCompletion=*/PP.isCodeCompletionEnabled())) {
+  bool Skipped;
+  if (Toks) {
+    Toks->push_back(Tok);
+    ConsumeBrace();
+    Skipped = ConsumeAndStoreUntil(tok::r_brace, *Toks, /*StopAtSemi=*/false);
+  } else {
+    ConsumeBrace();
+    Skipped = SkipUntil(tok::r_brace, /*StopAtSemi=*/false,
+                        /*DontConsume=*/false,
+                        /*StopAtCodeCompletion=*/PP.isCodeCompletionEnabled());
+  }
+  if (Skipped) {
     PA.Commit();
     return true;
   }
@@ -47,11 +47,13 @@ IdentifierInfo *Parser::getSEHExceptKeyword() {
   return Ident__except;
 }
 
-Parser::Parser(Preprocessor &pp, Sema &actions, bool SkipFunctionBodies)
+Parser::Parser(Preprocessor &pp, Sema &actions, bool SkipFunctionBodies,
+               bool RetainSkippedFunctionBodies)
   : PP(pp), Actions(actions), Diags(PP.getDiagnostics()),
     GreaterThanIsOperator(true), ColonIsSacred(false), 
     InMessageExpression(false), TemplateParameterDepth(0),
-    ParsingInObjCContainer(false), SkipFunctionBodies(SkipFunctionBodies) {
+    ParsingInObjCContainer(false), SkipFunctionBodies(SkipFunctionBodies),
+    RetainSkippedFunctionBodies(RetainSkippedFunctionBodies) {
   Tok.setKind(tok::eof);
   Actions.CurScope = 0;
   NumCachedScopes = 0;
@@ -425,6 +427,10 @@ Parser::~Parser() {
       it != LateParsedTemplateMap.end(); ++it)
     delete it->second;
 
+  // Sema may outlive this parser, so it must not call back into it.
+  if (Actions.OpaqueParser == this)
+    Actions.SetLateTemplateParser(0, 0);
+
   // Remove the pragma handlers we installed.
   PP.RemovePragmaHandler(AlignHandler.get());
   AlignHandler.reset();
@@ -1104,6 +1110,80 @@ Decl *Parser::ParseFunctionDefinition(ParsingDeclarator &D,
   return ParseFunctionStatementBody(Res, BodyScope);
 }
 
+bool Parser::ParseSkippedFunctionBody(FunctionDecl *FD) {
+  FD = Actions.getSkippedFunctionBodyDefinition(FD);
+  if (!FD)
+    return false;
+
+  OwningPtr<CachedTokens> Toks(Actions.SkippedFunctionBodies[FD]);
+  Actions.SkippedFunctionBodies.erase(FD);
+  assert(!Toks->empty() && "Empty body!");
+
+  DestroyTemplateIdAnnotationsRAIIObj CleanupRAII(TemplateIds);
+
+  // The scopes of the translation unit went away with the parser that
+  // skipped the body, so recreate the translation unit scope, then reenter
+  // the lexical parents of the function as for late-parsed templates.
+  TranslationUnitDecl *TU = Actions.Context.getTranslationUnitDecl();
+  Sema::ContextRAII GlobalSavedContext(Actions, TU);
+  ParseScope TUScope(this, Scope::DeclScope);
+  getCurScope()->setEntity(TU);
+  Scope *SavedTUScope = Actions.TUScope;
+  Actions.TUScope = getCurScope();
+
+  SmallVector<DeclContext*, 4> DeclContextToReenter;
+  for (DeclContext *DC = FD->getLexicalParent();
+       DC && !DC->isTranslationUnit(); DC = DC->getLexicalParent())
+    DeclContextToReenter.push_back(DC);
+
+  SmallVector<ParseScope*, 4> ReenteredScopes;
+  for (SmallVector<DeclContext*, 4>::reverse_iterator
+         I = DeclContextToReenter.rbegin(), E = DeclContextToReenter.rend();
+       I != E; ++I) {
+    ReenteredScopes.push_back(new ParseScope(this, Scope::DeclScope));
+    Actions.PushDeclContext(getCurScope(), *I);
+  }
+
+  // Append the current token at the end of the new token stream so that it
+  // doesn't get lost. The preprocessor owns the copy, since it may hold on
+  // to it after this parser is gone.
+  Token *Buffer = new Token[Toks->size() + 1];
+  std::copy(Toks->begin(), Toks->end(), Buffer);
+  Buffer[Toks->size()] = Tok;
+  PP.EnterTokenStream(Buffer, Toks->size() + 1, true, true);
+
+  // Consume the previously pushed token.
+  ConsumeAnyToken();
+  assert(Tok.is(tok::l_brace) && "Skipped body not starting with '{'");
+
+  {
+    ParseScope FnScope(this, Scope::FnScope|Scope::DeclScope);
+
+    // Recreate the containing function DeclContext.
+    Sema::ContextRAII FunctionSavedContext(Actions,
+                                           Actions.getContainingDC(FD));
+
+    Actions.ActOnStartOfFunctionDef(getCurScope(), FD);
+    ParseFunctionStatementBody(FD, FnScope);
+  }
+
+  // Skip whatever a parse error left of the body.
+  while (Tok.isNot(tok::eof))
+    ConsumeAnyToken();
+
+  for (SmallVector<ParseScope*, 4>::reverse_iterator
+         I = ReenteredScopes.rbegin(), E = ReenteredScopes.rend();
+       I != E; ++I)
+    delete *I;
+  TUScope.Exit();
+  Actions.TUScope = SavedTUScope;
+
+  // The body may have used templates whose instantiations were not needed
+  // when the translation unit was completed.
+  Actions.PerformPendingInstantiations();
+  return true;
+}
+
 /// ParseKNRParamDeclarations - Parse 'declaration-list[opt]' which provides
 /// types for a function with a K&R-style identifier list for arguments.
 void Parser::ParseKNRParamDeclarations(Declarator &D) {
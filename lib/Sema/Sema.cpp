@@ -21,6 +21,7 @@
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "clang/Sema/CXXFieldCollector.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "clang/Sema/TemplateInstantiationProfile.h"
 #include "clang/Sema/ExternalSemaSource.h"
 #include "clang/Sema/ObjCMethodList.h"
 #include "clang/Sema/PrettyDeclStackTrace.h"
@@ -40,6 +41,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 using namespace clang;
 using namespace sema;
 
@@ -71,7 +73,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
   : TheTargetAttributesSema(0), FPFeatures(pp.getLangOpts()),
     LangOpts(pp.getLangOpts()), PP(pp), Context(ctxt), Consumer(consumer),
     Diags(PP.getDiagnostics()), SourceMgr(PP.getSourceManager()),
-    CollectStats(false), ExternalSource(0), CodeCompleter(CodeCompleter),
+    CollectStats(false), InstantiationTimes(0), NestedInstantiationTime(0),
+    ExternalSource(0), CodeCompleter(CodeCompleter),
     CurContext(0), OriginalLexicalContext(0),
     PackContext(0), MSStructPragmaOn(false), VisContext(0),
     IsBuildingRecoveryCallExpr(false),
@@ -83,11 +86,17 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     NSDictionaryDecl(0), DictionaryWithObjectsMethod(0),
     GlobalNewDeleteDeclared(false), 
     TUKind(TUKind),
-    NumSFINAEErrors(0), InFunctionDeclarator(0),
+    NumSFINAEErrors(0), NumOverloadCandidates(0),
+    NumOverloadCandidatesPruned(0), NumConversionSequencesComputed(0),
+    NumConversionSequencesReused(0), NumPendingInstantiationsPerformed(0),
+    NumOutermostPendingInstantiations(0),
+    NumIndependentPendingInstantiations(0), InFunctionDeclarator(0),
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
     CurrentInstantiationScope(0), TyposCorrected(0),
-    AnalysisWarnings(*this)
+    TypoCorrectionTime(0), TypoCorrectionDisabled(false),
+    NumTypoCandidatesChecked(0), NumTypoCandidatesSkipped(0),
+    AnalysisWarnings(*this), PendingInstantiationDepth(0)
 {
   TUScope = 0;
   
@@ -174,6 +183,10 @@ Sema::~Sema() {
   if (VisContext) FreeVisContext();
   delete TheTargetAttributesSema;
   MSStructPragmaOn = false;
+  for (SkippedFunctionBodiesMap::iterator I = SkippedFunctionBodies.begin(),
+                                          E = SkippedFunctionBodies.end();
+       I != E; ++I)
+    delete I->second;
   // Kill all the active scopes.
   for (unsigned I = 1, E = FunctionScopes.size(); I != E; ++I)
     delete FunctionScopes[I];
@@ -190,6 +203,18 @@ Sema::~Sema() {
     ExternalSema->ForgetSema();
 }
 
+FunctionDecl *Sema::getSkippedFunctionBodyDefinition(FunctionDecl *FD) const {
+  if (!FD || SkippedFunctionBodies.empty())
+    return 0;
+
+  for (FunctionDecl::redecl_iterator I = FD->redecls_begin(),
+                                     E = FD->redecls_end();
+       I != E; ++I)
+    if (SkippedFunctionBodies.count(*I))
+      return *I;
+  return 0;
+}
+
 /// makeUnavailableInSystemHeader - There is an error in the current
 /// context.  If we're still in a system header, and we can plausibly
 /// make the relevant declaration unavailable instead of erroring, do
@@ -223,6 +248,20 @@ ASTMutationListener *Sema::getASTMutationListener() const {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumOverloadCandidates << " overload candidates considered, "
+               << NumOverloadCandidatesPruned
+               << " rejected without computing conversions.\n";
+  llvm::errs() << NumConversionSequencesComputed << "/"
+               << NumConversionSequencesReused
+               << " argument conversion sequences computed/reused.\n";
+  llvm::errs() << NumPendingInstantiationsPerformed
+               << " pending implicit instantiations performed, "
+               << NumIndependentPendingInstantiations << "/"
+               << NumOutermostPendingInstantiations
+               << " outermost ones independent of the rest of the queue.\n";
+  llvm::errs() << NumTypoCandidatesChecked
+               << " typo correction candidates checked, "
+               << NumTypoCandidatesSkipped << " ruled out by the index.\n";
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
@@ -532,6 +571,7 @@ void Sema::ActOnEndOfTranslationUnit() {
     // common behavior for C++ compilers, it is technically wrong. In the
     // future, we either need to be able to filter the results of name lookup
     // or we need to perform template instantiations earlier.
+    TimeTraceScope TimeScope("PerformPendingInstantiations");
     PerformPendingInstantiations();
   }
   
@@ -1260,7 +1260,23 @@ bool Sema::IsDerivedFrom(QualType Derived, QualType Base, CXXBasePaths &Paths) {
   CXXRecordDecl *BaseRD = GetClassForType(Base);
   if (!BaseRD)
     return false;
-  
+
+  // Most queries fail; answer those from the cache without walking the
+  // bases again.
+  if (!Context.isDerivedFrom(DerivedRD, BaseRD))
+    return false;
+
+  // Derived-to-base conversions find ambiguities and record paths, and the
+  // same conversion tends to be checked over and over, so reuse the paths
+  // found the first time.
+  if (Paths.isFindingAmbiguities() && Paths.isRecordingPaths() &&
+      !Paths.isDetectingVirtual())
+    if (const CXXBasePaths *Known
+          = Context.getDerivedToBasePaths(DerivedRD, BaseRD)) {
+      Paths.copyResults(*Known);
+      return true;
+    }
+
   return DerivedRD->isDerivedFrom(BaseRD, Paths);
 }
 
@@ -39,6 +39,8 @@
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/edit_distance.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Timer.h"
 #include <algorithm>
 #include <iterator>
 #include <limits>
@@ -3671,6 +3673,45 @@ static bool isCandidateViable(CorrectionCandidateCallback &CCC,
   return Candidate.getEditDistance(false) != TypoCorrection::InvalidDistance;
 }
 
+namespace {
+/// \brief Adds the time spent in a call to Sema::CorrectTypo to the total,
+/// and disables typo correction once that exceeds its limit.
+class TypoCorrectionTimer {
+  Sema &SemaRef;
+  SourceLocation Loc;
+  double Start;
+
+public:
+  TypoCorrectionTimer(Sema &SemaRef, SourceLocation Loc)
+    : SemaRef(SemaRef), Loc(Loc), Start(0) {
+    if (SemaRef.getLangOpts().TypoCorrectionTimeLimit)
+      Start = llvm::TimeRecord::getCurrentTime().getWallTime();
+  }
+
+  ~TypoCorrectionTimer() {
+    unsigned Limit = SemaRef.getLangOpts().TypoCorrectionTimeLimit;
+    if (!Limit)
+      return;
+
+    SemaRef.TypoCorrectionTime +=
+      llvm::TimeRecord::getCurrentTime().getWallTime() - Start;
+    if (SemaRef.TypoCorrectionTime * 1000 > Limit) {
+      SemaRef.TypoCorrectionDisabled = true;
+      SemaRef.Diag(Loc, diag::warn_typo_correction_disabled) << Limit;
+    }
+  }
+};
+}
+
+/// \brief If typos in lookups into \p DC can be remembered, because \p DC
+/// is a complete class whose members cannot change, return it.
+static DeclContext *getCompleteClassForTypoCache(DeclContext *DC) {
+  RecordDecl *RD = dyn_cast_or_null<RecordDecl>(DC);
+  if (!RD || !RD->isCompleteDefinition() || RD->isBeingDefined())
+    return 0;
+  return RD;
+}
+
 /// \brief Try to "correct" a typo in the source code by finding
 /// visible declarations whose names are similar to the name that was
 /// present in the source code.
@@ -3709,7 +3750,8 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
                                  DeclContext *MemberContext,
                                  bool EnteringContext,
                                  const ObjCObjectPointerType *OPT) {
-  if (Diags.hasFatalErrorOccurred() || !getLangOpts().SpellChecking)
+  if (Diags.hasFatalErrorOccurred() || !getLangOpts().SpellChecking ||
+      TypoCorrectionDisabled)
     return TypoCorrection();
 
   // In Microsoft mode, don't perform typo correction in a template member
@@ -3734,6 +3776,8 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
   if (!ActiveTemplateInstantiations.empty())
     return TypoCorrection();
 
+  TypoCorrectionTimer Timer(*this, TypoName.getLoc());
+
   NamespaceSpecifierSet Namespaces(Context, CurContext, SS);
 
   TypoCorrectionConsumer Consumer(*this, Typo);
@@ -3743,6 +3787,21 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
   TypoCorrection EmptyCorrection;
   bool ValidatingCallback = !isCandidateViable(CCC, EmptyCorrection);
 
+  // Remember the typos in lookups into complete classes that could not be
+  // corrected, unless the callback may have filtered out the corrections.
+  MemberTypo MemberTypoKey(Typo, std::make_pair((DeclContext *)0,
+                                                (unsigned)LookupKind));
+  if (!ValidatingCallback && !OPT) {
+    if (MemberContext)
+      MemberTypoKey.second.first = getCompleteClassForTypoCache(MemberContext);
+    else if (SS && SS->isSet())
+      MemberTypoKey.second.first =
+        getCompleteClassForTypoCache(computeDeclContext(*SS, EnteringContext));
+  }
+  bool CacheMemberTypo = MemberTypoKey.second.first != 0;
+  if (CacheMemberTypo && MemberTyposNotCorrected.count(MemberTypoKey))
+    return TypoCorrection();
+
   // Perform name lookup to find visible, similarly-named entities.
   bool IsUnqualifiedLookup = false;
   DeclContext *QualifiedDC = MemberContext;
@@ -3764,7 +3823,8 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
     // Provide a stop gap for files that are just seriously broken.  Trying
     // to correct all typos can turn into a HUGE performance penalty, causing
     // some files to take minutes to get rejected by the parser.
-    if (TyposCorrected + UnqualifiedTyposCorrected.size() >= 20)
+    if (TyposCorrected + UnqualifiedTyposCorrected.size() >=
+          getLangOpts().TypoCorrectionLimit)
       return TypoCorrection();
     ++TyposCorrected;
 
@@ -3791,7 +3851,8 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
       // Provide a stop gap for files that are just seriously broken.  Trying
       // to correct all typos can turn into a HUGE performance penalty, causing
       // some files to take minutes to get rejected by the parser.
-      if (TyposCorrected + UnqualifiedTyposCorrected.size() >= 20)
+      if (TyposCorrected + UnqualifiedTyposCorrected.size() >=
+          getLangOpts().TypoCorrectionLimit)
         return TypoCorrection();
     }
   }
@@ -3807,12 +3868,19 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
   
   if (IsUnqualifiedLookup || SearchNamespaces) {
     // For unqualified lookup, look through all of the names that we have
-    // seen in this translation unit.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    for (IdentifierTable::iterator I = Context.Idents.begin(),
-                                IEnd = Context.Idents.end();
-         I != IEnd; ++I)
-      Consumer.FoundName(I->getKey());
+    // seen in this translation unit that could be close enough to the typo.
+    if (!TypoIndex)
+      TypoIndex.reset(new TypoCorrectionIndex);
+    TypoIndex->update(Context.Idents);
+
+    StringRef TypoStr = Typo->getName();
+    SmallVector<StringRef, 32> Candidates;
+    NumTypoCandidatesSkipped += TypoIndex->lookup(TypoStr, TypoStr.size() / 3,
+                                                  (TypoStr.size() + 2) / 3,
+                                                  Candidates);
+    NumTypoCandidatesChecked += Candidates.size();
+    for (unsigned I = 0, N = Candidates.size(); I != N; ++I)
+      Consumer.FoundName(Candidates[I]);
 
     // Walk through identifiers in external identifier sources.
     // FIXME: Re-add the ability to skip very unlikely potential corrections.
@@ -3836,6 +3904,8 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
     // If this was an unqualified lookup, note that no correction was found.
     if (IsUnqualifiedLookup)
       (void)UnqualifiedTyposCorrected[Typo];
+    else if (CacheMemberTypo)
+      MemberTyposNotCorrected.insert(MemberTypoKey);
 
     return TypoCorrection();
   }
@@ -3847,6 +3917,8 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
     // If this was an unqualified lookup, note that no correction was found.
     if (IsUnqualifiedLookup)
       (void)UnqualifiedTyposCorrected[Typo];
+    else if (CacheMemberTypo)
+      MemberTyposNotCorrected.insert(MemberTypoKey);
 
     return TypoCorrection();
   }
@@ -4038,6 +4110,8 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
     // that no correction was found.
     if (IsUnqualifiedLookup && !ValidatingCallback)
       (void)UnqualifiedTyposCorrected[Typo];
+    else if (CacheMemberTypo)
+      MemberTyposNotCorrected.insert(MemberTypoKey);
 
     return TypoCorrection();
   }
@@ -4083,10 +4157,100 @@ TypoCorrection Sema::CorrectTypo(const DeclarationNameInfo &TypoName,
   // not filter out possible corrections, note that no correction was found.
   if (IsUnqualifiedLookup && !ValidatingCallback)
     (void)UnqualifiedTyposCorrected[Typo];
+  else if (CacheMemberTypo)
+    MemberTyposNotCorrected.insert(MemberTypoKey);
 
   return TypoCorrection();
 }
 
+uint64_t TypoCorrectionIndex::getCharacters(StringRef Name) {
+  uint64_t Characters = 0;
+  for (unsigned I = 0, N = Name.size(); I != N; ++I) {
+    char C = Name[I];
+    unsigned Bit;
+    if (C >= 'a' && C <= 'z')
+      Bit = C - 'a';
+    else if (C >= 'A' && C <= 'Z')
+      Bit = 26 + (C - 'A');
+    else if (C >= '0' && C <= '9')
+      Bit = 52 + (C - '0');
+    else if (C == '_')
+      Bit = 62;
+    else
+      Bit = 63;
+    Characters |= uint64_t(1) << Bit;
+  }
+  return Characters;
+}
+
+TypoCorrectionIndex::~TypoCorrectionIndex() {
+  if (Idents)
+    Idents->setNewIdentifierLog(0);
+}
+
+void TypoCorrectionIndex::add(StringRef Name) {
+  Entry NewEntry;
+  NewEntry.Name = Name;
+  NewEntry.Characters = getCharacters(Name);
+  if (Name.size() >= ByLength.size())
+    ByLength.resize(Name.size() + 1);
+  ByLength[Name.size()].push_back(NewEntry);
+  ++NumIndexed;
+}
+
+void TypoCorrectionIndex::update(IdentifierTable &Table) {
+  if (!Idents) {
+    // Index the whole table once, then have it log the identifiers added to
+    // it so that later updates only index those.
+    for (IdentifierTable::iterator I = Table.begin(), E = Table.end();
+         I != E; ++I)
+      add(I->getKey());
+    Idents = &Table;
+    Idents->setNewIdentifierLog(&NewIdentifiers);
+    return;
+  }
+
+  assert(Idents == &Table && "Typo correction index moved to another table");
+  for (unsigned I = 0, N = NewIdentifiers.size(); I != N; ++I)
+    add(NewIdentifiers[I]);
+  NewIdentifiers.clear();
+  assert(NumIndexed == Table.size() && "Identifier added but not logged");
+}
+
+unsigned
+TypoCorrectionIndex::lookup(StringRef Typo, unsigned MaxLengthDifference,
+                            unsigned MaxDistance,
+                            SmallVectorImpl<StringRef> &Candidates) const {
+  uint64_t TypoCharacters = getCharacters(Typo);
+  unsigned NumSkipped = NumIndexed;
+  unsigned MinLength = Typo.size() > MaxLengthDifference ?
+                         Typo.size() - MaxLengthDifference : 0;
+  unsigned EndLength = std::min(Typo.size() + MaxLengthDifference + 1,
+                                ByLength.size());
+  // Only the buckets of the lengths in range are visited; every identifier
+  // they do not contain is ruled out.
+  for (unsigned Length = MinLength; Length < EndLength; ++Length) {
+    const std::vector<Entry> &Entries = ByLength[Length];
+    NumSkipped -= Entries.size();
+
+    for (unsigned I = 0, NE = Entries.size(); I != NE; ++I) {
+      // Each edit adds at most one character that is not in the typo and
+      // removes at most one that is, so the edit distance is at least the
+      // number of characters found in only one of the two strings.
+      unsigned OnlyInName = llvm::CountPopulation_64(Entries[I].Characters &
+                                                     ~TypoCharacters);
+      unsigned OnlyInTypo = llvm::CountPopulation_64(TypoCharacters &
+                                                     ~Entries[I].Characters);
+      if (std::max(OnlyInName, OnlyInTypo) > MaxDistance) {
+        ++NumSkipped;
+        continue;
+      }
+      Candidates.push_back(Entries[I].Name);
+    }
+  }
+  return NumSkipped;
+}
+
 void TypoCorrection::addCorrectionDecl(NamedDecl *CDecl) {
   if (!CDecl) return;
 
@@ -750,6 +750,7 @@ void OverloadCandidateSet::clear() {
   NumInlineSequences = 0;
   Candidates.clear();
   Functions.clear();
+  ConversionCache.clear();
 }
 
 namespace {
@@ -5223,6 +5224,64 @@ Sema::ConvertToIntegralOrEnumerationType(SourceLocation Loc, Expr *From,
   return DefaultLvalueConversion(From);
 }
 
+/// \brief Determine, without computing the conversion sequence, whether the
+/// given argument certainly cannot initialize a parameter of the given type.
+///
+/// An object of class type can only initialize a parameter of non-class,
+/// non-reference type through a conversion function, so if its class has
+/// none there is nothing to look for. This is the common failure when
+/// passing class objects to large overload sets of functions taking
+/// builtin types, such as operator<<.
+static bool isObviouslyBadConversion(Expr *Arg, QualType ParamType) {
+  if (ParamType->isReferenceType() || ParamType->isRecordType() ||
+      ParamType->isDependentType() || isa<InitListExpr>(Arg))
+    return false;
+
+  const RecordType *RT = Arg->getType()->getAs<RecordType>();
+  if (!RT)
+    return false;
+  CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(RT->getDecl());
+  if (!RD || !(RD = RD->getDefinition()) || RD->isDependentContext())
+    return false;
+  return RD->getVisibleConversionFunctions()->empty();
+}
+
+/// \brief Compute the implicit conversion sequence that initializes a
+/// parameter of an overload candidate from the given argument.
+///
+/// Candidates of a set often have parameters of the same type, such as the
+/// stream parameter of every operator<<, so conversion sequences are shared
+/// through the candidate set.
+static ImplicitConversionSequence
+TryCandidateArgumentConversion(Sema &S, OverloadCandidateSet &CandidateSet,
+                               Expr *Arg, QualType ParamType,
+                               bool SuppressUserConversions,
+                               bool AllowExplicit) {
+  if (isObviouslyBadConversion(Arg, ParamType)) {
+    ++S.NumOverloadCandidatesPruned;
+    ImplicitConversionSequence ICS;
+    ICS.setBad(BadConversionSequence::no_conversion, Arg, ParamType);
+    return ICS;
+  }
+
+  bool AllowObjCWritebackConversion = S.getLangOpts().ObjCAutoRefCount;
+  unsigned Flags = SuppressUserConversions | AllowExplicit << 1 |
+                   AllowObjCWritebackConversion << 2;
+  if (const ImplicitConversionSequence *ICS
+        = CandidateSet.getCachedConversion(Arg, ParamType, Flags)) {
+    ++S.NumConversionSequencesReused;
+    return *ICS;
+  }
+
+  ++S.NumConversionSequencesComputed;
+  ImplicitConversionSequence ICS
+    = TryCopyInitialization(S, Arg, ParamType, SuppressUserConversions,
+                            /*InOverloadResolution=*/true,
+                            AllowObjCWritebackConversion, AllowExplicit);
+  CandidateSet.cacheConversion(Arg, ParamType, Flags, ICS);
+  return ICS;
+}
+
 /// AddOverloadCandidate - Adds the given function to the set of
 /// candidate functions, using the given function call arguments.  If
 /// @p SuppressUserConversions, then don't allow user-defined
@@ -5289,6 +5348,7 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
   Candidate.IsSurrogate = false;
   Candidate.IgnoreObjectArgument = false;
   Candidate.ExplicitCallArguments = Args.size();
+  ++NumOverloadCandidates;
 
   unsigned NumArgsInProto = Proto->getNumArgs();
 
@@ -5334,12 +5394,9 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
       // parameter of F.
       QualType ParamType = Proto->getArgType(ArgIdx);
       Candidate.Conversions[ArgIdx]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
-                                SuppressUserConversions,
-                                /*InOverloadResolution=*/true,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount,
-                                AllowExplicit);
+        = TryCandidateArgumentConversion(*this, CandidateSet, Args[ArgIdx],
+                                         ParamType, SuppressUserConversions,
+                                         AllowExplicit);
       if (Candidate.Conversions[ArgIdx].isBad()) {
         Candidate.Viable = false;
         Candidate.FailureKind = ovl_fail_bad_conversion;
@@ -5454,6 +5511,7 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
   Candidate.IsSurrogate = false;
   Candidate.IgnoreObjectArgument = false;
   Candidate.ExplicitCallArguments = Args.size();
+  ++NumOverloadCandidates;
 
   unsigned NumArgsInProto = Proto->getNumArgs();
 
@@ -5507,11 +5565,9 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
       // parameter of F.
       QualType ParamType = Proto->getArgType(ArgIdx);
       Candidate.Conversions[ArgIdx + 1]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
-                                SuppressUserConversions,
-                                /*InOverloadResolution=*/true,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount);
+        = TryCandidateArgumentConversion(*this, CandidateSet, Args[ArgIdx],
+                                         ParamType, SuppressUserConversions,
+                                         /*AllowExplicit=*/false);
       if (Candidate.Conversions[ArgIdx + 1].isBad()) {
         Candidate.Viable = false;
         Candidate.FailureKind = ovl_fail_bad_conversion;
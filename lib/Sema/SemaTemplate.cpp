@@ -14,6 +14,7 @@
 #include "clang/Sema/Scope.h"
 #include "clang/Sema/Template.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "clang/Sema/TemplateInstantiationProfile.h"
 #include "TreeTransform.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Expr.h"
@@ -2079,11 +2080,17 @@ QualType Sema::CheckTemplateIdType(TemplateName Name,
   } else if (ClassTemplateDecl *ClassTemplate
                = dyn_cast<ClassTemplateDecl>(Template)) {
     // Find the class template specialization declaration that
-    // corresponds to these arguments.
+    // corresponds to these arguments.  The arguments are uniqued once, and
+    // the new specialization reuses that if there is none yet.
     void *InsertPos = 0;
+    const UniquedTemplateArgumentList *UniquedArgs
+      = Context.getUniquedTemplateArgumentList(Converted.data(),
+                                               Converted.size());
     ClassTemplateSpecializationDecl *Decl
-      = ClassTemplate->findSpecialization(Converted.data(), Converted.size(),
-                                          InsertPos);
+      = ClassTemplate->findSpecialization(UniquedArgs, InsertPos);
+    if (TemplateProfile)
+      TemplateProfile->noteSpecializationLookup(
+                         ClassTemplate->getTemplatedDecl(), Decl != 0);
     if (!Decl) {
       // This is the first time we have referenced this class template
       // specialization. Create the canonical declaration and add it to
@@ -2096,6 +2103,7 @@ QualType Sema::CheckTemplateIdType(TemplateName Name,
                                                      ClassTemplate,
                                                      Converted.data(),
                                                      Converted.size(), 0);
+      Decl->setUniquedTemplateArgs(UniquedArgs);
       ClassTemplate->AddSpecialization(Decl, InsertPos);
       if (ClassTemplate->isOutOfLine())
         Decl->setLexicalDeclContext(ClassTemplate->getLexicalDeclContext());
@@ -5347,17 +5355,16 @@ Sema::ActOnClassTemplateSpecialization(Scope *S, unsigned TagSpec,
 
   void *InsertPos = 0;
   ClassTemplateSpecializationDecl *PrevDecl = 0;
+  const UniquedTemplateArgumentList *UniquedArgs
+    = Context.getUniquedTemplateArgumentList(Converted.data(),
+                                             Converted.size());
 
   if (isPartialSpecialization)
     // FIXME: Template parameter list matters, too
-    PrevDecl
-      = ClassTemplate->findPartialSpecialization(Converted.data(),
-                                                 Converted.size(),
-                                                 InsertPos);
+    PrevDecl = ClassTemplate->findPartialSpecialization(UniquedArgs,
+                                                        InsertPos);
   else
-    PrevDecl
-      = ClassTemplate->findSpecialization(Converted.data(),
-                                          Converted.size(), InsertPos);
+    PrevDecl = ClassTemplate->findSpecialization(UniquedArgs, InsertPos);
 
   ClassTemplateSpecializationDecl *Specialization = 0;
 
@@ -5432,6 +5439,7 @@ Sema::ActOnClassTemplateSpecialization(Scope *S, unsigned TagSpec,
                                                        CanonType,
                                                        PrevPartial,
                                                        SequenceNumber);
+    Partial->setUniquedTemplateArgs(UniquedArgs);
     SetNestedNameSpecifier(Partial, SS);
     if (TemplateParameterLists.size() > 1 && SS.isSet()) {
       Partial->setTemplateParameterListsInfo(Context,
@@ -5487,6 +5495,7 @@ Sema::ActOnClassTemplateSpecialization(Scope *S, unsigned TagSpec,
                                                 Converted.data(),
                                                 Converted.size(),
                                                 PrevDecl);
+    Specialization->setUniquedTemplateArgs(UniquedArgs);
     SetNestedNameSpecifier(Specialization, SS);
     if (TemplateParameterLists.size() > 0) {
       Specialization->setTemplateParameterListsInfo(Context,
@@ -6355,9 +6364,11 @@ Sema::ActOnExplicitInstantiation(Scope *S,
   // Find the class template specialization declaration that
   // corresponds to these arguments.
   void *InsertPos = 0;
+  const UniquedTemplateArgumentList *UniquedArgs
+    = Context.getUniquedTemplateArgumentList(Converted.data(),
+                                             Converted.size());
   ClassTemplateSpecializationDecl *PrevDecl
-    = ClassTemplate->findSpecialization(Converted.data(),
-                                        Converted.size(), InsertPos);
+    = ClassTemplate->findSpecialization(UniquedArgs, InsertPos);
 
   TemplateSpecializationKind PrevDecl_TSK
     = PrevDecl ? PrevDecl->getTemplateSpecializationKind() : TSK_Undeclared;
@@ -6408,6 +6419,7 @@ Sema::ActOnExplicitInstantiation(Scope *S,
                                                 Converted.data(),
                                                 Converted.size(),
                                                 PrevDecl);
+    Specialization->setUniquedTemplateArgs(UniquedArgs);
     SetNestedNameSpecifier(Specialization, SS);
 
     if (!HasNoEffect && !PrevDecl) {
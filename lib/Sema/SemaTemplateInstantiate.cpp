@@ -17,11 +17,13 @@
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/Template.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "clang/Sema/TemplateInstantiationProfile.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/Basic/LangOptions.h"
+#include "clang/Basic/TimeTrace.h"
 
 using namespace clang;
 using namespace sema;
@@ -404,6 +406,37 @@ void Sema::InstantiatingTemplate::Clear() {
   }
 }
 
+Sema::InstantiationTimer::InstantiationTimer(Sema &SemaRef,
+                                           SourceLocation PointOfInstantiation,
+                                             const Decl *Instantiation,
+                                             const Decl *Pattern)
+  : SemaRef(SemaRef), Start(0), PrevNestedTime(0),
+    Profiled(SemaRef.TemplateProfile.get() != 0) {
+  if (Profiled)
+    SemaRef.TemplateProfile->beginInstantiation(Instantiation, Pattern,
+                                                PointOfInstantiation);
+  if (!SemaRef.InstantiationTimes)
+    return;
+
+  PatternFile = SemaRef.SourceMgr.getFileID(
+                  SemaRef.SourceMgr.getExpansionLoc(Pattern->getLocation()));
+  PrevNestedTime = SemaRef.NestedInstantiationTime;
+  SemaRef.NestedInstantiationTime = 0;
+  Start = TimeTraceProfiler::getCurrentTime();
+}
+
+Sema::InstantiationTimer::~InstantiationTimer() {
+  if (Profiled)
+    SemaRef.TemplateProfile->endInstantiation();
+  if (!SemaRef.InstantiationTimes)
+    return;
+
+  double Elapsed = (TimeTraceProfiler::getCurrentTime() - Start) / 1000000.0;
+  (*SemaRef.InstantiationTimes)[PatternFile]
+    += Elapsed - SemaRef.NestedInstantiationTime;
+  SemaRef.NestedInstantiationTime = PrevNestedTime + Elapsed;
+}
+
 bool Sema::InstantiatingTemplate::CheckInstantiationDepth(
                                         SourceLocation PointOfInstantiation,
                                            SourceRange InstantiationRange) {
@@ -1950,6 +1983,15 @@ Sema::InstantiateClass(SourceLocation PointOfInstantiation,
   if (Inst)
     return true;
 
+  TimeTraceScope TimeScope("InstantiateClass");
+  if (TimeScope.isActive()) {
+    std::string Name;
+    Instantiation->getNameForDiagnostic(Name, getPrintingPolicy(), true);
+    TimeScope.setDetail(Name);
+  }
+  InstantiationTimer Timer(*this, PointOfInstantiation, Instantiation,
+                           Pattern);
+
   // Enter the scope of this instantiation. We don't use
   // PushDeclContext because we don't have a scope.
   ContextRAII SavedContext(*this, Instantiation);
@@ -13,6 +13,7 @@
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/PrettyDeclStackTrace.h"
 #include "clang/Sema/Template.h"
+#include "clang/Sema/TemplateInstantiationProfile.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclTemplate.h"
@@ -21,6 +22,7 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/TypeLoc.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Lex/Preprocessor.h"
 
 using namespace clang;
@@ -1050,6 +1052,8 @@ Decl *TemplateDeclInstantiator::VisitFunctionDecl(FunctionDecl *D,
     FunctionDecl *SpecFunc
       = FunctionTemplate->findSpecialization(Innermost.first, Innermost.second,
                                              InsertPos);
+    if (SemaRef.TemplateProfile)
+      SemaRef.TemplateProfile->noteSpecializationLookup(D, SpecFunc != 0);
 
     // If we already have a function template specialization, return it.
     if (SpecFunc)
@@ -1355,6 +1359,8 @@ TemplateDeclInstantiator::VisitCXXMethodDecl(CXXMethodDecl *D,
     FunctionDecl *SpecFunc
       = FunctionTemplate->findSpecialization(Innermost.first, Innermost.second,
                                              InsertPos);
+    if (SemaRef.TemplateProfile)
+      SemaRef.TemplateProfile->noteSpecializationLookup(D, SpecFunc != 0);
 
     // If we already have a function template specialization, return it.
     if (SpecFunc)
@@ -2758,6 +2764,15 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
   if (Inst)
     return;
 
+  TimeTraceScope TimeScope("InstantiateFunction");
+  if (TimeScope.isActive()) {
+    std::string Name;
+    Function->getNameForDiagnostic(Name, getPrintingPolicy(), true);
+    TimeScope.setDetail(Name);
+  }
+  InstantiationTimer Timer(*this, PointOfInstantiation, Function,
+                           PatternDecl);
+
   // Copy the inner loc start from the pattern.
   Function->setInnerLocStart(PatternDecl->getInnerLocStart());
 
@@ -2927,6 +2942,8 @@ void Sema::InstantiateStaticDataMemberDefinition(
   if (Inst)
     return;
 
+  InstantiationTimer Timer(*this, PointOfInstantiation, Var, Def);
+
   // If we're performing recursive template instantiation, create our own
   // queue of pending implicit instantiations that we will instantiate later,
   // while we're still within our own instantiation context.
@@ -3604,51 +3621,81 @@ void Sema::PerformPendingInstantiations(bool LocalOnly) {
       PendingLocalImplicitInstantiations.pop_front();
     }
 
-    // Instantiate function definitions
-    if (FunctionDecl *Function = dyn_cast<FunctionDecl>(Inst.first)) {
-      PrettyDeclStackTraceEntry CrashInfo(*this, Function, SourceLocation(),
-                                          "instantiating function definition");
-      bool DefinitionRequired = Function->getTemplateSpecializationKind() ==
-                                TSK_ExplicitInstantiationDefinition;
-      InstantiateFunctionDefinition(/*FIXME:*/Inst.second, Function, true,
-                                    DefinitionRequired);
-      continue;
+    // Keep track of the instantiations taken from the outermost queue that
+    // are independent of the rest of it: they perform no other pending
+    // instantiation, queue none, and create no template specialization or
+    // type that another entry could observe.  This only measures how much
+    // of this phase could be reordered; it is still performed serially.
+    unsigned NumPerformedBefore = NumPendingInstantiationsPerformed++;
+    bool Outermost = !LocalOnly && PendingInstantiationDepth == 0;
+    size_t NumQueuedBefore = PendingInstantiations.size() +
+                             PendingLocalImplicitInstantiations.size();
+    size_t NumTypesBefore = Context.getTypes().size();
+    unsigned NumSpecializationsBefore = Context.getNumTemplateSpecializations();
+
+    ++PendingInstantiationDepth;
+    PerformPendingInstantiation(Inst);
+    --PendingInstantiationDepth;
+
+    if (Outermost) {
+      ++NumOutermostPendingInstantiations;
+      if (NumPendingInstantiationsPerformed == NumPerformedBefore + 1 &&
+          PendingInstantiations.size() +
+            PendingLocalImplicitInstantiations.size() == NumQueuedBefore &&
+          Context.getTypes().size() == NumTypesBefore &&
+          Context.getNumTemplateSpecializations() ==
+            NumSpecializationsBefore)
+        ++NumIndependentPendingInstantiations;
     }
+  }
+}
 
-    // Instantiate static data member definitions.
-    VarDecl *Var = cast<VarDecl>(Inst.first);
-    assert(Var->isStaticDataMember() && "Not a static data member?");
-
-    // Don't try to instantiate declarations if the most recent redeclaration
-    // is invalid.
-    if (Var->getMostRecentDecl()->isInvalidDecl())
-      continue;
+/// \brief Perform a single pending implicit instantiation.
+void Sema::PerformPendingInstantiation(PendingImplicitInstantiation Inst) {
+  // Instantiate function definitions
+  if (FunctionDecl *Function = dyn_cast<FunctionDecl>(Inst.first)) {
+    PrettyDeclStackTraceEntry CrashInfo(*this, Function, SourceLocation(),
+                                        "instantiating function definition");
+    bool DefinitionRequired = Function->getTemplateSpecializationKind() ==
+                              TSK_ExplicitInstantiationDefinition;
+    InstantiateFunctionDefinition(/*FIXME:*/Inst.second, Function, true,
+                                  DefinitionRequired);
+    return;
+  }
 
-    // Check if the most recent declaration has changed the specialization kind
-    // and removed the need for implicit instantiation.
-    switch (Var->getMostRecentDecl()->getTemplateSpecializationKind()) {
-    case TSK_Undeclared:
-      llvm_unreachable("Cannot instantitiate an undeclared specialization.");
-    case TSK_ExplicitInstantiationDeclaration:
-    case TSK_ExplicitSpecialization:
-      continue;  // No longer need to instantiate this type.
-    case TSK_ExplicitInstantiationDefinition:
-      // We only need an instantiation if the pending instantiation *is* the
-      // explicit instantiation.
-      if (Var != Var->getMostRecentDecl()) continue;
-    case TSK_ImplicitInstantiation:
-      break;
-    }
+  // Instantiate static data member definitions.
+  VarDecl *Var = cast<VarDecl>(Inst.first);
+  assert(Var->isStaticDataMember() && "Not a static data member?");
 
-    PrettyDeclStackTraceEntry CrashInfo(*this, Var, Var->getLocation(),
-                                        "instantiating static data member "
-                                        "definition");
+  // Don't try to instantiate declarations if the most recent redeclaration
+  // is invalid.
+  if (Var->getMostRecentDecl()->isInvalidDecl())
+    return;
 
-    bool DefinitionRequired = Var->getTemplateSpecializationKind() ==
-                              TSK_ExplicitInstantiationDefinition;
-    InstantiateStaticDataMemberDefinition(/*FIXME:*/Inst.second, Var, true,
-                                          DefinitionRequired);
-  }
+  // Check if the most recent declaration has changed the specialization kind
+  // and removed the need for implicit instantiation.
+  switch (Var->getMostRecentDecl()->getTemplateSpecializationKind()) {
+  case TSK_Undeclared:
+    llvm_unreachable("Cannot instantitiate an undeclared specialization.");
+  case TSK_ExplicitInstantiationDeclaration:
+  case TSK_ExplicitSpecialization:
+    return;  // No longer need to instantiate this type.
+  case TSK_ExplicitInstantiationDefinition:
+    // We only need an instantiation if the pending instantiation *is* the
+    // explicit instantiation.
+    if (Var != Var->getMostRecentDecl()) return;
+  case TSK_ImplicitInstantiation:
+    break;
+  }
+
+  PrettyDeclStackTraceEntry CrashInfo(*this, Var, Var->getLocation(),
+                                      "instantiating static data member "
+                                      "definition");
+
+  bool DefinitionRequired = Var->getTemplateSpecializationKind() ==
+                            TSK_ExplicitInstantiationDefinition;
+  InstantiateStaticDataMemberDefinition(/*FIXME:*/Inst.second, Var, true,
+                                        DefinitionRequired);
 }
 
 void Sema::PerformDependentDiagnostics(const DeclContext *Pattern,
@@ -0,0 +1,236 @@
+//===--- TemplateInstantiationProfile.cpp - Instantiation profile ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements TemplateInstantiationProfile.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Sema/TemplateInstantiationProfile.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/Stmt.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace clang;
+
+typedef TemplateInstantiationProfile::Stats Stats;
+
+TemplateInstantiationProfile::TemplateInstantiationProfile(ASTContext &Context)
+  : Context(Context) {
+  // Only count the nodes; collecting the statistics would also record every
+  // DeclContext lookup and skew the times measured.
+  Decl::EnableCounting();
+  Stmt::EnableCounting();
+}
+
+unsigned TemplateInstantiationProfile::getNumNodesCreated() {
+  return Decl::getNumCreated() + Stmt::getNumCreated();
+}
+
+void TemplateInstantiationProfile::beginInstantiation(
+                                         const Decl *Specialization,
+                                         const Decl *Pattern,
+                                         SourceLocation PointOfInstantiation) {
+  ActiveInstantiation Active;
+  Active.Template = Pattern->getCanonicalDecl();
+  Active.Specialization = Specialization;
+  Active.PointOfInstantiation = PointOfInstantiation;
+  Active.NestedTime = 0;
+  Active.NestedNodes = 0;
+  Active.NumNested = 0;
+  Active.StartNodes = getNumNodesCreated();
+  Active.StartTime = TimeTraceProfiler::getCurrentTime();
+  Stack.push_back(Active);
+}
+
+void TemplateInstantiationProfile::endInstantiation() {
+  assert(!Stack.empty() && "No instantiation in progress");
+  uint64_t Now = TimeTraceProfiler::getCurrentTime();
+  ActiveInstantiation Active = Stack.pop_back_val();
+  double Time = (Now - Active.StartTime) / 1000000.0;
+  unsigned Nodes = getNumNodesCreated() - Active.StartNodes;
+  if (!Stack.empty()) {
+    Stack.back().NestedTime += Time;
+    Stack.back().NestedNodes += Nodes;
+    Stack.back().NumNested += Active.NumNested + 1;
+  }
+
+  double ExclusiveTime = Time - Active.NestedTime;
+  unsigned ExclusiveNodes = Nodes - Active.NestedNodes;
+
+  Stats &Spec = Specializations[Active.Specialization];
+  ++Spec.NumInstantiations;
+  Spec.InclusiveTime += Time;
+  Spec.ExclusiveTime += ExclusiveTime;
+  Spec.InclusiveNodes += Nodes;
+  Spec.ExclusiveNodes += ExclusiveNodes;
+
+  Stats &Template = Templates[Active.Template];
+  ++Template.NumInstantiations;
+  Template.ExclusiveTime += ExclusiveTime;
+  Template.ExclusiveNodes += ExclusiveNodes;
+
+  // Recursive instantiations of a template are already part of the inclusive
+  // cost of its outermost instantiation.
+  bool IsOutermost = true;
+  for (unsigned I = 0, N = Stack.size(); I != N; ++I)
+    if (Stack[I].Template == Active.Template) {
+      IsOutermost = false;
+      break;
+    }
+  if (IsOutermost) {
+    Template.InclusiveTime += Time;
+    Template.InclusiveNodes += Nodes;
+  }
+
+  ++Total.NumInstantiations;
+  Total.ExclusiveTime += ExclusiveTime;
+  Total.ExclusiveNodes += ExclusiveNodes;
+  if (!Stack.empty())
+    return;
+
+  // This instantiation was triggered by non-template code; attribute it and
+  // everything it triggered to that point.
+  Total.InclusiveTime += Time;
+  Total.InclusiveNodes += Nodes;
+
+  SourceLocation Loc = Active.PointOfInstantiation;
+  if (Loc.isValid())
+    Loc = Context.getSourceManager().getExpansionLoc(Loc);
+  Stats &Point = PointsOfInstantiation[Loc.getRawEncoding()];
+  Point.NumInstantiations += Active.NumNested + 1;
+  Point.InclusiveTime += Time;
+  Point.ExclusiveTime += ExclusiveTime;
+  Point.InclusiveNodes += Nodes;
+  Point.ExclusiveNodes += ExclusiveNodes;
+}
+
+void TemplateInstantiationProfile::noteSpecializationLookup(
+                                                        const Decl *Pattern,
+                                                        bool Found) {
+  Stats &Template = Templates[Pattern->getCanonicalDecl()];
+  ++Template.NumLookups;
+  ++Total.NumLookups;
+  if (Found) {
+    ++Template.NumReused;
+    ++Total.NumReused;
+  }
+}
+
+namespace {
+  typedef std::pair<const Stats *, std::string> NamedStats;
+
+  class StatsOrder {
+    TemplateInstantiationProfile::SortKey Key;
+
+    double getValue(const Stats &S) const {
+      switch (Key) {
+      case TemplateInstantiationProfile::SK_ExclusiveTime:
+        return S.ExclusiveTime;
+      case TemplateInstantiationProfile::SK_InclusiveTime:
+        return S.InclusiveTime;
+      case TemplateInstantiationProfile::SK_Count:
+        return S.NumInstantiations;
+      case TemplateInstantiationProfile::SK_Nodes:
+        return S.InclusiveNodes;
+      }
+      llvm_unreachable("Invalid sort key");
+    }
+
+  public:
+    explicit StatsOrder(TemplateInstantiationProfile::SortKey Key)
+      : Key(Key) { }
+
+    bool operator()(const NamedStats &LHS, const NamedStats &RHS) const {
+      double L = getValue(*LHS.first), R = getValue(*RHS.first);
+      if (L != R)
+        return L > R;
+      return LHS.second < RHS.second;
+    }
+  };
+}
+
+static void printTable(raw_ostream &OS, StringRef Title,
+                       std::vector<NamedStats> &Entries,
+                       TemplateInstantiationProfile::SortKey Key,
+                       unsigned Limit) {
+  std::sort(Entries.begin(), Entries.end(), StatsOrder(Key));
+
+  OS << '\n' << Title << " (" << Entries.size() << "):\n";
+  OS << "   Count  Lookups   Reused   Incl(s)   Excl(s)  InclNodes  ExclNodes"
+        "  Name\n";
+  unsigned N = Entries.size();
+  if (Limit && Limit < N)
+    N = Limit;
+  for (unsigned I = 0; I != N; ++I) {
+    const Stats &S = *Entries[I].first;
+    OS << llvm::format("%8u %8u %8u %9.4f %9.4f %10u %10u  ",
+                       S.NumInstantiations, S.NumLookups, S.NumReused,
+                       S.InclusiveTime, S.ExclusiveTime, S.InclusiveNodes,
+                       S.ExclusiveNodes)
+       << Entries[I].second << '\n';
+  }
+  if (N != Entries.size())
+    OS << "  ... " << (Entries.size() - N) << " more\n";
+}
+
+static std::string getName(const Decl *D, const PrintingPolicy &Policy) {
+  std::string Name;
+  if (const NamedDecl *ND = dyn_cast<NamedDecl>(D))
+    ND->getNameForDiagnostic(Name, Policy, /*Qualified=*/true);
+  if (Name.empty())
+    Name = std::string("(") + D->getDeclKindName() + ")";
+  return Name;
+}
+
+void TemplateInstantiationProfile::print(raw_ostream &OS, SortKey Key,
+                                         unsigned Limit) const {
+  const PrintingPolicy &Policy = Context.getPrintingPolicy();
+
+  OS << "*** Template Instantiation Profile:\n";
+  OS << "  " << Total.NumInstantiations << " definitions instantiated in "
+     << llvm::format("%.4f", Total.InclusiveTime) << "s, creating "
+     << Total.InclusiveNodes << " AST nodes.\n";
+  OS << "  " << Total.NumLookups << " specializations named, "
+     << Total.NumReused << " reused";
+  if (Total.NumLookups)
+    OS << " (" << Total.NumReused * 100 / Total.NumLookups << "%)";
+  OS << ".\n";
+
+  std::vector<NamedStats> Entries;
+  for (llvm::DenseMap<const Decl *, Stats>::const_iterator
+         I = Templates.begin(), E = Templates.end(); I != E; ++I)
+    Entries.push_back(NamedStats(&I->second, getName(I->first, Policy)));
+  printTable(OS, "Templates", Entries, Key, Limit);
+
+  Entries.clear();
+  for (llvm::DenseMap<const Decl *, Stats>::const_iterator
+         I = Specializations.begin(), E = Specializations.end(); I != E; ++I)
+    Entries.push_back(NamedStats(&I->second, getName(I->first, Policy)));
+  printTable(OS, "Specializations", Entries, Key, Limit);
+
+  Entries.clear();
+  SourceManager &SM = Context.getSourceManager();
+  for (llvm::DenseMap<unsigned, Stats>::const_iterator
+         I = PointsOfInstantiation.begin(), E = PointsOfInstantiation.end();
+       I != E; ++I) {
+    std::string Name;
+    llvm::raw_string_ostream NameOS(Name);
+    SourceLocation::getFromRawEncoding(I->first).print(NameOS, SM);
+    Entries.push_back(NamedStats(&I->second, NameOS.str()));
+  }
+  printTable(OS, "Points of instantiation", Entries, Key, Limit);
+}
@@ -15,6 +15,8 @@
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "llvm/ADT/StringExtras.h"
+#include <cstring>
+#include <vector>
 
 using namespace clang;
 
@@ -78,3 +80,156 @@ unsigned serialization::ComputeHash(Selector Sel) {
       R = llvm::HashString(II->getName(), R);
   return R;
 }
+
+//===----------------------------------------------------------------------===//
+// Source buffer compression
+//===----------------------------------------------------------------------===//
+//
+// Each sequence starts with a token byte whose high nibble is the literal run
+// length and whose low nibble is the match length minus MinMatch. A nibble
+// value of 15 means the length continues in following bytes, each adding up
+// to 255. The literals follow, then a 16-bit little-endian back-reference
+// offset. The final sequence carries literals only and ends the stream.
+
+namespace {
+  enum {
+    MinMatch = 4,
+    HashBits = 12,
+    MaxOffset = 0xFFFF
+  };
+}
+
+static inline uint32_t ReadLE32(const unsigned char *P) {
+  return uint32_t(P[0]) | (uint32_t(P[1]) << 8) | (uint32_t(P[2]) << 16) |
+         (uint32_t(P[3]) << 24);
+}
+
+static inline unsigned HashSequence(uint32_t Seq) {
+  return (Seq * 2654435761U) >> (32 - HashBits);
+}
+
+static void EmitExtendedLength(SmallVectorImpl<char> &Output, size_t Length) {
+  for (Length -= 15; Length >= 255; Length -= 255)
+    Output.push_back(char(255));
+  Output.push_back(char(Length));
+}
+
+static void EmitSequence(SmallVectorImpl<char> &Output,
+                         const unsigned char *Literals, size_t NumLiterals,
+                         size_t MatchLength, unsigned Offset) {
+  unsigned Token = (NumLiterals < 15 ? NumLiterals : 15) << 4;
+  if (MatchLength) {
+    size_t ExtraMatch = MatchLength - MinMatch;
+    Token |= ExtraMatch < 15 ? ExtraMatch : 15;
+  }
+  Output.push_back(char(Token));
+  if (NumLiterals >= 15)
+    EmitExtendedLength(Output, NumLiterals);
+  Output.append(Literals, Literals + NumLiterals);
+
+  if (!MatchLength)
+    return;
+
+  Output.push_back(char(Offset & 0xFF));
+  Output.push_back(char(Offset >> 8));
+  if (MatchLength - MinMatch >= 15)
+    EmitExtendedLength(Output, MatchLength - MinMatch);
+}
+
+void serialization::CompressSourceBuffer(StringRef Input,
+                                         SmallVectorImpl<char> &Output) {
+  const unsigned char *Begin
+    = reinterpret_cast<const unsigned char *>(Input.data());
+  const unsigned char *End = Begin + Input.size();
+  const unsigned char *Anchor = Begin;
+  const unsigned char *Cur = Begin;
+
+  if (Input.size() >= MinMatch) {
+    std::vector<const unsigned char *> Table(1 << HashBits);
+    const unsigned char *Limit = End - MinMatch;
+    while (Cur <= Limit) {
+      uint32_t Seq = ReadLE32(Cur);
+      const unsigned char *&Slot = Table[HashSequence(Seq)];
+      const unsigned char *Candidate = Slot;
+      Slot = Cur;
+      if (!Candidate || Cur - Candidate > MaxOffset ||
+          ReadLE32(Candidate) != Seq) {
+        ++Cur;
+        continue;
+      }
+
+      size_t Length = MinMatch;
+      while (Cur + Length != End && Candidate[Length] == Cur[Length])
+        ++Length;
+
+      EmitSequence(Output, Anchor, Cur - Anchor, Length, Cur - Candidate);
+      Cur += Length;
+      Anchor = Cur;
+    }
+  }
+
+  EmitSequence(Output, Anchor, End - Anchor, 0, 0);
+}
+
+/// \brief Read the continuation bytes of a length whose nibble was 15.
+///
+/// \returns true if the input ended prematurely.
+static bool ReadExtendedLength(const unsigned char *&Cur,
+                               const unsigned char *End, size_t &Length) {
+  unsigned char Byte;
+  do {
+    if (Cur == End)
+      return true;
+    Byte = *Cur++;
+    Length += Byte;
+  } while (Byte == 255);
+  return false;
+}
+
+bool serialization::DecompressSourceBuffer(StringRef Input, char *Output,
+                                           size_t OutputSize) {
+  const unsigned char *Cur
+    = reinterpret_cast<const unsigned char *>(Input.data());
+  const unsigned char *End = Cur + Input.size();
+  char *Out = Output;
+  char *OutEnd = Output + OutputSize;
+
+  while (Cur != End) {
+    unsigned Token = *Cur++;
+
+    size_t NumLiterals = Token >> 4;
+    if (NumLiterals == 15 && ReadExtendedLength(Cur, End, NumLiterals))
+      return true;
+    if (size_t(End - Cur) < NumLiterals || size_t(OutEnd - Out) < NumLiterals)
+      return true;
+    std::memcpy(Out, Cur, NumLiterals);
+    Out += NumLiterals;
+    Cur += NumLiterals;
+
+    // The last sequence has no match part.
+    if (Cur == End)
+      break;
+
+    if (End - Cur < 2)
+      return true;
+    size_t Offset = size_t(Cur[0]) | (size_t(Cur[1]) << 8);
+    Cur += 2;
+
+    size_t MatchLength = Token & 0xF;
+    if (MatchLength == 15 && ReadExtendedLength(Cur, End, MatchLength))
+      return true;
+    MatchLength += MinMatch;
+
+    if (Offset == 0 || Offset > size_t(Out - Output) ||
+        size_t(OutEnd - Out) < MatchLength)
+      return true;
+
+    // Matches may overlap the bytes they produce, so copy forward one byte at
+    // a time.
+    const char *From = Out - Offset;
+    for (size_t I = 0; I != MatchLength; ++I)
+      *Out++ = *From++;
+  }
+
+  return Out != OutEnd;
+}
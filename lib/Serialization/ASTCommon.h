@@ -16,6 +16,8 @@
 
 #include "clang/Serialization/ASTBitCodes.h"
 #include "clang/AST/ASTContext.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 
 namespace clang {
 
@@ -58,6 +60,22 @@ TypeID MakeTypeID(ASTContext &Context, QualType T, IdxForTypeTy IdxForType) {
 
 unsigned ComputeHash(Selector Sel);
 
+/// \brief Compress the contents of a source buffer for storage in a
+/// SM_SLOC_BUFFER_BLOB_COMPRESSED record.
+///
+/// The encoding is a small LZ77 block format (literal runs interleaved with
+/// back-references of up to 64k), chosen because it decodes with a single
+/// pass and no auxiliary state. The compressed bytes are appended to
+/// \p Output.
+void CompressSourceBuffer(StringRef Input, SmallVectorImpl<char> &Output);
+
+/// \brief Decompress a buffer produced by \c CompressSourceBuffer into
+/// \p Output, which must have room for exactly \p OutputSize bytes.
+///
+/// \returns true if the compressed data is malformed or does not expand to
+/// exactly \p OutputSize bytes.
+bool DecompressSourceBuffer(StringRef Input, char *Output, size_t OutputSize);
+
 } // namespace serialization
 
 } // namespace clang
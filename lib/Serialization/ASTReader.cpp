@@ -34,6 +34,7 @@
 #include "clang/Basic/OnDiskHashTable.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/SourceManagerInternals.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/TargetInfo.h"
@@ -43,9 +44,11 @@
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/system_error.h"
 #include <algorithm>
 #include <iterator>
@@ -1134,7 +1137,7 @@ ASTReader::ASTReadResult ASTReader::ReadSLocEntryRecord(int ID) {
                                         ID, BaseOffset + Record[0]);
     SrcMgr::FileInfo &FileInfo =
           const_cast<SrcMgr::FileInfo&>(SourceMgr.getSLocEntry(FID).getFile());
-    FileInfo.NumCreatedFIDs = Record[7];
+    SourceMgr.setNumCreatedFIDsForFileID(FID, Record[7]);
     if (Record[3])
       FileInfo.setHasLineDirectives();
 
@@ -1151,19 +1154,10 @@ ASTReader::ASTReadResult ASTReader::ReadSLocEntryRecord(int ID) {
                               /*isSystemFile=*/FileCharacter != SrcMgr::C_User);
     if (OverriddenBuffer && !ContentCache->BufferOverridden &&
         ContentCache->ContentsEntry == ContentCache->OrigEntry) {
-      unsigned Code = SLocEntryCursor.ReadCode();
-      Record.clear();
-      unsigned RecCode
-        = SLocEntryCursor.ReadRecord(Code, Record, &BlobStart, &BlobLen);
-      
-      if (RecCode != SM_SLOC_BUFFER_BLOB) {
-        Error("AST record has invalid code");
+      llvm::MemoryBuffer *Buffer = ReadSLocBufferBlob(SLocEntryCursor,
+                                                      Filename);
+      if (!Buffer)
         return Failure;
-      }
-      
-      llvm::MemoryBuffer *Buffer
-        = llvm::MemoryBuffer::getMemBuffer(StringRef(BlobStart, BlobLen - 1),
-                                           Filename);
       SourceMgr.overrideFileContents(File, Buffer);
     }
 
@@ -1175,26 +1169,16 @@ ASTReader::ASTReadResult ASTReader::ReadSLocEntryRecord(int ID) {
   case SM_SLOC_BUFFER_ENTRY: {
     const char *Name = BlobStart;
     unsigned Offset = Record[0];
-    unsigned Code = SLocEntryCursor.ReadCode();
-    Record.clear();
-    unsigned RecCode
-      = SLocEntryCursor.ReadRecord(Code, Record, &BlobStart, &BlobLen);
-
-    if (RecCode != SM_SLOC_BUFFER_BLOB) {
-      Error("AST record has invalid code");
+    llvm::MemoryBuffer *Buffer = ReadSLocBufferBlob(SLocEntryCursor, Name);
+    if (!Buffer)
       return Failure;
-    }
-
-    llvm::MemoryBuffer *Buffer
-      = llvm::MemoryBuffer::getMemBuffer(StringRef(BlobStart, BlobLen - 1),
-                                         Name);
     FileID BufferID = SourceMgr.createFileIDForMemBuffer(Buffer, ID,
                                                          BaseOffset + Offset);
 
     if (strcmp(Name, "<built-in>") == 0 && F->Kind == MK_PCH) {
       PCHPredefinesBlock Block = {
         BufferID,
-        StringRef(BlobStart, BlobLen - 1)
+        Buffer->getBuffer()
       };
       PCHPredefinesBuffers.push_back(Block);
     }
@@ -1217,6 +1201,56 @@ ASTReader::ASTReadResult ASTReader::ReadSLocEntryRecord(int ID) {
   return Success;
 }
 
+/// \brief Read the blob record that holds the contents of a buffer, which
+/// directly follows the SLocEntry record describing it.
+///
+/// Plain blobs are referenced in place within the AST file. Compressed blobs
+/// are expanded into a freshly-allocated buffer; since source location
+/// entries are themselves only loaded when the source manager asks for them,
+/// this happens the first time the buffer is needed.
+///
+/// \returns the buffer, or NULL if an error occurred.
+llvm::MemoryBuffer *
+ASTReader::ReadSLocBufferBlob(llvm::BitstreamCursor &SLocEntryCursor,
+                              StringRef Name) {
+  RecordData Record;
+  const char *BlobStart;
+  unsigned BlobLen;
+  unsigned Code = SLocEntryCursor.ReadCode();
+  unsigned RecCode
+    = SLocEntryCursor.ReadRecord(Code, Record, &BlobStart, &BlobLen);
+
+  if (RecCode == SM_SLOC_BUFFER_BLOB)
+    return llvm::MemoryBuffer::getMemBuffer(StringRef(BlobStart, BlobLen - 1),
+                                            Name);
+
+  if (RecCode != SM_SLOC_BUFFER_BLOB_COMPRESSED || Record.empty()) {
+    Error("AST record has invalid code");
+    return 0;
+  }
+
+  llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
+  size_t Size = Record[0];
+  llvm::MemoryBuffer *Buffer
+    = llvm::MemoryBuffer::getNewUninitMemBuffer(Size, Name);
+  if (!Buffer ||
+      DecompressSourceBuffer(StringRef(BlobStart, BlobLen),
+                             const_cast<char *>(Buffer->getBufferStart()),
+                             Size)) {
+    delete Buffer;
+    Error("malformed compressed source buffer in AST file");
+    return 0;
+  }
+
+  ++NumSourceBuffersDecompressed;
+  CompressedSourceBufferBytes += BlobLen;
+  DecompressedSourceBufferBytes += Size;
+  SourceBufferDecompressionTime
+    += llvm::TimeRecord::getCurrentTime().getWallTime()
+         - StartTime.getWallTime();
+  return Buffer;
+}
+
 /// \brief Find the location where the module F is imported.
 SourceLocation ASTReader::getImportLocation(ModuleFile *F) {
   if (F->ImportLoc.isValid())
@@ -1460,6 +1494,7 @@ void ASTReader::setIdentifierIsMacro(IdentifierInfo *II, ModuleFile &F,
   if (Visible) {
     // Note that this identifier has a macro definition.
     II->setHasMacroDefinition(true);
+    PP.markMacroDefinitionsChanged();
   }
   
   // Adjust the offset to a global offset.
@@ -2563,6 +2598,7 @@ void ASTReader::makeNamesVisible(const HiddenNames &Names) {
         if (Known == PP.Macros.end() ||
             Known->second->getUndefLoc().isInvalid()) {
           II->setHasMacroDefinition(true);
+          PP.markMacroDefinitionsChanged();
           if (DeserializationListener)
             DeserializationListener->MacroVisible(II);
         }
@@ -2671,6 +2707,8 @@ void ASTReader::makeModuleVisible(Module *Mod,
 
 ASTReader::ASTReadResult ASTReader::ReadAST(const std::string &FileName,
                                             ModuleKind Type) {
+  TimeTraceScope TimeScope("ReadAST", FileName);
+
   // Bump the generation number.
   unsigned PreviousGeneration = CurrentGeneration++;
   
@@ -3749,12 +3787,16 @@ QualType ASTReader::readTypeRecord(unsigned Index) {
 
   // Note that we are loading a type record.
   Deserializing AType(this);
+  ProfileTimer Timer(*this, Loc.F->TypeReadTime);
 
   unsigned Idx = 0;
   DeclsCursor.JumpToBit(Loc.Offset);
   RecordData Record;
   unsigned Code = DeclsCursor.ReadCode();
-  switch ((TypeCode)DeclsCursor.ReadRecord(Code, Record)) {
+  unsigned RecCode = DeclsCursor.ReadRecord(Code, Record);
+  ++Loc.F->NumTypesRead;
+  Loc.F->TypeBitsRead += DeclsCursor.GetCurrentBitNo() - Loc.Offset;
+  switch ((TypeCode)RecCode) {
   case TYPE_EXT_QUAL: {
     if (Record.size() != 2) {
       Error("Incorrect encoding of extended qualifier type");
@@ -4942,6 +4984,9 @@ namespace {
       if (Pos == LookupTable->end())
         return false;
 
+      if (This->Reader.ProfileDeserialization)
+        ++M.LookupTriggers[This->Name.getAsString()];
+
       bool FoundAnything = false;
       ASTDeclContextNameLookupTrait::data_type Data = *Pos;
       for (; Data.first != Data.second; ++Data.first) {
@@ -5163,6 +5208,15 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u source location entries read (%f%%)\n",
                  NumSLocEntriesRead, TotalNumSLocEntries,
                  ((float)NumSLocEntriesRead/TotalNumSLocEntries * 100));
+  if (NumSourceBuffersDecompressed) {
+    std::fprintf(stderr, "  %u compressed source buffers expanded "
+                         "(%llu -> %llu bytes)\n",
+                 NumSourceBuffersDecompressed,
+                 (unsigned long long)CompressedSourceBufferBytes,
+                 (unsigned long long)DecompressedSourceBufferBytes);
+    std::fprintf(stderr, "  %f seconds decompressing source buffers\n",
+                 SourceBufferDecompressionTime);
+  }
   if (!TypesLoaded.empty())
     std::fprintf(stderr, "  %u/%u types read (%f%%)\n",
                  NumTypesLoaded, (unsigned)TypesLoaded.size(),
@@ -5226,6 +5280,126 @@ dumpModuleIDMap(StringRef Name,
   }
 }
 
+ASTReader::ProfileTimer::ProfileTimer(ASTReader &Reader, double &Counter)
+  : Reader(Reader), Counter(0), StartTime(0), NestedTime(0), Parent(0) {
+  if (!Reader.ProfileDeserialization)
+    return;
+
+  this->Counter = &Counter;
+  Parent = Reader.CurrentProfileTimer;
+  Reader.CurrentProfileTimer = this;
+  StartTime = llvm::TimeRecord::getCurrentTime().getWallTime();
+}
+
+ASTReader::ProfileTimer::~ProfileTimer() {
+  if (!Counter)
+    return;
+
+  double Elapsed = llvm::TimeRecord::getCurrentTime().getWallTime()
+                     - StartTime;
+  *Counter += Elapsed - NestedTime;
+  if (Parent)
+    Parent->NestedTime += Elapsed;
+  Reader.CurrentProfileTimer = Parent;
+}
+
+/// \brief Write \p Str as a JSON string literal.
+static void printJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (StringRef::iterator I = Str.begin(), E = Str.end(); I != E; ++I) {
+    unsigned char C = *I;
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << "\\u00" << llvm::hexdigit(C >> 4, /*LowerCase=*/true)
+           << llvm::hexdigit(C & 0xF, /*LowerCase=*/true);
+      else
+        OS << C;
+      break;
+    }
+  }
+  OS << '"';
+}
+
+static void printJSONCounts(raw_ostream &OS, const char *Name,
+                            unsigned Loaded, unsigned Available) {
+  OS << "      \"" << Name << "\": { \"loaded\": " << Loaded
+     << ", \"available\": " << Available << " },\n";
+}
+
+namespace {
+  typedef std::pair<unsigned, StringRef> LookupTrigger;
+
+  /// \brief Orders lookup triggers by decreasing count, then by name.
+  struct MoreFrequentTrigger {
+    bool operator()(const LookupTrigger &X, const LookupTrigger &Y) const {
+      if (X.first != Y.first)
+        return X.first > Y.first;
+      return X.second < Y.second;
+    }
+  };
+}
+
+void ASTReader::PrintDeserializationProfile(raw_ostream &OS) {
+  // The number of lookup triggers to report for each module file.
+  const unsigned MaxTriggers = 20;
+
+  OS << "{\n  \"modules\": [";
+  bool First = true;
+  for (ModuleManager::ModuleConstIterator I = ModuleMgr.begin(),
+                                          E = ModuleMgr.end();
+       I != E; ++I) {
+    const ModuleFile &M = **I;
+    OS << (First ? "\n" : ",\n") << "    {\n      \"file\": ";
+    First = false;
+    printJSONString(OS, M.FileName);
+    OS << ",\n      \"kind\": \"";
+    switch (M.Kind) {
+    case MK_Module:   OS << "module"; break;
+    case MK_PCH:      OS << "pch"; break;
+    case MK_Preamble: OS << "preamble"; break;
+    case MK_MainFile: OS << "main-file"; break;
+    }
+    OS << "\",\n"
+       << "      \"size_bytes\": " << M.SizeInBits / 8 << ",\n";
+
+    printJSONCounts(OS, "decls", M.NumDeclsRead, M.LocalNumDecls);
+    printJSONCounts(OS, "types", M.NumTypesRead, M.LocalNumTypes);
+    printJSONCounts(OS, "identifiers", M.NumIdentifiersRead,
+                    M.LocalNumIdentifiers);
+    printJSONCounts(OS, "selectors", M.NumSelectorsRead, M.LocalNumSelectors);
+
+    OS << "      \"decl_bytes_read\": " << (M.DeclBitsRead + 7) / 8 << ",\n"
+       << "      \"type_bytes_read\": " << (M.TypeBitsRead + 7) / 8 << ",\n"
+       << "      \"decl_read_seconds\": "
+       << llvm::format("%f", M.DeclReadTime) << ",\n"
+       << "      \"type_read_seconds\": "
+       << llvm::format("%f", M.TypeReadTime) << ",\n";
+
+    SmallVector<LookupTrigger, 32> Triggers;
+    for (llvm::StringMap<unsigned>::const_iterator
+           T = M.LookupTriggers.begin(), TEnd = M.LookupTriggers.end();
+         T != TEnd; ++T)
+      Triggers.push_back(LookupTrigger(T->second, T->first()));
+    std::sort(Triggers.begin(), Triggers.end(), MoreFrequentTrigger());
+    if (Triggers.size() > MaxTriggers)
+      Triggers.resize(MaxTriggers);
+
+    OS << "      \"lookup_triggers\": [";
+    for (unsigned T = 0, N = Triggers.size(); T != N; ++T) {
+      OS << (T ? ",\n" : "\n") << "        { \"name\": ";
+      printJSONString(OS, Triggers[T].second);
+      OS << ", \"count\": " << Triggers[T].first << " }";
+    }
+    OS << (Triggers.empty() ? "]\n" : "\n      ]\n") << "    }";
+  }
+  OS << (First ? "]\n" : "\n  ]\n") << "}\n";
+}
+
 void ASTReader::dump() {
   llvm::errs() << "*** PCH/ModuleFile Remappings:\n";
   dumpModuleIDMap("Global bit offset map", GlobalBitOffsetsMap);
@@ -5404,6 +5578,17 @@ namespace clang { namespace serialization {
       // Also, should entries without methods count as misses?
       ++This->Reader.NumMethodPoolEntriesRead;
       ASTSelectorLookupTrait::data_type Data = *Pos;
+
+      // Remember the selector so that it is only read once, and count it
+      // against the module file that owns it.
+      if (Data.ID && Data.ID <= This->Reader.SelectorsLoaded.size() &&
+          !This->Reader.SelectorsLoaded[Data.ID - 1].getAsOpaquePtr()) {
+        This->Reader.SelectorsLoaded[Data.ID - 1] = This->Sel;
+        ASTReader::GlobalSelectorMapType::iterator I
+          = This->Reader.GlobalSelectorMap.find(Data.ID);
+        if (I != This->Reader.GlobalSelectorMap.end())
+          ++I->second->NumSelectorsRead;
+      }
       if (This->Reader.DeserializationListener)
         This->Reader.DeserializationListener->SelectorRead(Data.ID, 
                                                            This->Sel);
@@ -5603,6 +5788,11 @@ void ASTReader::LoadSelector(Selector Sel) {
 void ASTReader::SetIdentifierInfo(IdentifierID ID, IdentifierInfo *II) {
   assert(ID && "Non-zero identifier ID required");
   assert(ID <= IdentifiersLoaded.size() && "identifier ID out of range");
+  if (!IdentifiersLoaded[ID - 1]) {
+    GlobalIdentifierMapType::iterator I = GlobalIdentifierMap.find(ID);
+    if (I != GlobalIdentifierMap.end())
+      ++I->second->NumIdentifiersRead;
+  }
   IdentifiersLoaded[ID - 1] = II;
   if (DeserializationListener)
     DeserializationListener->IdentifierRead(ID, II);
@@ -5679,6 +5869,7 @@ IdentifierInfo *ASTReader::DecodeIdentifierInfo(IdentifierID ID) {
                        | (((unsigned) StrLenPtr[1]) << 8)) - 1;
     IdentifiersLoaded[ID]
       = &PP.getIdentifierTable().get(StringRef(Str, StrLen));
+    ++M->NumIdentifiersRead;
     if (DeserializationListener)
       DeserializationListener->IdentifierRead(ID + 1, IdentifiersLoaded[ID]);
   }
@@ -5755,6 +5946,7 @@ Selector ASTReader::DecodeSelector(serialization::SelectorID ID) {
     unsigned Idx = ID - M.BaseSelectorID - NUM_PREDEF_SELECTOR_IDS;
     SelectorsLoaded[ID - 1] =
       Trait.ReadKey(M.SelectorLookupTableData + M.SelectorOffsets[Idx], 0);
+    ++M.NumSelectorsRead;
     if (DeserializationListener)
       DeserializationListener->SelectorRead(ID, SelectorsLoaded[ID - 1]);
   }
@@ -6476,9 +6668,12 @@ ASTReader::ASTReader(Preprocessor &PP, ASTContext &Context,
     DisableValidation(DisableValidation),
     DisableStatCache(DisableStatCache),
     AllowASTWithCompilerErrors(AllowASTWithCompilerErrors), 
-    CurrentGeneration(0), CurrSwitchCaseStmts(&SwitchCaseStmts),
+    ProfileDeserialization(false), CurrentGeneration(0),
+    CurrSwitchCaseStmts(&SwitchCaseStmts),
     NumStatHits(0), NumStatMisses(0), 
     NumSLocEntriesRead(0), TotalNumSLocEntries(0), 
+    NumSourceBuffersDecompressed(0), CompressedSourceBufferBytes(0),
+    DecompressedSourceBufferBytes(0), SourceBufferDecompressionTime(0),
     NumStatementsRead(0), TotalNumStatements(0), NumMacrosRead(0), 
     TotalNumMacros(0), NumSelectorsRead(0), NumMethodPoolEntriesRead(0), 
     NumMethodPoolMisses(0), TotalNumMethodPoolEntries(0), 
@@ -6486,7 +6681,7 @@ ASTReader::ASTReader(Preprocessor &PP, ASTContext &Context,
     NumVisibleDeclContextsRead(0), TotalVisibleDeclContexts(0),
     TotalModulesSizeInBits(0), NumCurrentElementsDeserializing(0),
     PassingDeclsToConsumer(false),
-    NumCXXBaseSpecifiersLoaded(0)
+    NumCXXBaseSpecifiersLoaded(0), CurrentProfileTimer(0)
 {
   SourceMgr.setExternalSLocEntrySource(this);
 }
@@ -1907,6 +1907,7 @@ Decl *ASTReader::ReadDeclRecord(DeclID ID) {
 
   // Note that we are loading a declaration record.
   Deserializing ADecl(this);
+  ProfileTimer Timer(*this, Loc.F->DeclReadTime);
 
   DeclsCursor.JumpToBit(Loc.Offset);
   RecordData Record;
@@ -1914,8 +1915,12 @@ Decl *ASTReader::ReadDeclRecord(DeclID ID) {
   unsigned Idx = 0;
   ASTDeclReader Reader(*this, *Loc.F, ID, RawLocation, Record,Idx);
 
+  unsigned RecCode = DeclsCursor.ReadRecord(Code, Record);
+  ++Loc.F->NumDeclsRead;
+  Loc.F->DeclBitsRead += DeclsCursor.GetCurrentBitNo() - Loc.Offset;
+
   Decl *D = 0;
-  switch ((DeclCode)DeclsCursor.ReadRecord(Code, Record)) {
+  switch ((DeclCode)RecCode) {
   case DECL_CONTEXT_LEXICAL:
   case DECL_CONTEXT_VISIBLE:
     llvm_unreachable("Record cannot be de-serialized with ReadDeclRecord");
@@ -44,6 +44,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Timer.h"
 #include <algorithm>
 #include <cstdio>
 #include <string.h>
@@ -825,6 +826,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(SM_SLOC_BUFFER_ENTRY);
   RECORD(SM_SLOC_BUFFER_BLOB);
   RECORD(SM_SLOC_EXPANSION_ENTRY);
+  RECORD(SM_SLOC_BUFFER_BLOB_COMPRESSED);
 
   // Preprocessor Block.
   BLOCK(PREPROCESSOR_BLOCK);
@@ -1229,6 +1231,18 @@ static unsigned CreateSLocBufferBlobAbbrev(llvm::BitstreamWriter &Stream) {
   return Stream.EmitAbbrev(Abbrev);
 }
 
+/// \brief Create an abbreviation for the SLocEntry that refers to a
+/// buffer's compressed blob.
+static unsigned CreateSLocBufferBlobCompressedAbbrev(
+                                             llvm::BitstreamWriter &Stream) {
+  using namespace llvm;
+  BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(SM_SLOC_BUFFER_BLOB_COMPRESSED));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 32)); // Uncompressed size
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // Compressed blob
+  return Stream.EmitAbbrev(Abbrev);
+}
+
 /// \brief Create an abbreviation for the SLocEntry that refers to a macro
 /// expansion.
 static unsigned CreateSLocExpansionAbbrev(llvm::BitstreamWriter &Stream) {
@@ -1401,6 +1415,47 @@ void ASTWriter::WriteHeaderSearch(const HeaderSearch &HS, StringRef isysroot) {
     free((void*)SavedStrings[I]);
 }
 
+/// \brief Write the blob record holding the contents of \p Buffer, which
+/// directly follows its SLocEntry record.
+///
+/// When source buffer compression is enabled the contents are stored in a
+/// SM_SLOC_BUFFER_BLOB_COMPRESSED record, unless compression does not make
+/// the blob any smaller, in which case we fall back to the plain encoding.
+void ASTWriter::WriteSourceBufferBlob(unsigned Abbrev,
+                                      unsigned CompressedAbbrev,
+                                      const llvm::MemoryBuffer *Buffer) {
+  StringRef Contents(Buffer->getBufferStart(), Buffer->getBufferSize());
+  ++NumSourceBufferBlobs;
+  SourceBufferBytes += Contents.size() + 1;
+
+  RecordData Record;
+  if (CompressSourceBuffers) {
+    llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
+    SmallString<0> Compressed;
+    serialization::CompressSourceBuffer(Contents, Compressed);
+    SourceBufferCompressionTime
+      += llvm::TimeRecord::getCurrentTime().getWallTime()
+           - StartTime.getWallTime();
+
+    if (Compressed.size() < Contents.size()) {
+      ++NumCompressedSourceBufferBlobs;
+      SourceBufferBytesWritten += Compressed.size();
+      Record.push_back(SM_SLOC_BUFFER_BLOB_COMPRESSED);
+      Record.push_back(Contents.size());
+      Stream.EmitRecordWithBlob(CompressedAbbrev, Record, Compressed.str());
+      return;
+    }
+  }
+
+  // We add one to the size so that we capture the trailing NULL
+  // that is required by llvm::MemoryBuffer::getMemBuffer (on
+  // the reader side).
+  SourceBufferBytesWritten += Contents.size() + 1;
+  Record.push_back(SM_SLOC_BUFFER_BLOB);
+  Stream.EmitRecordWithBlob(Abbrev, Record,
+                            StringRef(Contents.data(), Contents.size() + 1));
+}
+
 /// \brief Writes the block containing the serialized form of the
 /// source manager.
 ///
@@ -1421,6 +1476,8 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
   unsigned SLocFileAbbrv = CreateSLocFileAbbrev(Stream);
   unsigned SLocBufferAbbrv = CreateSLocBufferAbbrev(Stream);
   unsigned SLocBufferBlobAbbrv = CreateSLocBufferBlobAbbrev(Stream);
+  unsigned SLocBufferBlobCompressedAbbrv
+    = CreateSLocBufferBlobCompressedAbbrev(Stream);
   unsigned SLocExpansionAbbrv = CreateSLocExpansionAbbrev(Stream);
 
   // Write out the source location entry table. We skip the first
@@ -1473,7 +1530,7 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
         Record.push_back(Content->OrigEntry->getSize());
         Record.push_back(Content->OrigEntry->getModificationTime());
         Record.push_back(Content->BufferOverridden);
-        Record.push_back(File.NumCreatedFIDs);
+        Record.push_back(SourceMgr.getNumCreatedFIDsForFileID(FileID::get(I)));
         
         FileDeclIDsTy::iterator FDI = FileDeclIDs.find(SLoc);
         if (FDI != FileDeclIDs.end()) {
@@ -1501,31 +1558,21 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
         Stream.EmitRecordWithBlob(SLocFileAbbrv, Record, Filename);
         
         if (Content->BufferOverridden) {
-          Record.clear();
-          Record.push_back(SM_SLOC_BUFFER_BLOB);
           const llvm::MemoryBuffer *Buffer
             = Content->getBuffer(PP.getDiagnostics(), PP.getSourceManager());
-          Stream.EmitRecordWithBlob(SLocBufferBlobAbbrv, Record,
-                                    StringRef(Buffer->getBufferStart(),
-                                              Buffer->getBufferSize() + 1));          
+          WriteSourceBufferBlob(SLocBufferBlobAbbrv,
+                                SLocBufferBlobCompressedAbbrv, Buffer);
         }
       } else {
         // The source location entry is a buffer. The blob associated
         // with this entry contains the contents of the buffer.
-
-        // We add one to the size so that we capture the trailing NULL
-        // that is required by llvm::MemoryBuffer::getMemBuffer (on
-        // the reader side).
         const llvm::MemoryBuffer *Buffer
           = Content->getBuffer(PP.getDiagnostics(), PP.getSourceManager());
         const char *Name = Buffer->getBufferIdentifier();
         Stream.EmitRecordWithBlob(SLocBufferAbbrv, Record,
                                   StringRef(Name, strlen(Name) + 1));
-        Record.clear();
-        Record.push_back(SM_SLOC_BUFFER_BLOB);
-        Stream.EmitRecordWithBlob(SLocBufferBlobAbbrv, Record,
-                                  StringRef(Buffer->getBufferStart(),
-                                                  Buffer->getBufferSize() + 1));
+        WriteSourceBufferBlob(SLocBufferBlobAbbrv,
+                              SLocBufferBlobCompressedAbbrv, Buffer);
 
         if (strcmp(Name, "<built-in>") == 0) {
           PreloadSLocs.push_back(SLocEntryOffsets.size());
@@ -3170,7 +3217,10 @@ ASTWriter::ASTWriter(llvm::BitstreamWriter &Stream)
     FirstSelectorID(NUM_PREDEF_SELECTOR_IDS), NextSelectorID(FirstSelectorID),
     CollectedStmts(&StmtsToEmit),
     NumStatements(0), NumMacros(0), NumLexicalDeclContexts(0),
-    NumVisibleDeclContexts(0),
+    NumVisibleDeclContexts(0), CompressSourceBuffers(false),
+    NumSourceBufferBlobs(0), NumCompressedSourceBufferBlobs(0),
+    SourceBufferBytes(0), SourceBufferBytesWritten(0),
+    SourceBufferCompressionTime(0),
     NextCXXBaseSpecifiersID(1),
     DeclParmVarAbbrev(0), DeclContextLexicalAbbrev(0),
     DeclContextVisibleLookupAbbrev(0), UpdateVisibleAbbrev(0),
@@ -3188,6 +3238,23 @@ ASTWriter::~ASTWriter() {
     delete I->second;
 }
 
+void ASTWriter::PrintStats() {
+  std::fprintf(stderr, "*** AST File Writer Statistics:\n");
+  std::fprintf(stderr, "  %u statements written\n", NumStatements);
+  std::fprintf(stderr, "  %u macros written\n", NumMacros);
+  std::fprintf(stderr, "  %u/%u source buffer blobs compressed\n",
+               NumCompressedSourceBufferBlobs, NumSourceBufferBlobs);
+  if (SourceBufferBytes)
+    std::fprintf(stderr, "  %llu/%llu source buffer bytes written (%f%%)\n",
+                 (unsigned long long)SourceBufferBytesWritten,
+                 (unsigned long long)SourceBufferBytes,
+                 ((float)SourceBufferBytesWritten/SourceBufferBytes * 100));
+  if (CompressSourceBuffers)
+    std::fprintf(stderr, "  %f seconds compressing source buffers\n",
+                 SourceBufferCompressionTime);
+  std::fprintf(stderr, "\n");
+}
+
 void ASTWriter::WriteAST(Sema &SemaRef, MemorizeStatCalls *StatCalls,
                          const std::string &OutputFile,
                          Module *WritingModule, StringRef isysroot,
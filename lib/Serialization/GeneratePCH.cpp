@@ -32,7 +32,8 @@ PCHGenerator::PCHGenerator(const Preprocessor &PP,
                            raw_ostream *OS)
   : PP(PP), OutputFile(OutputFile), Module(Module), 
     isysroot(isysroot.str()), Out(OS), 
-    SemaPtr(0), StatCalls(0), Stream(Buffer), Writer(Stream) {
+    SemaPtr(0), StatCalls(0), ShowStats(false), Stream(Buffer),
+    Writer(Stream) {
   // Install a stat() listener to keep track of all of the stat()
   // calls.
   StatCalls = new MemorizeStatCalls();
@@ -49,6 +50,8 @@ void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
   // Emit the PCH file
   assert(SemaPtr && "No Sema?");
   Writer.WriteAST(*SemaPtr, StatCalls, OutputFile, Module, isysroot);
+  if (ShowStats)
+    Writer.PrintStats();
 
   // Write the generated bitstream to "Out".
   Out->write((char *)&Buffer.front(), Buffer.size());
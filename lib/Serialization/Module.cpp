@@ -37,7 +37,10 @@ ModuleFile::ModuleFile(ModuleKind Kind, unsigned Generation)
     LocalNumCXXBaseSpecifiers(0), CXXBaseSpecifiersOffsets(0),
     FileSortedDecls(0), RedeclarationsMap(0), LocalNumRedeclarationsInMap(0),
     ObjCCategoriesMap(0), LocalNumObjCCategoriesInMap(0),
-    LocalNumTypes(0), TypeOffsets(0), BaseTypeIndex(0), StatCache(0)
+    LocalNumTypes(0), TypeOffsets(0), BaseTypeIndex(0), StatCache(0),
+    NumDeclsRead(0), NumTypesRead(0), NumIdentifiersRead(0),
+    NumSelectorsRead(0), DeclBitsRead(0), TypeBitsRead(0), DeclReadTime(0),
+    TypeReadTime(0)
 {}
 
 ModuleFile::~ModuleFile() {
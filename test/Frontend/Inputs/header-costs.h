@@ -0,0 +1,11 @@
+#ifndef HEADER_COSTS_H
+#define HEADER_COSTS_H
+
+struct A {
+  int x;
+  int y;
+};
+
+int f(int);
+
+#endif
@@ -0,0 +1,4 @@
+template <typename T> struct S {
+  T Value;
+  T get() const { return Value; }
+};
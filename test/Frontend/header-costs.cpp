@@ -0,0 +1,13 @@
+// RUN: %clang_cc1 -print-header-costs %s | FileCheck %s
+
+#include "Inputs/header-costs.h"
+#include "Inputs/header-costs.h"
+
+int g() { return f(0); }
+
+// CHECK: *** Header Costs (1 translation unit, 1 headers):
+// CHECK: Incl(s)   Excl(s)  Parse(s)   Inst(s)    TUs   #incl  #lexed
+// The header is included twice, but lexed only once; it declares A, A::x,
+// A::y and f.
+// CHECK: {{ +}}1{{ +}}2{{ +}}1{{ +[0-9]+ +[0-9]+ +}}4  {{.*}}header-costs.h
+// CHECK-NOT: header-costs.cpp
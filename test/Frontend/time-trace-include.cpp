@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -fsyntax-only -ftime-trace=%t.json -ftime-trace-granularity=0 %s
+// RUN: FileCheck %s < %t.json
+
+// The #include is entered while the parser looks past the end of 'x', and
+// left while it parses 'S', so it must not disturb the events of the parser.
+int x;
+#include "Inputs/time-trace.h"
+_Pragma("GCC diagnostic ignored \"-Wunused-variable\"")
+int y;
+
+// CHECK: {"traceEvents":[
+// CHECK-DAG: "tid":0,"ph":"X",{{.*}}"name":"ParseTopLevelDecl","args":{"detail":"x"}
+// CHECK-DAG: "tid":0,"ph":"X",{{.*}}"name":"ParseTopLevelDecl","args":{"detail":"S"}
+// CHECK-DAG: "tid":0,"ph":"X",{{.*}}"name":"ParseTopLevelDecl","args":{"detail":"y"}
+// CHECK-DAG: "tid":1,"ph":"X",{{.*}}"name":"Include","args":{"detail":"{{.*}}time-trace.h"}
+// CHECK: "name":"process_name"
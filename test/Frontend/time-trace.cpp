@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -fsyntax-only -ftime-trace=%t.json -ftime-trace-granularity=0 %s
+// RUN: FileCheck %s < %t.json
+
+#include "Inputs/time-trace.h"
+
+int f() {
+  S<int> s;
+  return s.get();
+}
+
+// CHECK: {"traceEvents":[
+// CHECK-DAG: "name":"Include","args":{"detail":"{{.*}}time-trace.h"}
+// CHECK-DAG: "name":"InstantiateClass","args":{"detail":"S<int>"}
+// CHECK-DAG: "name":"InstantiateFunction","args":{"detail":"S<int>::get"}
+// CHECK-DAG: "name":"ParseTopLevelDecl","args":{"detail":"f"}
+// CHECK-DAG: "name":"Frontend","args":{"detail":"{{.*}}time-trace.cpp"}
+// CHECK-DAG: "name":"Total InstantiateClass","args":{"detail":"1 events"}
+// CHECK: "name":"process_name"
@@ -0,0 +1,2 @@
+#define HEADER_MACRO int
+HEADER_MACRO header_var;
@@ -0,0 +1,16 @@
+#define MAIN_MACRO int
+#include "pp-record-main-file-expansions.h"
+MAIN_MACRO main_var;
+HEADER_MACRO other_var;
+
+// RUN: c-index-test -test-load-source all %s -I%S/Inputs | FileCheck -check-prefix=ALL %s
+// ALL: pp-record-main-file-expansions.c:1:9: macro definition=MAIN_MACRO
+// ALL: pp-record-main-file-expansions.h:2:1: macro expansion=HEADER_MACRO:1:9
+// ALL: pp-record-main-file-expansions.c:3:1: macro expansion=MAIN_MACRO:1:9
+// ALL: pp-record-main-file-expansions.c:4:1: macro expansion=HEADER_MACRO:1:9
+
+// RUN: c-index-test -test-load-source all %s -I%S/Inputs -Xclang -detailed-preprocessing-record-main-file-expansions | FileCheck -check-prefix=MAIN %s
+// MAIN: pp-record-main-file-expansions.c:1:9: macro definition=MAIN_MACRO
+// MAIN-NOT: macro expansion=HEADER_MACRO:1:9
+// MAIN: pp-record-main-file-expansions.c:3:1: macro expansion=MAIN_MACRO:1:9
+// MAIN: pp-record-main-file-expansions.c:4:1: macro expansion=HEADER_MACRO:1:9
@@ -0,0 +1,39 @@
+namespace N {
+  int helper(int x);
+
+  struct S {
+    int get() { return helper(value); }
+    int value;
+  };
+}
+
+int N::helper(int x) {
+  int y = x + 1;
+  return y;
+}
+
+template <typename T> T ident(T t) { T u = t; return u; }
+
+// RUN: env CINDEXTEST_SKIP_FUNCTION_BODIES=1 c-index-test -test-load-source all %s | FileCheck -check-prefix=SKIPPED %s
+// SKIPPED: skipped-function-bodies.cpp:5:9: CXXMethod=get:5:9 Extent=[5:5 - 5:14]
+// SKIPPED-NOT: MemberRefExpr=value
+// SKIPPED: skipped-function-bodies.cpp:10:8: FunctionDecl=helper:10:8 Extent=[10:1 - 10:21]
+// SKIPPED-NOT: VarDecl=y
+
+// Skipped bodies are parsed on demand; template bodies are not retained.
+// RUN: env CINDEXTEST_PARSE_SKIPPED_FUNCTION_BODIES=1 c-index-test -test-load-source all %s | FileCheck -check-prefix=PARSED %s
+// PARSED: skipped-function-bodies.cpp:5:9: CXXMethod=get:5:9 (Definition) Extent=[5:5 - 5:40]
+// PARSED: skipped-function-bodies.cpp:5:24: CallExpr=helper:2:7 Extent=[5:24 - 5:37]
+// PARSED: skipped-function-bodies.cpp:5:31: MemberRefExpr=value:6:9 Extent=[5:31 - 5:36]
+// PARSED: skipped-function-bodies.cpp:10:8: FunctionDecl=helper:10:8 (Definition) Extent=[10:1 - 13:2]
+// PARSED: skipped-function-bodies.cpp:11:7: VarDecl=y:11:7 (Definition) Extent=[11:3 - 11:16]
+// PARSED: skipped-function-bodies.cpp:11:11: DeclRefExpr=x:10:19 Extent=[11:11 - 11:12]
+// PARSED: skipped-function-bodies.cpp:12:10: DeclRefExpr=y:11:7 Extent=[12:10 - 12:11]
+// PARSED-NOT: VarDecl=u
+
+// No body is retained when templates are parsed late.
+// RUN: env CINDEXTEST_PARSE_SKIPPED_FUNCTION_BODIES=1 c-index-test -test-load-source all %s -fdelayed-template-parsing | FileCheck -check-prefix=DELAYED %s
+// DELAYED: skipped-function-bodies.cpp:5:9: CXXMethod=get:5:9 Extent=[5:5 - 5:14]
+// DELAYED-NOT: MemberRefExpr=value
+// DELAYED: skipped-function-bodies.cpp:10:8: FunctionDecl=helper:10:8 Extent=[10:1 - 10:21]
+// DELAYED-NOT: VarDecl=y
@@ -0,0 +1,3 @@
+struct point { int x, y; };
+
+static inline int point_sum(struct point *p) { return p->x + p->y; }
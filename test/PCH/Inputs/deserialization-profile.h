@@ -0,0 +1,10 @@
+namespace geometry {
+  struct point { int x, y; };
+
+  inline point make_point(int x, int y) {
+    point p = { x, y };
+    return p;
+  }
+
+  inline int unused_function() { return 0; }
+}
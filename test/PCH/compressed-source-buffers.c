@@ -0,0 +1,25 @@
+// Test that buffers embedded in a PCH file can be stored compressed.
+
+// RUN: %clang_cc1 -x c-header %S/Inputs/compressed-source-buffers.h -DWIDTH=17 -compress-ast-source-buffers -emit-pch -print-stats -o %t.pch 2>&1 | FileCheck -check-prefix=CHECK-WRITE %s
+// RUN: %clang_cc1 %s -include-pch %t.pch -DWIDTH=17 -fsyntax-only -verify
+// RUN: %clang_cc1 %s -include-pch %t.pch -DWIDTH=17 -fsyntax-only -print-stats 2>&1 | FileCheck -check-prefix=CHECK-READ %s
+
+// Without compression the buffers are written as-is.
+// RUN: %clang_cc1 -x c-header %S/Inputs/compressed-source-buffers.h -DWIDTH=17 -emit-pch -print-stats -o %t.plain.pch 2>&1 | FileCheck -check-prefix=CHECK-PLAIN %s
+// RUN: %clang_cc1 %s -include-pch %t.plain.pch -DWIDTH=17 -fsyntax-only -verify
+
+// CHECK-WRITE: *** AST File Writer Statistics:
+// CHECK-WRITE: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} source buffer blobs compressed
+// CHECK-WRITE: seconds compressing source buffers
+
+// CHECK-READ: *** AST File Statistics:
+// CHECK-READ: compressed source buffers expanded
+// CHECK-READ: seconds decompressing source buffers
+
+// CHECK-PLAIN: *** AST File Writer Statistics:
+// CHECK-PLAIN: 0/{{[1-9][0-9]*}} source buffer blobs compressed
+// CHECK-PLAIN-NOT: seconds compressing source buffers
+
+int array[WIDTH == 17 ? 1 : -1];
+struct point p = { 1, 2 };
+int sum = point_sum(&p);
@@ -0,0 +1,18 @@
+// Test the JSON deserialization profile.
+
+// RUN: %clang_cc1 -x c++-header %S/Inputs/deserialization-profile.h -emit-pch -o %t.pch
+// RUN: %clang_cc1 %s -include-pch %t.pch -fsyntax-only -ast-deserialization-profile %t.json
+// RUN: FileCheck %s < %t.json
+
+// CHECK: "modules": [
+// CHECK: "file": "{{.*}}.pch"
+// CHECK-NEXT: "kind": "pch"
+// CHECK: "decls": { "loaded": {{[1-9][0-9]*}}, "available": {{[1-9][0-9]*}} }
+// CHECK: "types": { "loaded": {{[0-9]+}}, "available": {{[1-9][0-9]*}} }
+// CHECK: "identifiers": { "loaded": {{[1-9][0-9]*}}, "available": {{[1-9][0-9]*}} }
+// CHECK: "decl_read_seconds":
+// CHECK: "lookup_triggers": [
+// CHECK: { "name": "make_point", "count": {{[1-9][0-9]*}} }
+
+int x = geometry::make_point(1, 2).x;
+int y = geometry::make_point(3, 4).y;
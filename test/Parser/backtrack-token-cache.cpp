@@ -0,0 +1,13 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+struct T { T(int); };
+
+void f(int a) {
+  // Each of these is disambiguated by tentatively parsing it as a
+  // declaration and backtracking.
+  T(a + 1);
+  T(a * 2);
+  int(a) + 1;
+}
+
+// CHECK: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} backtrack positions rewound, re-lexing {{[1-9][0-9]*}} cached tokens; at most {{[1-9][0-9]*}} tokens cached.
@@ -0,0 +1,6 @@
+#ifndef INCLUDE_GUARD_CACHE_H
+#define INCLUDE_GUARD_CACHE_H
+
+int guarded_value;
+
+#endif
@@ -0,0 +1,5 @@
+#ifdef SHARD_VALUE
+int shard1_value = SHARD_VALUE;
+#else
+int shard1_value = 1;
+#endif
@@ -0,0 +1 @@
+int shard2_value = 2;
@@ -0,0 +1,11 @@
+// RUN: %clang_cc1 -I %S/Inputs/directory-listings/a -I %S/Inputs/directory-listings/b -fshared-directory-listings %s -E | FileCheck %s
+// RUN: %clang_cc1 -I %S/Inputs/directory-listings/a -I %S/Inputs/directory-listings/b -fshared-directory-listings %s -fsyntax-only -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+#include "found.h"
+#include "other.h"
+
+// CHECK: int found_value;
+// CHECK: int other_value;
+
+// STATS: 1 lookups skipped by directory listings.
+// STATS: 2 directory listings read, 0 reused.
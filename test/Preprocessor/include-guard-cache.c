@@ -0,0 +1,18 @@
+// RUN: rm -f %t.cache
+// RUN: %clang_cc1 -I %S/Inputs -include-guard-cache %t.cache %s -fsyntax-only
+// RUN: FileCheck -check-prefix=CACHE %s < %t.cache
+// RUN: %clang_cc1 -I %S/Inputs -include-guard-cache %t.cache -DINCLUDE_GUARD_CACHE_H %s -fsyntax-only -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+// Headers skipped through the cache are still dependencies.
+// RUN: %clang -E -MD -MF %t.d -MT foo -I %S/Inputs -Xclang -include-guard-cache -Xclang %t.cache -DINCLUDE_GUARD_CACHE_H -o %t.i %s
+// RUN: FileCheck -check-prefix=DEPS %s < %t.d
+
+#include "include-guard-cache.h"
+
+// CACHE: clang-include-guard-cache 1
+// CACHE: INCLUDE_GUARD_CACHE_H {{.*}}include-guard-cache.h
+
+// STATS: 1 #includes skipped using the shared include guard cache.
+
+// DEPS: foo:
+// DEPS: include-guard-cache.h
@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 %s -E -o %t.expected
+// RUN: %clang_cc1 %s -E -fmemoize-macro-expansions -o %t.memoized
+// RUN: diff %t.expected %t.memoized
+// RUN: %clang_cc1 %s -E -fmemoize-macro-expansions -print-stats -o /dev/null 2>&1 | FileCheck %s
+
+#define ONE 1
+#define INC(x) ((x) + ONE)
+#define TWICE(x) INC(INC(x))
+
+int a = TWICE(ONE);
+int b = TWICE(ONE);
+
+// The same argument expands differently while a macro it uses is disabled.
+#define f(a) a*g
+#define g(a) f(a)
+int c = f(2)(9);
+int d = g(f(2)(9));
+int e = g(f(2)(9));
+
+// Macro definitions changing between uses invalidate memoized expansions.
+#define VAL 1
+int h = INC(VAL);
+#undef VAL
+#define VAL 2
+int i = INC(VAL);
+
+// __LINE__ expands differently every time and is never memoized.
+int j = INC(__LINE__);
+int k = INC(__LINE__);
+
+// CHECK: {{[1-9][0-9]*}}/{{[0-9]+}} macro argument pre-expansions reused ({{[0-9]+}}%), {{[1-9][0-9]*}} not memoizable, {{[0-9]+}} memoized.
@@ -0,0 +1,12 @@
+// RUN: %clang_cc1 %s -E -print-stats -o /dev/null 2>&1 | FileCheck %s
+
+#define F(x) x
+#define G(x, y) F(x) + F(y)
+
+G(1, 2)
+G(3, 4)
+G(5, 6)
+
+// Each expansion of G uses two nested argument lists, so only the first
+// expansion allocates.
+// CHECK: 2/{{[1-9][0-9]*}} macro argument lists allocated/reused, {{[0-9]+}}B allocated.
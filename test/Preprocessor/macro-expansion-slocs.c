@@ -0,0 +1,10 @@
+// RUN: %clang_cc1 %s -fsyntax-only -print-stats 2>&1 | FileCheck %s
+
+#define ID(x) x
+#define TWICE(x) ID(x) + ID(x)
+
+int value = TWICE(1 + 2);
+
+// The body of each macro invocation gets one expansion entry, and each
+// argument gets one entry per use.
+// CHECK: {{[0-9]+}} local macro expansion SLocEntry's ({{[1-9][0-9]*}} for macro arguments), {{[0-9]+}}B of Sloc address space used, {{[0-9]+}} bytes each.
@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -emit-pth %S/Inputs/token-cache-shard1.h -o %t1.pth
+// RUN: %clang_cc1 -emit-pth %S/Inputs/token-cache-shard2.h -o %t2.pth
+// RUN: %clang_cc1 -I %S/Inputs -token-cache-shard %t1.pth -token-cache-shard %t2.pth %s -E | FileCheck %s
+// RUN: %clang_cc1 -I %S/Inputs -token-cache-shard %t1.pth -token-cache-shard %t2.pth %s -fsyntax-only -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+#define SHARD_VALUE 42
+#include "token-cache-shard1.h"
+#include "token-cache-shard2.h"
+
+int total = shard1_value + shard2_value;
+
+// CHECK: int shard1_value = 42;
+// CHECK: int shard2_value = 2;
+// CHECK: int total = shard1_value + shard2_value;
+
+// STATS: 2 source files read from token cache shards.
@@ -0,0 +1,11 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify -fconstexpr-depth 8 %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify -fconstexpr-depth 8 -fconstexpr-memoize %s
+
+// A memoized result is not reused where evaluating the call would exceed
+// the depth limit.
+constexpr int depth(int n) { return n > 1 ? depth(n-1) : 0; } // expected-note {{exceeded maximum depth of 8 calls}} expected-note +{{in call to}}
+constexpr int nest(int k, int n) { return k ? nest(k-1, n) : depth(n); } // expected-note +{{in call to}}
+
+constexpr int kShallow = depth(5);
+constexpr int kDeep = nest(5, 5); // expected-error {{must be initialized by a constant expression}} expected-note {{in call to 'nest(5, 5)'}}
+constexpr int kFits = nest(2, 5);
@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify -fconstexpr-memoize %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -fconstexpr-memoize -print-stats %s 2>&1 | FileCheck %s
+
+// Without memoization, this takes exponential time.
+constexpr unsigned long long fib(unsigned n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+static_assert(fib(80) == 23416728348467685ULL, "");
+
+struct Pair { int a, b; };
+constexpr Pair swap(Pair p) { return Pair{p.b, p.a}; }
+static_assert(swap(swap(Pair{1, 2})).a == 1, "");
+static_assert(swap(Pair{1, 2}).a == 2, "");
+
+// Calls involving pointers are not memoized.
+constexpr int len(const char *s) { return *s ? 1 + len(s + 1) : 0; }
+static_assert(len("abc") == 3, "");
+static_assert(len("abd") == 3, "");
+
+constexpr int div(int a, int b) { return a / b; }
+static_assert(div(4, 0) == 0, ""); // expected-error {{not an integral constant expression}} \
+                                   // expected-note {{division by zero}} \
+                                   // expected-note {{in call to}}
+static_assert(div(4, 2) == 2, "");
+
+// CHECK: *** Constexpr Evaluation Stats:
+// CHECK: {{[0-9]+}} constexpr calls evaluated.
+// CHECK: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} memoizable calls reused ({{[0-9]+}}%), {{[1-9][0-9]*}} not memoizable, {{[1-9][0-9]*}} memoized.
@@ -0,0 +1,59 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// Lookup tables store lists of one or two declarations inline; make sure
+// they keep the order lookup relies on: using declarations first, tags last.
+namespace N {
+  struct stat { int x; };
+  int stat(const char *);
+
+  void f(int);
+  void f(double);
+  void f(char *);
+
+  struct g { };
+  void g(int);
+  void g(float);
+
+  int h(int);
+}
+
+namespace M {
+  using N::h;
+  double h(double);
+}
+
+void test() {
+  int r = N::stat("a");
+  struct N::stat s = { r };
+  N::f(1);
+  N::f(1.0);
+  N::f((char *)0);
+  struct N::g tag;
+  N::g(1);
+  N::g(1.0f);
+  int i = M::h(1);
+  double d = M::h(1.0);
+}
+
+// Large lookup tables have a name filter, which lets lookups that miss
+// them skip probing the table.
+namespace Big {
+  int a0, a1, a2, a3, a4, a5, a6, a7, a8, a9;
+  int b0, b1, b2, b3, b4, b5, b6, b7, b8, b9;
+  int c0, c1, c2, c3, c4, c5, c6, c7, c8, c9;
+  int d0, d1, d2, d3, d4, d5, d6, d7, d8, d9;
+  int e0, e1, e2, e3, e4, e5, e6, e7, e8, e9;
+  int f0, f1, f2, f3, f4, f5, f6, f7, f8, f9;
+  int g0, g1, g2, g3, g4, g5, g6, g7, g8, g9;
+  int h0, h1, h2, h3, h4, h5, h6, h7, h8, h9;
+}
+using namespace Big;
+int sum = a0 + a9 + b0 + b9 + h5;
+
+int v, w, x, y, z;
+int use() { return v + w + x + y + z; }
+
+// CHECK: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} declaration context lookups found nothing
+// CHECK-NEXT: {{[1-9][0-9]*}} lookup table probes avoided by name filters
+// CHECK-NEXT: {{[1-9][0-9]*}} misses in
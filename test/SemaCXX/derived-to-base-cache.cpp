@@ -0,0 +1,40 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: not %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+struct A { };
+struct B : A { };
+struct C : A { };
+struct D : B, C { };
+struct E : virtual A { };
+struct F : E { };
+struct G { };
+
+void takeA(A *);
+void takeG(G *); // expected-note 2 {{candidate function not viable}}
+
+void test(B *b, D *d, F *f, G *g) {
+  takeA(b);
+  takeA(b);
+  takeA(f);
+  takeA(f);
+  takeA(d); // expected-error {{ambiguous conversion from derived class 'D' to base class 'A'}}
+  takeG(b); // expected-error {{no matching function for call to 'takeG'}}
+  takeG(b); // expected-error {{no matching function for call to 'takeG'}}
+}
+
+// The paths are reused for repeated conversions, so they must still be
+// checked for access and ambiguity each time.
+struct P : private A { }; // expected-note 2 {{declared private here}}
+void testP(P *p, D *d) {
+  takeA(p); // expected-error {{cannot cast 'P' to its private base class 'A'}}
+  takeA(p); // expected-error {{cannot cast 'P' to its private base class 'A'}}
+  takeA(d); // expected-error {{ambiguous conversion from derived class 'D' to base class 'A'}}
+}
+
+// Incomplete classes are not cached; the answer must reflect the definition.
+struct H;
+void takeH(H *);
+struct H : G { };
+void testH(H *h) { takeG(h); }
+
+// CHECK: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} derived-to-base queries answered from the cache
@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+// RUN: not %clang_cc1 -fsyntax-only -DERROR %s 2>&1 | FileCheck -check-prefix=ERROR %s
+
+struct Stream { };
+Stream &operator<<(Stream &, int);
+Stream &operator<<(Stream &, double);
+Stream &operator<<(Stream &, const char *);
+Stream &operator<<(Stream &, bool);
+struct Point { int x, y; };
+Stream &operator<<(Stream &, const Point &);
+struct Meters { operator double() const; };
+
+void f(Stream &s, Point p, Meters m) {
+  s << p << 1 << "x" << m;
+}
+
+#ifdef ERROR
+struct NoConversions { };
+void g(Stream &s, NoConversions n) {
+  s << n;
+}
+// ERROR: invalid operands to binary expression ('Stream' and 'NoConversions')
+// ERROR: candidate function not viable: no known conversion from 'NoConversions' to 'int' for 2nd argument
+#endif
+
+// CHECK: {{[1-9][0-9]*}} overload candidates considered, {{[1-9][0-9]*}} rejected without computing conversions.
+// CHECK: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} argument conversion sequences computed/reused.
@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -ftypo-correction-limit 1 -verify -DLIMITED %s
+// A time limit that is not reached leaves typo correction enabled.
+// RUN: %clang_cc1 -fsyntax-only -ftypo-correction-time-limit 600000 -verify %s
+// RUN: not %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+int counter; // expected-note {{'counter' declared here}}
+#ifdef LIMITED
+int another;
+#else
+int another; // expected-note {{'another' declared here}}
+#endif
+
+void f() {
+  countr = 1; // expected-error {{use of undeclared identifier 'countr'; did you mean 'counter'?}}
+#ifdef LIMITED
+  anothr = 2; // expected-error {{use of undeclared identifier 'anothr'}}
+#else
+  anothr = 2; // expected-error {{use of undeclared identifier 'anothr'; did you mean 'another'?}}
+#endif
+}
+
+// Identifiers whose length or characters are too different from the typo
+// are ruled out without computing their edit distance.
+// CHECK: {{[1-9][0-9]*}} typo correction candidates checked, {{[1-9][0-9]*}} ruled out by the index.
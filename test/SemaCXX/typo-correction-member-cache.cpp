@@ -0,0 +1,12 @@
+// RUN: %clang_cc1 -fsyntax-only -ftypo-correction-limit 2 -verify %s
+
+struct S {
+  static int member; // expected-note {{'member' declared here}}
+};
+
+// A typo in a complete class that has no correction is only looked for
+// once, so repeating it does not use up the typo correction limit.
+int a = S::nothere; // expected-error {{no member named 'nothere' in 'S'}}
+int b = S::nothere; // expected-error {{no member named 'nothere' in 'S'}}
+int c = S::nothere; // expected-error {{no member named 'nothere' in 'S'}}
+int d = S::membr; // expected-error {{no member named 'membr' in 'S'; did you mean 'member'?}}
@@ -0,0 +1,38 @@
+// RUN: %clang_cc1 -fsyntax-only -ftemplate-profile -ftemplate-profile-sort=count %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -fsyntax-only -ftemplate-profile -ftemplate-profile-sort=nodes %s 2>&1 | FileCheck -check-prefix=CHECK-NODES %s
+// RUN: not %clang_cc1 -fsyntax-only -ftemplate-profile -ftemplate-profile-sort=bogus %s 2>&1 | FileCheck -check-prefix=CHECK-SORT %s
+
+template<unsigned N> struct Fact {
+  static const unsigned value = N * Fact<N - 1>::value;
+};
+template<> struct Fact<0> {
+  static const unsigned value = 1;
+};
+
+template<typename T> T twice(T t) { return t + t; }
+
+unsigned f() {
+  return Fact<3>::value + twice(1) + twice(2);
+}
+
+// CHECK: *** Template Instantiation Profile:
+// CHECK: 4 definitions instantiated in {{.*}}s, creating {{[1-9][0-9]*}} AST nodes.
+// CHECK: Templates (2):
+// CHECK-NEXT: Count  Lookups   Reused   Incl(s)   Excl(s)  InclNodes  ExclNodes
+// CHECK-NEXT: {{^ +3 +[0-9]+ +[0-9]+ .*  Fact$}}
+// CHECK-NEXT: {{^ +1 +2 +1 .*  twice$}}
+// CHECK: Specializations (4):
+// CHECK-DAG: Fact<3>
+// CHECK-DAG: Fact<2>
+// CHECK-DAG: Fact<1>
+// CHECK-DAG: twice<int>
+// CHECK: Points of instantiation (2):
+// CHECK-NEXT: Count
+// CHECK-NEXT: {{^ +3 .*instantiation-profile.cpp:14:[0-9]+$}}
+// CHECK-NEXT: {{^ +1 .*instantiation-profile.cpp:14:}}
+
+// CHECK-NODES: Templates (2):
+// CHECK-NODES-NEXT: Count
+// CHECK-NODES-NEXT: {{^ +3 .*  Fact$}}
+
+// CHECK-SORT: error: invalid value 'bogus' in '-ftemplate-profile-sort=bogus'
@@ -0,0 +1,19 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+template<typename T> T leaf(T t) { return t; }
+template<typename T> T chain(T t) { return leaf(t) + leaf(t); }
+template<typename T> struct S {
+  static T value;
+  T get() { return value; }
+};
+template<typename T> T S<T>::value = T();
+
+int test() {
+  S<int> s;
+  return leaf(1) + leaf(2.0) + chain(3L) + s.get() + S<char>::value;
+}
+
+// chain<long> performs the instantiation of leaf<long>, and S<int>::get that
+// of S<int>::value, so those two are not independent of the rest of the
+// queue.
+// CHECK: {{[1-9][0-9]*}} pending implicit instantiations performed, {{[0-9]+}}/{{[1-9][0-9]*}} outermost ones independent of the rest of the queue.
@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// Specializations are found by the uniqued identity of their template
+// arguments; arguments that are spelled differently but name the same
+// specialization must still find it.
+template<typename T, typename U> struct is_same { static const bool value = false; };
+template<typename T> struct is_same<T, T> { static const bool value = true; };
+
+template<typename T, int N> struct A { };
+typedef int Int;
+static_assert(is_same<A<int, 2>, A<Int, 1 + 1> >::value, "");
+static_assert(!is_same<A<int, 2>, A<long, 2> >::value, "");
+
+template<typename ...Ts> struct List { };
+static_assert(is_same<List<int, List<> >, List<Int, List<> > >::value, "");
+static_assert(!is_same<List<int>, List<int, int> >::value, "");
+
+template<typename T> struct B; // expected-note {{template is declared here}}
+template<> struct B<Int> { typedef int type; };
+B<int>::type b1;
+B<long>::type b2; // expected-error {{implicit instantiation of undefined template}}
+
+template<typename T> int f(T) { return 0; }
+template<> int f<Int>(int) { return 1; }
+int i = f(0);
+
+// CHECK: {{[1-9][0-9]*}} template argument lists uniqued
@@ -66,6 +66,9 @@ static unsigned getDefaultParsingOptions() {
     options &= ~CXTranslationUnit_CacheCompletionResults;
   if (getenv("CINDEXTEST_SKIP_FUNCTION_BODIES"))
     options |= CXTranslationUnit_SkipFunctionBodies;
+  if (getenv("CINDEXTEST_PARSE_SKIPPED_FUNCTION_BODIES"))
+    options |= CXTranslationUnit_SkipFunctionBodies |
+               CXTranslationUnit_RetainSkippedFunctionBodies;
   if (getenv("CINDEXTEST_COMPLETION_BRIEF_COMMENTS"))
     options |= CXTranslationUnit_IncludeBriefCommentsInCodeCompletion;
   
@@ -1139,6 +1142,14 @@ static enum CXChildVisitResult PrintTypeKind(CXCursor cursor, CXCursor p,
 /* Loading ASTs/source.                                                       */
 /******************************************************************************/
 
+static enum CXChildVisitResult
+ParseSkippedFunctionBodiesVisitor(CXCursor Cursor, CXCursor Parent,
+                                  CXClientData ClientData) {
+  /* Functions whose bodies were skipped are not definitions yet. */
+  clang_Cursor_parseSkippedFunctionBody(Cursor);
+  return CXChildVisit_Recurse;
+}
+
 static int perform_test_load(CXIndex Idx, CXTranslationUnit TU,
                              const char *filter, const char *prefix,
                              CXCursorVisitor Visitor,
@@ -1148,6 +1159,11 @@ static int perform_test_load(CXIndex Idx, CXTranslationUnit TU,
   if (prefix)
     FileCheckPrefix = prefix;
 
+  /* Parse the skipped function bodies on demand before visiting the AST. */
+  if (getenv("CINDEXTEST_PARSE_SKIPPED_FUNCTION_BODIES"))
+    clang_visitChildren(clang_getTranslationUnitCursor(TU),
+                        ParseSkippedFunctionBodiesVisitor, NULL);
+
   if (Visitor) {
     enum CXCursorKind K = CXCursor_NotImplemented;
     enum CXCursorKind *ck = &K;
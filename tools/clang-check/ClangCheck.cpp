@@ -20,6 +20,8 @@
 #include "clang/Driver/OptTable.h"
 #include "clang/Driver/Options.h"
 #include "clang/Frontend/ASTConsumers.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/HeaderCostReport.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/CommandLine.h"
@@ -57,6 +59,14 @@ static cl::opt<bool> ASTPrint(
 static cl::opt<std::string> ASTDumpFilter(
     "ast-dump-filter",
     cl::desc(Options->getOptionHelpText(options::OPT_ast_dump_filter)));
+static cl::opt<bool> HeaderCosts(
+    "header-costs",
+    cl::desc("Report what each included header costs, summed over all "
+             "translation units"));
+static cl::opt<unsigned> HeaderCostsLimit(
+    "header-costs-limit",
+    cl::desc("Only report the given number of most expensive headers"),
+    cl::init(0));
 
 // Anonymous namespace here causes problems with gcc <= 4.4 on MacOS 10.6.
 // "Non-global symbol: ... can't be a weak_definition"
@@ -73,6 +83,20 @@ public:
     return new clang::ASTConsumer();
   }
 };
+
+/// \brief Creates actions that add the header costs of each translation unit
+/// to a single report.
+class HeaderCostActionFactory : public FrontendActionFactory {
+  clang::HeaderCostReport &Report;
+
+public:
+  explicit HeaderCostActionFactory(clang::HeaderCostReport &Report)
+    : Report(Report) {}
+
+  virtual clang::FrontendAction *create() {
+    return new clang::HeaderCostReportAction(&Report);
+  }
+};
 }
 
 int main(int argc, const char **argv) {
@@ -80,5 +104,11 @@ int main(int argc, const char **argv) {
   CommonOptionsParser OptionsParser(argc, argv);
   ClangTool Tool(OptionsParser.GetCompilations(),
                  OptionsParser.GetSourcePathList());
+  if (HeaderCosts) {
+    clang::HeaderCostReport Report;
+    int Result = Tool.run(new clang_check::HeaderCostActionFactory(Report));
+    Report.print(llvm::outs(), HeaderCostsLimit);
+    return Result;
+  }
   return Tool.run(newFrontendActionFactory(&Factory));
 }
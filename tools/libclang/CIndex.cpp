@@ -2556,6 +2556,8 @@ static void clang_parseTranslationUnit_Impl(void *UserData) {
   bool IncludeBriefCommentsInCodeCompletion
     = options & CXTranslationUnit_IncludeBriefCommentsInCodeCompletion;
   bool SkipFunctionBodies = options & CXTranslationUnit_SkipFunctionBodies;
+  bool RetainSkippedFunctionBodies
+    = options & CXTranslationUnit_RetainSkippedFunctionBodies;
 
   // Configure the diagnostics.
   DiagnosticOptions DiagOpts;
@@ -2642,6 +2644,7 @@ static void clang_parseTranslationUnit_Impl(void *UserData) {
                                  IncludeBriefCommentsInCodeCompletion,
                                  /*AllowPCHWithCompilerErrors=*/true,
                                  SkipFunctionBodies,
+                                 RetainSkippedFunctionBodies,
                                  /*UserFilesAreVolatile=*/true,
                                  &ErrUnit));
 
@@ -1122,6 +1122,20 @@ CXCursor clang_Cursor_getArgument(CXCursor C, unsigned i) {
   return clang_getNullCursor();
 }
 
+unsigned clang_Cursor_parseSkippedFunctionBody(CXCursor C) {
+  if (!clang_isDeclaration(C.kind))
+    return 0;
+
+  Decl *D = cxcursor::getCursorDecl(C);
+  FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(D);
+  ASTUnit *CXXUnit = cxcursor::getCursorASTUnit(C);
+  if (!FD || !CXXUnit)
+    return 0;
+
+  ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+  return CXXUnit->parseSkippedFunctionBody(FD);
+}
+
 } // end: extern "C"
 
 //===----------------------------------------------------------------------===//
@@ -453,6 +453,10 @@ static void indexPreprocessingRecord(ASTUnit &Unit, IndexingContext &IdxCtx) {
   }
 
   for (; I != E; ++I) {
+    // Don't create the entities we are not interested in.
+    if (PPRec.getEntityKind(I) != PreprocessedEntity::InclusionDirectiveKind)
+      continue;
+
     PreprocessedEntity *PPE = *I;
 
     if (InclusionDirective *ID = dyn_cast<InclusionDirective>(PPE)) {
@@ -155,6 +155,61 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, NULL));
 }
 
+TEST_F(SourceManagerTest, getLineNumberMixedNewlines) {
+  // Newlines of every kind, with \r\n pairs straddling 16-byte boundaries
+  // and a null in the middle of a line.
+  std::string Source;
+  std::vector<unsigned> LineStarts(1, 0);
+  const char *const Newlines[] = { "\n", "\r", "\r\n", "\n\r" };
+  for (unsigned I = 0; I != 100; ++I) {
+    Source.append(I % 19 + 1, I % 5 == 0 ? '\0' : 'x');
+    Source += Newlines[I % 4];
+    LineStarts.push_back(Source.size());
+  }
+
+  MemoryBuffer *Buf = MemoryBuffer::getMemBufferCopy(Source);
+  FileID MainFileID = SourceMgr.createMainFileIDForMemBuffer(Buf);
+
+  for (unsigned Line = 0; Line != LineStarts.size(); ++Line)
+    EXPECT_EQ(Line + 1, SourceMgr.getLineNumber(MainFileID,
+                                                LineStarts[Line]));
+}
+
+TEST_F(SourceManagerTest, getFileIDRandomAccess) {
+  MemoryBuffer *MainBuf = MemoryBuffer::getMemBuffer("int x;\n");
+  FileID MainFileID = SourceMgr.createMainFileIDForMemBuffer(MainBuf);
+  SourceLocation MainLoc = SourceMgr.getLocForStartOfFile(MainFileID);
+
+  // Interleave files and macro expansions of various sizes.
+  std::vector<SourceLocation> Starts;
+  std::vector<FileID> FIDs;
+  for (unsigned I = 0; I != 200; ++I) {
+    if (I % 3 == 0) {
+      SourceLocation Loc = SourceMgr.createExpansionLoc(MainLoc, MainLoc,
+                                                        MainLoc, I + 1);
+      Starts.push_back(Loc);
+      FIDs.push_back(SourceMgr.getFileID(Loc));
+      continue;
+    }
+
+    std::string Contents(I * 7 % 31 + 1, 'x');
+    FileID FID = SourceMgr.createFileIDForMemBuffer(
+                   MemoryBuffer::getMemBufferCopy(Contents));
+    Starts.push_back(SourceMgr.getLocForStartOfFile(FID));
+    FIDs.push_back(FID);
+  }
+
+  // Look up the first and last location of each entry in an order that
+  // defeats the linear scan from the last lookup.
+  for (unsigned Step = 0; Step != 200; ++Step) {
+    unsigned I = Step * 73 % 200;
+    EXPECT_EQ(FIDs[I], SourceMgr.getFileID(Starts[I]));
+    if (I + 1 != 200)
+      EXPECT_EQ(FIDs[I], SourceMgr.getFileID(
+                           Starts[I + 1].getLocWithOffset(-1)));
+  }
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {